@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace jess::bench
+{
+
+/// keeps the compiler from optimizing away the computation of the value
+template<typename T>
+inline void doNotOptimize( const T& value )
+{
+  asm volatile( "" : : "r,m"( value ) : "memory" );
+}
+
+/// the timed part of a run of a benchmark
+struct Measurement {
+  size_t iterations;
+  std::chrono::nanoseconds duration;
+};
+
+/// times uIterations calls of operation, which is passed the index of the call
+template<typename TOperation>
+Measurement timeLoop( const size_t uIterations, TOperation&& operation )
+{
+  const auto start = std::chrono::steady_clock::now();
+  for ( size_t i = 0; i < uIterations; ++i )
+  {
+    operation( i );
+  }
+  return Measurement{ uIterations, std::chrono::steady_clock::now() - start };
+}
+
+struct BenchResult {
+  std::string name;
+  // "synthetic" or the directory of the journal files
+  std::string source;
+  // number of entries of the journal, 0 if the benchmark does not depend on a journal
+  int64_t entries;
+  size_t iterations;
+  double nsPerOpMin;
+  double nsPerOpMedian;
+};
+
+/// runs benchmarks repeatedly and writes their results as JSON, so that runs of different revisions can be compared
+class BenchReport
+{
+  size_t m_uRepetitions;
+  std::vector<BenchResult> m_results{};
+
+public:
+  explicit BenchReport( const size_t uRepetitions )
+    : m_uRepetitions( std::max<size_t>( uRepetitions, 1 ) )
+  {
+  }
+
+  /// every run of the benchmark sets up its own state and returns the measurement of the timed part only
+  void run( std::string sName, std::string sSource, const int64_t entries, const std::function<Measurement()>& benchmark )
+  {
+    std::vector<double> nsPerOp{};
+    size_t uIterations{};
+    for ( size_t i = 0; i < m_uRepetitions; ++i )
+    {
+      const Measurement measurement = benchmark();
+      uIterations = measurement.iterations;
+      nsPerOp.push_back( static_cast<double>( measurement.duration.count() ) / static_cast<double>( std::max<size_t>( measurement.iterations, 1 ) ) );
+    }
+    std::sort( nsPerOp.begin(), nsPerOp.end() );
+
+    BenchResult result{ std::move( sName ), std::move( sSource ), entries, uIterations, nsPerOp.front(), nsPerOp[nsPerOp.size() / 2] };
+    std::fprintf( stderr, "%-40s %-10s %12lld %12.1f ns/op\n", result.name.c_str(), result.source.c_str(), static_cast<long long>( result.entries ),
+      result.nsPerOpMin );
+    m_results.push_back( std::move( result ) );
+  }
+
+  void writeJson( std::FILE* pFile ) const
+  {
+    std::fprintf( pFile, "{\n  \"context\": {\n" );
+    std::fprintf( pFile, "    \"compiler\": \"%s\",\n", escape( __VERSION__ ).c_str() );
+#ifdef NDEBUG
+    std::fprintf( pFile, "    \"optimized\": true,\n" );
+#else
+    std::fprintf( pFile, "    \"optimized\": false,\n" );
+#endif
+    std::fprintf( pFile, "    \"repetitions\": %zu\n  },\n  \"benchmarks\": [", m_uRepetitions );
+
+    for ( size_t i = 0; i < m_results.size(); ++i )
+    {
+      const BenchResult& result = m_results[i];
+      std::fprintf( pFile,
+        "%s\n    { \"name\": \"%s\", \"source\": \"%s\", \"entries\": %lld, \"iterations\": %zu, \"ns_per_op\": %.2f, \"ns_per_op_median\": %.2f }",
+        i == 0 ? "" : ",", escape( result.name ).c_str(), escape( result.source ).c_str(), static_cast<long long>( result.entries ), result.iterations,
+        result.nsPerOpMin, result.nsPerOpMedian );
+    }
+    std::fprintf( pFile, "\n  ]\n}\n" );
+  }
+
+private:
+  static std::string escape( const std::string_view sText )
+  {
+    std::string sEscaped{};
+    for ( const char c : sText )
+    {
+      if ( c == '"' || c == '\\' )
+      {
+        sEscaped.push_back( '\\' );
+      }
+      if ( static_cast<unsigned char>( c ) >= 0x20 )
+      {
+        sEscaped.push_back( c );
+      }
+    }
+    return sEscaped;
+  }
+};
+
+}// namespace jess::bench
@@ -0,0 +1,155 @@
+// compares building chunks with one heap allocation per message against building them into a per-chunk arena
+//
+// usage: bench_arena [NUM_CHUNKS]
+// build with optimizations (-DCMAKE_BUILD_TYPE=Release), the numbers of a debug build are meaningless
+
+#include "Chunk.hpp"
+#include "SyntheticStream.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+std::atomic<size_t> g_uAllocations{ 0 };
+std::atomic<size_t> g_uAllocatedBytes{ 0 };
+
+constexpr size_t CHUNK_SIZE = 1024;
+// number of chunks kept alive at a time, older ones are evicted like in the chunk cache
+constexpr size_t CACHED_CHUNKS = 8;
+
+/// layout of a chunk before the arena was introduced, every line owns its message
+struct LegacyLine {
+  jess::SdSeqid seqid;
+  std::string sMessage;
+  std::chrono::time_point<std::chrono::system_clock> realtime;
+};
+
+std::vector<LegacyLine> readLegacyChunk( jess::bench::SyntheticStream& journal )
+{
+  std::vector<LegacyLine> lines{};
+  lines.reserve( CHUNK_SIZE );
+  for ( size_t i = 0; i < CHUNK_SIZE; ++i )
+  {
+    const jess::SdLine line = journal.getLine();
+    lines.push_back( LegacyLine{ line.seqid(), std::string{ line.message() }, line.realtime() } );
+    if ( !journal.next() )
+    {
+      break;
+    }
+  }
+  return lines;
+}
+
+struct Result {
+  size_t uAllocations;
+  size_t uAllocatedBytes;
+  std::chrono::nanoseconds duration;
+};
+
+/// builds uNumChunks chunks with buildChunk, keeping the last CACHED_CHUNKS alive and handing evicted ones to evict
+template<typename TChunk>
+Result run( const size_t uNumChunks, auto buildChunk, auto evict )
+{
+  jess::bench::SyntheticStream journal{};
+  std::deque<TChunk> cache{};
+
+  const size_t uAllocationsBefore = g_uAllocations;
+  const size_t uBytesBefore = g_uAllocatedBytes;
+  const auto start = std::chrono::steady_clock::now();
+
+  journal.seekToBof();
+  journal.next();
+  for ( size_t i = 0; i < uNumChunks; ++i )
+  {
+    // start over before running into the end of the stream, so that all chunks are full
+    if ( journal.getSeqid().seqnum.value + CHUNK_SIZE >= static_cast<size_t>( journal.length() ) )
+    {
+      journal.seekToBof();
+      journal.next();
+    }
+    cache.push_back( buildChunk( journal ) );
+    if ( cache.size() > CACHED_CHUNKS )
+    {
+      evict( cache.front() );
+      cache.pop_front();
+    }
+  }
+
+  const auto duration = std::chrono::steady_clock::now() - start;
+  return Result{ g_uAllocations - uAllocationsBefore, g_uAllocatedBytes - uBytesBefore, duration };
+}
+
+void print( const char* sName, const Result& result, const size_t uNumChunks )
+{
+  const double fLines = static_cast<double>( uNumChunks * CHUNK_SIZE );
+  std::printf( "%-16s %14.2f %14.0f %12.1f\n", sName, static_cast<double>( result.uAllocations ) / static_cast<double>( uNumChunks ),
+    static_cast<double>( result.uAllocatedBytes ) / static_cast<double>( uNumChunks ),
+    static_cast<double>( result.duration.count() ) / fLines );
+}
+
+}// namespace
+
+// counts all allocations of the process, the allocation itself is left to malloc()
+void* operator new( const size_t uSize )
+{
+  g_uAllocations.fetch_add( 1, std::memory_order_relaxed );
+  g_uAllocatedBytes.fetch_add( uSize, std::memory_order_relaxed );
+  if ( void* p = std::malloc( uSize == 0 ? 1 : uSize ) )
+  {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+// gcc sees through the inlined operator new and mistakes the malloc() / free() pairs for a mismatch
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete( void* p ) noexcept { std::free( p ); }
+
+void operator delete( void* p, size_t ) noexcept { std::free( p ); }
+#pragma GCC diagnostic pop
+
+int main( int argc, char** argv )
+{
+  const size_t uNumChunks = argc > 1 ? std::strtoull( argv[1], nullptr, 10 ) : 2000;
+  if ( uNumChunks == 0 )
+  {
+    std::fprintf( stderr, "usage: %s [NUM_CHUNKS]\n", argv[0] );
+    return 1;
+  }
+
+  std::printf( "%zu chunks of %zu lines, %zu chunks cached\n\n", uNumChunks, CHUNK_SIZE, CACHED_CHUNKS );
+  std::printf( "%-16s %14s %14s %12s\n", "layout", "allocs/chunk", "bytes/chunk", "ns/line" );
+
+  print( "per-line string",
+    run<std::vector<LegacyLine>>( uNumChunks, []( jess::bench::SyntheticStream& journal ) { return readLegacyChunk( journal ); }, []( auto& ) {} ),
+    uNumChunks );
+
+  {
+    // arenas are never recycled, every chunk allocates its own
+    jess::ChunkArenaPool pool{};
+    print( "arena",
+      run<jess::Chunk>(
+        uNumChunks, [&]( jess::bench::SyntheticStream& journal ) { return jess::readChunkForward( journal, pool, CHUNK_SIZE ); }, []( auto& ) {} ),
+      uNumChunks );
+  }
+
+  {
+    jess::ChunkArenaPool pool{};
+    print( "arena + pool",
+      run<jess::Chunk>(
+        uNumChunks, [&]( jess::bench::SyntheticStream& journal ) { return jess::readChunkForward( journal, pool, CHUNK_SIZE ); },
+        [&]( jess::Chunk& chunk ) { pool.release( std::move( chunk.arena ) ); } ),
+      uNumChunks );
+  }
+
+  return 0;
+}
@@ -0,0 +1,355 @@
+// measures the hot paths of scrolling: ChunkedJournal::seekLines(), building chunks, the chunk index, SdCursor
+// parsing / formatting in string and binary form and timestamp formatting, and of dumping the journal
+//
+// usage: bench [--entries=N[,N...]] [--directory=DIR] [--repetitions=N] [--output=FILE]
+//   --entries      sizes of the synthetic journal (default: 100000,1000000), up to 10^8 are fine
+//   --directory    also run the journal benchmarks on the journal files in DIR, see make_fixture_journal.sh
+//   --repetitions  runs per benchmark, the fastest and the median run are reported (default: 3)
+//   --output       write the JSON results to FILE instead of stdout; progress is printed to stderr
+// build with optimizations (-DCMAKE_BUILD_TYPE=Release), the numbers of a debug build are meaningless
+
+#include "BenchReport.hpp"
+#include "Chunk.hpp"
+#include "ChunkIndex.hpp"
+#include "ChunkedJournal.hpp"
+#include "JournalDump.hpp"
+#include "SdCursor.hpp"
+#include "SdJournal.hpp"
+#include "SyntheticStream.hpp"
+#include "TimestampFormatter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+using jess::bench::BenchReport;
+using jess::bench::doNotOptimize;
+using jess::bench::Measurement;
+using jess::bench::timeLoop;
+
+// the values used by jess
+constexpr size_t CHUNK_SIZE = 1024;
+constexpr jess::ChunkCacheBudget CACHE_BUDGET{ 256 * 1024 * 1024, 0 };
+// lines scrolled by a page
+constexpr size_t PAGE_SIZE = 50;
+constexpr size_t MAX_PAGES = 20'000;
+constexpr size_t NUM_JUMPS = 100;
+constexpr size_t NUM_CHUNK_READS = 64;
+constexpr size_t MAX_INDEXED_CHUNKS = 4096;
+constexpr size_t NUM_LOOKUPS = 1'000'000;
+constexpr size_t NUM_CURSOR_OPERATIONS = 200'000;
+constexpr size_t NUM_TIMESTAMPS = 1'000'000;
+
+constexpr std::string_view CURSOR =
+  "s=72f9ece3caa84aaab5fd4eac74f04a32;i=2d39c1ee;b=2f9fe978f1b14fff91f8cc319b400956;m=21733b7;t=6075f19daf269;x=87e478517491f1d0";
+
+/// cheap deterministic pseudo random numbers, so that every run does the same work
+struct Lcg {
+  uint64_t state{ 0x2545f4914f6cdd1d };
+  uint64_t operator()()
+  {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return state >> 33;
+  }
+};
+
+/// benchmarks of ChunkedJournal and of building chunks, on a journal with entries entries
+template<jess::SeekableStream TJournal>
+void runJournalBenchmarks( BenchReport& report, const std::string& sSource, const int64_t entries, const std::function<TJournal()>& openJournal )
+{
+  const auto uEntries = static_cast<size_t>( entries );
+  // background loading is disabled, it would make the numbers depend on the scheduling of the worker
+  const auto makeJournal = [&] { return jess::ChunkedJournal<TJournal>{ CHUNK_SIZE, 0, CACHE_BUDGET, openJournal }; };
+
+  report.run( "ChunkedJournal.seekLines.forward", sSource, entries, [&] {
+    auto journal = makeJournal();
+    journal.seekToBof();
+    return timeLoop( std::min( uEntries / PAGE_SIZE, MAX_PAGES ), [&]( size_t ) {
+      journal.seekLines( PAGE_SIZE );
+      doNotOptimize( journal.getChunks().size() );
+    } );
+  } );
+
+  report.run( "ChunkedJournal.seekLines.backward", sSource, entries, [&] {
+    auto journal = makeJournal();
+    journal.seekToEof();
+    return timeLoop( std::min( uEntries / PAGE_SIZE, MAX_PAGES ), [&]( size_t ) {
+      journal.seekLines( -static_cast<int64_t>( PAGE_SIZE ) );
+      doNotOptimize( journal.getChunks().size() );
+    } );
+  } );
+
+  // jumps skip whole chunks without reading them
+  const auto jumpSize = static_cast<int64_t>( uEntries / ( NUM_JUMPS + 1 ) );
+  report.run( "ChunkedJournal.seekLines.jumpForward", sSource, entries, [&] {
+    auto journal = makeJournal();
+    journal.seekToBof();
+    return timeLoop( NUM_JUMPS, [&]( size_t ) {
+      journal.seekLines( jumpSize );
+      doNotOptimize( journal.getChunks().size() );
+    } );
+  } );
+
+  report.run( "ChunkedJournal.seekLines.jumpBackward", sSource, entries, [&] {
+    auto journal = makeJournal();
+    journal.seekToEof();
+    return timeLoop( NUM_JUMPS, [&]( size_t ) {
+      journal.seekLines( -jumpSize );
+      doNotOptimize( journal.getChunks().size() );
+    } );
+  } );
+
+  // what createChunkAtCurrentPosition() does after positioning the journal, per line
+  const auto readChunks = [&]( const bool bBackward ) {
+    TJournal journal = openJournal();
+    jess::ChunkArenaPool pool{};
+    std::vector<std::string> cursors{};
+    for ( size_t i = 0; i < NUM_CHUNK_READS; ++i )
+    {
+      journal.seekToBof();
+      journal.seekLinesForward( ( i * uEntries ) / NUM_CHUNK_READS );
+      cursors.push_back( journal.getCursor().toString() );
+    }
+
+    size_t uLines{};
+    const Measurement measurement = timeLoop( NUM_CHUNK_READS, [&]( const size_t i ) {
+      journal.seekToCursor( cursors[i] );
+      journal.next();
+      jess::Chunk chunk = bBackward ? jess::readChunkBackward( journal, pool, CHUNK_SIZE ) : jess::readChunkForward( journal, pool, CHUNK_SIZE );
+      uLines += chunk.size();
+      pool.release( std::move( chunk.arena ) );
+    } );
+    return Measurement{ uLines, measurement.duration };
+  };
+  report.run( "Chunk.readForward.perLine", sSource, entries, [&] { return readChunks( false ); } );
+  report.run( "Chunk.readBackward.perLine", sSource, entries, [&] { return readChunks( true ); } );
+
+  // what --dump does, the output is formatted but discarded
+  report.run( "dumpJournal.perLine", sSource, entries, [&] {
+    size_t uBytes{};
+    const auto discard = [&]( std::string& sBlock ) {
+      uBytes += sBlock.size();
+      sBlock.clear();
+      return true;
+    };
+    size_t uLines{};
+    const Measurement measurement = timeLoop( 1, [&]( size_t ) {
+      uLines = jess::dumpJournal<TJournal>( openJournal, {}, jess::DumpOptions{}, jess::OutputWriter::PIPE_BLOCK_SIZE, discard );
+    } );
+    doNotOptimize( uBytes );
+    return Measurement{ uLines, measurement.duration };
+  } );
+
+  // what getChunkBySeqid() does, with as many chunks as fit into the journal
+  report.run( "ChunkIndex.find", sSource, entries, [&] {
+    const size_t uNumChunks = std::clamp<size_t>( uEntries / CHUNK_SIZE, 1, MAX_INDEXED_CHUNKS );
+    std::list<jess::Chunk> chunks{};
+    jess::ChunkIndex<std::list<jess::Chunk>::iterator> index{};
+    for ( size_t i = 0; i < uNumChunks; ++i )
+    {
+      jess::Chunk& chunk = chunks.emplace_back();
+      chunk.addSeqid( jess::SdSeqid{ {}, { i * CHUNK_SIZE } } );
+      chunk.addSeqid( jess::SdSeqid{ {}, { i * CHUNK_SIZE + CHUNK_SIZE - 1 } } );
+      index.insert( std::prev( chunks.end() ) );
+    }
+
+    Lcg random{};
+    return timeLoop( NUM_LOOKUPS, [&]( size_t ) { doNotOptimize( index.find( jess::SdSeqid{ {}, { random() % ( uNumChunks * CHUNK_SIZE ) } } ) ); } );
+  } );
+
+  // the range queries within a cached chunk, which only read the columns they need
+  TJournal chunkJournal = openJournal();
+  jess::ChunkArenaPool chunkPool{};
+  chunkJournal.seekToBof();
+  chunkJournal.next();
+  const jess::Chunk chunk = jess::readChunkForward( chunkJournal, chunkPool, CHUNK_SIZE );
+
+  // what seekToTime() does for a cached time
+  report.run( "Chunk.lowerBoundRealtime", sSource, entries, [&] {
+    const auto span = std::chrono::duration_cast<std::chrono::microseconds>( chunk.maxRealtime - chunk.minRealtime ).count() + 1;
+    Lcg random{};
+    return timeLoop( NUM_LOOKUPS, [&]( size_t ) {
+      doNotOptimize( chunk.lowerBoundRealtime( chunk.minRealtime + std::chrono::microseconds{ static_cast<int64_t>( random() % static_cast<uint64_t>( span ) ) } ) );
+    } );
+  } );
+
+  // what jumping to the next error does within a chunk, from a random line to the end of the chunk
+  report.run( "Chunk.findPriority", sSource, entries, [&] {
+    Lcg random{};
+    return timeLoop( NUM_LOOKUPS, [&]( size_t ) { doNotOptimize( chunk.findPriority( random() % chunk.size(), 3, jess::Adjacency::AFTER_CURRENT ) ); } );
+  } );
+
+  // what restoring a position does once the chunk of the line is known
+  report.run( "Chunk.indexOf", sSource, entries, [&] {
+    Lcg random{};
+    return timeLoop( NUM_LOOKUPS, [&]( size_t ) { doNotOptimize( chunk.indexOf( chunk.seqid( random() % chunk.size() ) ) ); } );
+  } );
+}
+
+void runCursorBenchmarks( BenchReport& report )
+{
+  report.run( "SdCursor.fromString", "", 0, [] {
+    return timeLoop( NUM_CURSOR_OPERATIONS, []( size_t ) { doNotOptimize( jess::SdCursor::fromString( CURSOR ) ); } );
+  } );
+
+  report.run( "SdCursor.toString", "", 0, [] {
+    const jess::SdCursor cursor = jess::SdCursor::fromString( CURSOR );
+    return timeLoop( NUM_CURSOR_OPERATIONS, [&]( size_t ) { doNotOptimize( cursor.toString() ); } );
+  } );
+
+  report.run( "SdCursor.format", "", 0, [] {
+    const jess::SdCursor cursor = jess::SdCursor::fromString( CURSOR );
+    std::array<char, jess::SdCursor::MAX_STRING_LENGTH> buffer{};
+    return timeLoop( NUM_CURSOR_OPERATIONS, [&]( size_t ) {
+      doNotOptimize( cursor.format( buffer.data() ) );
+      doNotOptimize( buffer );
+    } );
+  } );
+
+  report.run( "SdCursor.toBinary", "", 0, [] {
+    const jess::SdCursor cursor = jess::SdCursor::fromString( CURSOR );
+    return timeLoop( NUM_CURSOR_OPERATIONS, [&]( size_t ) { doNotOptimize( cursor.toBinary() ); } );
+  } );
+
+  report.run( "SdCursor.fromBinary", "", 0, [] {
+    const jess::SdCursor::Binary binary = jess::SdCursor::fromString( CURSOR ).toBinary();
+    return timeLoop( NUM_CURSOR_OPERATIONS, [&]( size_t ) { doNotOptimize( jess::SdCursor::fromBinary( binary ) ); } );
+  } );
+}
+
+void runTimestampBenchmarks( BenchReport& report )
+{
+  const auto start = std::chrono::system_clock::time_point{ std::chrono::seconds{ 1'700'000'000 } };
+
+  const auto formatTimestamps = [&]( const jess::TimestampFormat format, const std::chrono::microseconds step ) {
+    jess::TimestampFormatter formatTimestamp{ format };
+    return timeLoop( NUM_TIMESTAMPS, [&]( const size_t i ) { doNotOptimize( formatTimestamp( start + static_cast<int64_t>( i ) * step ).data() ); } );
+  };
+
+  // consecutive entries mostly share the minute, which the formatter caches
+  report.run( "TimestampFormatter.utc.consecutive", "", 0, [&] { return formatTimestamps( {}, std::chrono::milliseconds{ 10 } ); } );
+  report.run( "TimestampFormatter.utc.scattered", "", 0, [&] { return formatTimestamps( {}, std::chrono::minutes{ 7 } ); } );
+  report.run( "TimestampFormatter.local.scattered", "", 0, [&] { return formatTimestamps( { true, false }, std::chrono::minutes{ 7 } ); } );
+  report.run( "TimestampFormatter.usec.consecutive", "", 0, [&] { return formatTimestamps( { false, true }, std::chrono::milliseconds{ 10 } ); } );
+}
+
+/// number of entries of the journal, by walking through it
+int64_t countEntries( jess::SdJournal& journal )
+{
+  int64_t entries{};
+  journal.seekToBof();
+  while ( journal.next() )
+  {
+    ++entries;
+  }
+  return entries;
+}
+
+std::vector<int64_t> parseEntries( std::string_view sValue )
+{
+  std::vector<int64_t> entries{};
+  while ( !sValue.empty() )
+  {
+    const size_t uSeparator = std::min( sValue.find( ',' ), sValue.size() );
+    entries.push_back( std::strtoll( std::string{ sValue.substr( 0, uSeparator ) }.c_str(), nullptr, 10 ) );
+    sValue.remove_prefix( std::min( uSeparator + 1, sValue.size() ) );
+  }
+  return entries;
+}
+
+}// namespace
+
+int main( int argc, char** argv )
+{
+  std::vector<int64_t> entries{ 100'000, 1'000'000 };
+  std::string sDirectory{};
+  size_t uRepetitions = 3;
+  std::string sOutput{};
+
+  for ( int i = 1; i < argc; ++i )
+  {
+    const std::string_view sArgument{ argv[i] };
+    const auto value = [&]( const std::string_view sName ) { return sArgument.substr( sName.size() ); };
+    if ( sArgument.starts_with( "--entries=" ) )
+    {
+      entries = parseEntries( value( "--entries=" ) );
+    }
+    else if ( sArgument.starts_with( "--directory=" ) )
+    {
+      sDirectory = value( "--directory=" );
+    }
+    else if ( sArgument.starts_with( "--repetitions=" ) )
+    {
+      uRepetitions = std::strtoull( std::string{ value( "--repetitions=" ) }.c_str(), nullptr, 10 );
+    }
+    else if ( sArgument.starts_with( "--output=" ) )
+    {
+      sOutput = value( "--output=" );
+    }
+    else
+    {
+      std::fprintf( stderr, "usage: %s [--entries=N[,N...]] [--directory=DIR] [--repetitions=N] [--output=FILE]\n", argv[0] );
+      return 1;
+    }
+  }
+  if ( std::any_of( entries.begin(), entries.end(), []( const int64_t n ) { return n < static_cast<int64_t>( CHUNK_SIZE ); } ) )
+  {
+    std::fprintf( stderr, "the synthetic journals need at least %zu entries\n", CHUNK_SIZE );
+    return 1;
+  }
+
+  BenchReport report{ uRepetitions };
+
+  for ( const int64_t n : entries )
+  {
+    runJournalBenchmarks<jess::bench::SyntheticStream>( report, "synthetic", n, [n] { return jess::bench::SyntheticStream{ n }; } );
+  }
+
+  if ( !sDirectory.empty() )
+  {
+    const jess::JournalScope scope{ 0, sDirectory, {} };
+    try
+    {
+      jess::SdJournal journal{ scope };
+      const int64_t uNumEntries = countEntries( journal );
+      if ( uNumEntries == 0 )
+      {
+        std::fprintf( stderr, "error: no journal entries in %s\n", sDirectory.c_str() );
+        return 1;
+      }
+      runJournalBenchmarks<jess::SdJournal>( report, sDirectory, uNumEntries, [&scope] { return jess::SdJournal{ scope }; } );
+    }
+    catch ( const jess::SdError& ex )
+    {
+      std::fprintf( stderr, "error: %s\n", ex.what() );
+      return 1;
+    }
+  }
+
+  runCursorBenchmarks( report );
+  runTimestampBenchmarks( report );
+
+  std::FILE* pOutput = sOutput.empty() ? stdout : std::fopen( sOutput.c_str(), "w" );
+  if ( !pOutput )
+  {
+    std::fprintf( stderr, "cannot write %s\n", sOutput.c_str() );
+    return 1;
+  }
+  report.writeJson( pOutput );
+  if ( pOutput != stdout )
+  {
+    std::fclose( pOutput );
+  }
+  return 0;
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "SdCursor.hpp"
+#include "SdLine.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace jess::bench
+{
+
+/// in-memory journal with deterministic entries of varying message length
+///
+/// like sd_journal, a failed next() / previous() keeps the stream at the current entry and the message returned by
+/// getLine() is only valid until the stream moves
+class SyntheticStream
+{
+  int64_t m_uLength;
+  int64_t m_pos{ -1 };
+  bool m_bOnCursor{};
+  std::string m_sMessage{};
+  std::string m_sField{};
+  uint8_t m_uPriority{};
+
+public:
+  static constexpr int64_t DEFAULT_LENGTH = 1'000'000;
+
+  explicit SyntheticStream( const int64_t uLength = DEFAULT_LENGTH )
+    : m_uLength( uLength )
+  {
+    m_sMessage.reserve( 256 );
+  }
+
+  [[nodiscard]] int64_t length() const { return m_uLength; }
+
+  void seekToBof() { m_pos = -1; }
+
+  void seekToEof() { m_pos = m_uLength; }
+
+  void seekToCursor( const std::string& sCursor )
+  {
+    m_pos = static_cast<int64_t>( SdCursor::fromString( sCursor ).seqid.seqnum.value );
+    m_bOnCursor = true;
+  }
+
+  /// entry i is at i seconds after the epoch
+  void seekToRealtime( const std::chrono::time_point<std::chrono::system_clock> realtime )
+  {
+    m_pos = std::clamp<int64_t>( std::chrono::ceil<std::chrono::seconds>( realtime.time_since_epoch() ).count() - 1, -1, m_uLength - 1 );
+    m_bOnCursor = false;
+  }
+
+  void seekLinesForward( const size_t uNumLines )
+  {
+    m_pos = std::min( m_pos + static_cast<int64_t>( uNumLines ), m_uLength - 1 );
+    load();
+  }
+
+  void seekLinesBackward( const size_t uNumLines )
+  {
+    m_pos = std::max<int64_t>( m_pos - static_cast<int64_t>( uNumLines ), 0 );
+    load();
+  }
+
+  bool next()
+  {
+    if ( std::exchange( m_bOnCursor, false ) )
+    {
+      load();
+      return true;
+    }
+    if ( m_pos + 1 >= m_uLength )
+    {
+      return false;
+    }
+    ++m_pos;
+    load();
+    return true;
+  }
+
+  bool previous()
+  {
+    if ( std::exchange( m_bOnCursor, false ) )
+    {
+      load();
+      return true;
+    }
+    if ( m_pos <= 0 )
+    {
+      return false;
+    }
+    --m_pos;
+    load();
+    return true;
+  }
+
+  [[nodiscard]] SdSeqid getSeqid() const { return SdSeqid{ {}, { static_cast<size_t>( m_pos ) } }; }
+
+  SdLine getLine()
+  {
+    return SdLine{ getSeqid(), m_sMessage, std::chrono::system_clock::time_point{ std::chrono::seconds{ m_pos } }, false, nullptr, {}, m_uPriority };
+  }
+
+  /// "_PID" is derived from the position, other fields are missing
+  std::string_view getFieldString( const std::string_view sFieldName )
+  {
+    if ( sFieldName != "_PID" )
+    {
+      return {};
+    }
+    m_sField.assign( std::to_string( 1 + m_pos % 32768 ) );
+    return m_sField;
+  }
+
+  [[nodiscard]] SdCursor getCursor() const
+  {
+    const auto seqid = getSeqid();
+    return SdCursor{ seqid, {}, seqid.seqnum.value, seqid.seqnum.value, 0 };
+  }
+
+private:
+  void load()
+  {
+    // splitmix64, so that every entry has the same message no matter how it was reached
+    uint64_t uHash = static_cast<uint64_t>( m_pos ) + 0x9e3779b97f4a7c15;
+    uHash = ( uHash ^ ( uHash >> 30 ) ) * 0xbf58476d1ce4e5b9;
+    uHash = ( uHash ^ ( uHash >> 27 ) ) * 0x94d049bb133111eb;
+    uHash ^= uHash >> 31;
+
+    // about one entry in 256 is an error, the others are warnings, notices or infos
+    m_uPriority = static_cast<uint8_t>( ( uHash >> 32 ) % 256 == 0 ? 3 : 4 + ( uHash >> 40 ) % 3 );
+    // typical journal messages are a few dozen to a few hundred bytes long
+    const size_t uMessageLength = 20 + uHash % 200;
+    // appended piecewise, so that the buffer reserved up front is reused and the stream itself does not allocate
+    m_sMessage.assign( "entry " );
+    m_sMessage.append( std::to_string( m_pos ) );
+    m_sMessage.append( ": " );
+    m_sMessage.resize( std::max( m_sMessage.size(), uMessageLength ), static_cast<char>( 'a' + uHash % 26 ) );
+  }
+};
+
+}// namespace jess::bench
@@ -0,0 +1,61 @@
+#!/bin/sh
+# builds journal files for "bench --directory=DIR" from journal export format
+#
+# usage: make_fixture_journal.sh DIR [NUM_ENTRIES | EXPORT_FILE...]
+#   with a number, that many synthetic entries are generated (default: 1000000), 10 per second from 2024-01-01 on
+#   with export files, e.g. from "journalctl -o export", their entries are imported instead
+# needs systemd-journal-remote, which is packaged separately on some distributions (e.g. systemd-journal-remote)
+set -eu
+
+if [ $# -lt 1 ]; then
+    sed -n '2,7p' "$0" | sed 's/^# \{0,1\}//' >&2
+    exit 1
+fi
+
+directory=$1
+shift
+
+remote=$(command -v systemd-journal-remote || true)
+for candidate in /usr/lib/systemd/systemd-journal-remote /lib/systemd/systemd-journal-remote; do
+    if [ -z "$remote" ] && [ -x "$candidate" ]; then
+        remote=$candidate
+    fi
+done
+if [ -z "$remote" ]; then
+    echo "error: systemd-journal-remote not found" >&2
+    exit 1
+fi
+
+mkdir -p "$directory"
+output="$directory/fixture.journal"
+rm -f "$output"
+
+if [ $# -eq 0 ] || { [ $# -eq 1 ] && [ ! -f "$1" ]; }; then
+    # synthetic entries of a few services with messages of typical lengths and a few long ones
+    awk -v entries="${1:-1000000}" 'BEGIN {
+        srand(1);
+        boot = "2f9fe978f1b14fff91f8cc319b400956";
+        split("cron.service sshd.service nginx.service postgresql.service kernel", units, " ");
+        filler = "lorem ipsum dolor sit amet ";
+        while (length(filler) < 100000) {
+            filler = filler filler;
+        }
+        for (i = 0; i < entries; i++) {
+            unit = units[1 + int(rand() * 5)];
+            length_ = (i % 10007 == 0) ? 100000 : 20 + int(rand() * 200);
+            message = sprintf("entry %d of %s: ", i, unit) filler;
+            printf "__REALTIME_TIMESTAMP=%.0f\n", 1704067200000000 + i * 100000;
+            printf "__MONOTONIC_TIMESTAMP=%.0f\n", i * 100000;
+            printf "_BOOT_ID=%s\n", boot;
+            printf "_HOSTNAME=bench\n";
+            printf "_SYSTEMD_UNIT=%s\n", unit;
+            printf "_PID=%d\n", 100 + int(rand() * 30000);
+            printf "PRIORITY=%d\n", int(rand() * 8);
+            printf "MESSAGE=%s\n\n", substr(message, 1, length_);
+        }
+    }' | "$remote" --output="$output" -
+else
+    "$remote" --output="$output" "$@"
+fi
+
+echo "$output"
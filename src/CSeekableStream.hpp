@@ -1,8 +1,11 @@
 #pragma once
 
+#include "SdCursor.hpp"
 #include "SdLine.hpp"
+#include <chrono>
 #include <concepts>
 #include <cstddef>
+#include <string_view>
 
 namespace jess
 {
@@ -34,6 +37,50 @@ concept SeekableStream = requires( T a ) {
   {
     a.getSeqid()
   } -> std::same_as<SdSeqid>;
+  // the value of a field of the current entry, empty if the entry does not have it; may invalidate the line
+  {
+    a.getFieldString( std::declval<std::string_view>() )
+  } -> std::same_as<std::string_view>;
+  {
+    a.getCursor()
+  } -> std::same_as<SdCursor>;
+  {
+    a.seekToCursor( std::declval<const std::string&>() )
+  } -> std::same_as<void>;
+  // the next step forward lands on the first entry at or after the time
+  {
+    a.seekToRealtime( std::declval<std::chrono::time_point<std::chrono::system_clock>>() )
+  } -> std::same_as<void>;
 };
 
+/// true if the last failed step of the journal stopped short of the beginning or end of the journal, e.g. because a
+/// FilteredStream ran out of its scan budget; such a failure must not be taken for a boundary of the journal
+template<SeekableStream TJournal>
+bool journalStoppedEarly( const TJournal& journal )
+{
+  if constexpr ( requires { { journal.budgetExhausted() } -> std::same_as<bool>; } )
+  {
+    return journal.budgetExhausted();
+  }
+  else
+  {
+    return false;
+  }
+}
+
+/// the realtime of the current entry, read without its message where the journal allows it, see
+/// SdJournal::getTimestampRealtime()
+template<SeekableStream TJournal>
+std::chrono::time_point<std::chrono::system_clock> realtimeOf( TJournal& journal )
+{
+  if constexpr ( requires { { journal.getTimestampRealtime() } -> std::same_as<std::chrono::time_point<std::chrono::system_clock>>; } )
+  {
+    return journal.getTimestampRealtime();
+  }
+  else
+  {
+    return journal.getLine().realtime();
+  }
+}
+
 }// namespace jess
\ No newline at end of file
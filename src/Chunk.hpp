@@ -0,0 +1,534 @@
+#pragma once
+
+#include "CSeekableStream.hpp"
+#include "SdCursor.hpp"
+#include "SdLine.hpp"
+#include "SeqnumIdTable.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jess
+{
+
+enum class Adjacency {
+  NON_ADJACENT,
+  AFTER_CURRENT,
+  BEFORE_CURRENT,
+};
+
+enum class Contiguity {
+  CONTIGUOUS,
+  NON_CONTIGUOUS,
+  OVERLAPPING,
+};
+
+/// recycles the message storage of evicted chunks
+///
+/// chunks are built on the ui thread and on the prefetch worker, so the pool is thread-safe
+class ChunkArenaPool
+{
+  // arenas above this capacity are freed instead of being kept around after a burst of huge messages
+  static constexpr size_t MAX_POOLED_CAPACITY = 4 * 1024 * 1024;
+  static constexpr size_t MAX_POOLED_ARENAS = 16;
+
+  mutable std::mutex m_mutex{};
+  std::vector<std::vector<char>> m_arenas{};
+
+public:
+  /// returns an empty arena with at least the given capacity, reusing a released one if possible
+  [[nodiscard]] std::vector<char> acquire( const size_t uMinCapacity )
+  {
+    std::vector<char> arena{};
+    {
+      std::scoped_lock lock{ m_mutex };
+      if ( !m_arenas.empty() )
+      {
+        arena = std::move( m_arenas.back() );
+        m_arenas.pop_back();
+      }
+    }
+    arena.reserve( uMinCapacity );
+    return arena;
+  }
+
+  void release( std::vector<char>&& arena )
+  {
+    if ( arena.capacity() == 0 || arena.capacity() > MAX_POOLED_CAPACITY )
+    {
+      return;
+    }
+    arena.clear();
+    std::scoped_lock lock{ m_mutex };
+    if ( m_arenas.size() < MAX_POOLED_ARENAS )
+    {
+      m_arenas.push_back( std::move( arena ) );
+    }
+  }
+
+  [[nodiscard]] size_t size() const
+  {
+    std::scoped_lock lock{ m_mutex };
+    return m_arenas.size();
+  }
+};
+
+/// where the message of a line of a chunk is stored in the arena of the chunk
+struct MessageRef {
+  uint32_t offset;
+  // the flag shares the word with the length, messages are capped far below 2 GiB by the data threshold
+  uint32_t length : 31;
+  uint32_t truncated : 1;
+};
+
+namespace detail
+{
+
+// number of values checked before testing for a match, a multiple of the vector widths of common targets
+inline constexpr size_t SCAN_BLOCK_SIZE = 32;
+
+/// returns the index of the first value at or after uFrom that matches, values.size() if there is none
+///
+/// the values are checked block by block without an early exit inside a block, so that the compiler can turn the
+/// comparisons of a block into a few vector instructions
+template<typename T, typename TPredicate>
+size_t findFirst( const std::span<const T> values, size_t uFrom, const TPredicate& matches )
+{
+  for ( ; uFrom + SCAN_BLOCK_SIZE <= values.size(); uFrom += SCAN_BLOCK_SIZE )
+  {
+    const T* pBlock = values.data() + uFrom;
+    unsigned uAny = 0;
+    for ( size_t i = 0; i < SCAN_BLOCK_SIZE; ++i )
+    {
+      uAny |= matches( pBlock[i] ) ? 1U : 0U;
+    }
+    if ( uAny != 0 )
+    {
+      break;
+    }
+  }
+  for ( ; uFrom < values.size(); ++uFrom )
+  {
+    if ( matches( values[uFrom] ) )
+    {
+      return uFrom;
+    }
+  }
+  return values.size();
+}
+
+/// returns the index of the last value before uEnd that matches, nothing if there is none; see findFirst()
+template<typename T, typename TPredicate>
+std::optional<size_t> findLast( const std::span<const T> values, size_t uEnd, const TPredicate& matches )
+{
+  for ( ; uEnd >= SCAN_BLOCK_SIZE; uEnd -= SCAN_BLOCK_SIZE )
+  {
+    const T* pBlock = values.data() + uEnd - SCAN_BLOCK_SIZE;
+    unsigned uAny = 0;
+    for ( size_t i = 0; i < SCAN_BLOCK_SIZE; ++i )
+    {
+      uAny |= matches( pBlock[i] ) ? 1U : 0U;
+    }
+    if ( uAny != 0 )
+    {
+      break;
+    }
+  }
+  for ( ; uEnd > 0; --uEnd )
+  {
+    if ( matches( values[uEnd - 1] ) )
+    {
+      return uEnd - 1;
+    }
+  }
+  return std::nullopt;
+}
+
+/// returns the index of the first value not less than value in the ascending values
+///
+/// the range is halved with a conditional move instead of a branch, which the cpu cannot mispredict
+template<typename T>
+size_t lowerBound( const std::span<const T> values, const T value )
+{
+  if ( values.empty() )
+  {
+    return 0;
+  }
+  const T* pBase = values.data();
+  for ( size_t uLength = values.size(); uLength > 1; uLength -= uLength / 2 )
+  {
+    pBase = pBase[uLength / 2] < value ? pBase + uLength / 2 : pBase;
+  }
+  return static_cast<size_t>( pBase - values.data() ) + ( *pBase < value ? 1 : 0 );
+}
+
+}// namespace detail
+
+/// the seqnums of the lines of a chunk with the same seqnum id
+struct SeqnumRange {
+  // index of the seqnum id in SeqnumIdTable::global()
+  uint32_t seqnumId;
+  SdSeqnum lowest;
+  SdSeqnum highest;
+};
+
+struct Chunk {
+  // rough guess of the average message length, used to size fresh arenas
+  static constexpr size_t EXPECTED_MESSAGE_SIZE = 128;
+  static constexpr size_t EXPECTED_FIELD_SIZE = 16;
+
+  // one range per seqnum id of the lines, sorted by the seqnum id; usually just one
+  std::vector<SeqnumRange> seqnumRanges{};
+  // the lines column by column, so that scanning the timestamps, priorities or seqnums of a chunk reads nothing else.
+  // The columns are always of the same length.
+  std::vector<uint64_t> seqnums{};
+  // index of the seqnum id of each line in SeqnumIdTable::global()
+  std::vector<uint32_t> seqnumIds{};
+  // microseconds since the epoch, the resolution of the journal
+  std::vector<int64_t> realtimes{};
+  std::vector<uint8_t> priorities{};
+  std::vector<MessageRef> messages{};
+  // the messages and field values of all lines back to back, one allocation per chunk instead of one per line
+  std::vector<char> arena{};
+  // the values of the projected columns, columnCount per line in the order of the lines
+  std::vector<FieldRef> fields{};
+  size_t columnCount{};
+  Contiguity contiguityBeginning{ Contiguity::NON_CONTIGUOUS };
+  Contiguity contiguityEnd{ Contiguity::NON_CONTIGUOUS };
+  // cursors of the first and the last line, used to reposition a journal at the chunk boundaries
+  SdCursor cursorFirst{};
+  SdCursor cursorLast{};
+  // set if there is no entry before the first / after the last line
+  bool isFirstInJournal{};
+  bool isLastInJournal{};
+  // time range of the lines, used to find a time in the cache without touching the journal
+  std::chrono::time_point<std::chrono::system_clock> minRealtime{ std::chrono::time_point<std::chrono::system_clock>::max() };
+  std::chrono::time_point<std::chrono::system_clock> maxRealtime{ std::chrono::time_point<std::chrono::system_clock>::min() };
+  // bookkeeping of the chunk cache
+  size_t sizeInBytes{};
+  uint64_t lastUsed{};
+
+  [[nodiscard]] size_t size() const { return seqnums.size(); }
+  [[nodiscard]] bool empty() const { return seqnums.empty(); }
+
+  [[nodiscard]] SdSeqid firstSeqid() const { return seqid( 0 ); }
+  [[nodiscard]] SdSeqid lastSeqid() const { return seqid( size() - 1 ); }
+
+  [[nodiscard]] SdSeqid seqid( const size_t uIndex ) const { return SdSeqid{ SeqnumIdTable::global().id( seqnumIds[uIndex] ), { seqnums[uIndex] } }; }
+
+  [[nodiscard]] std::chrono::time_point<std::chrono::system_clock> realtime( const size_t uIndex ) const
+  {
+    return std::chrono::time_point<std::chrono::system_clock>{ std::chrono::microseconds{ realtimes[uIndex] } };
+  }
+
+  /// returns the line at the given index, its message refers to the arena and is invalidated by appending to the chunk
+  [[nodiscard]] SdLine line( const size_t uIndex ) const
+  {
+    return SdLine{ seqid( uIndex ), message( uIndex ), realtime( uIndex ), messages[uIndex].truncated != 0, arena.data(),
+      std::span{ fields }.subspan( uIndex * columnCount, columnCount ), priorities[uIndex] };
+  }
+
+  /// the message of the line at the given index, cheaper than line() if nothing else is needed
+  [[nodiscard]] std::string_view message( const size_t uIndex ) const
+  {
+    const MessageRef& message = messages[uIndex];
+    return std::string_view{ arena.data() + message.offset, message.length };
+  }
+
+  [[nodiscard]] std::optional<size_t> indexOf( const SdSeqid seqid ) const
+  {
+    const auto seqnumId = SeqnumIdTable::global().find( seqid.seqnumId );
+    if ( !seqnumId || empty() )
+    {
+      return std::nullopt;
+    }
+    // without a filter, the lines of a chunk usually have consecutive seqnums, which gives the index right away
+    const uint64_t uGuess = seqid.seqnum.value - seqnums.front();
+    if ( uGuess < size() && seqnums[uGuess] == seqid.seqnum.value && seqnumIds[uGuess] == *seqnumId )
+    {
+      return uGuess;
+    }
+    // the seqnums of different seqnum ids may collide, which is rare enough to simply continue the scan
+    const auto isSeqnum = [uSeqnum = seqid.seqnum.value]( const uint64_t uValue ) { return uValue == uSeqnum; };
+    for ( size_t i = detail::findFirst( std::span{ seqnums }, 0, isSeqnum ); i < size(); i = detail::findFirst( std::span{ seqnums }, i + 1, isSeqnum ) )
+    {
+      if ( seqnumIds[i] == *seqnumId )
+      {
+        return i;
+      }
+    }
+    return std::nullopt;
+  }
+
+  /// returns the index of the first line at or after the time, size() if there is none
+  ///
+  /// the timestamps are assumed to be ascending, which holds for the journal apart from jumps of the system clock
+  [[nodiscard]] size_t lowerBoundRealtime( const std::chrono::time_point<std::chrono::system_clock> realtime ) const
+  {
+    return detail::lowerBound( std::span<const int64_t>{ realtimes }, std::chrono::ceil<std::chrono::microseconds>( realtime.time_since_epoch() ).count() );
+  }
+
+  /// returns the index of the first line at or after uFrom (in forward direction) or at or before uFrom (backward) with a
+  /// priority at or below uMaxPriority, i.e. at least as severe; nothing if there is none
+  [[nodiscard]] std::optional<size_t> findPriority( const size_t uFrom, const uint8_t uMaxPriority, const Adjacency direction ) const
+  {
+    const auto isSevere = [uMaxPriority]( const uint8_t uPriority ) { return uPriority <= uMaxPriority; };
+    if ( direction == Adjacency::BEFORE_CURRENT )
+    {
+      return detail::findLast( std::span{ priorities }, std::min( uFrom + 1, size() ), isSevere );
+    }
+    const size_t uIndex = detail::findFirst( std::span{ priorities }, uFrom, isSevere );
+    return uIndex < size() ? std::optional{ uIndex } : std::nullopt;
+  }
+
+  /// copies the line into the chunk
+  void append( const SdLine& line )
+  {
+    const std::string_view sMessage = line.message();
+    const auto uOffset = static_cast<uint32_t>( arena.size() );
+    arena.insert( arena.end(), sMessage.begin(), sMessage.end() );
+    const uint32_t seqnumId = internSeqnumId( line.seqid().seqnumId );
+    seqnums.push_back( line.seqid().seqnum.value );
+    seqnumIds.push_back( seqnumId );
+    realtimes.push_back( std::chrono::duration_cast<std::chrono::microseconds>( line.realtime().time_since_epoch() ).count() );
+    priorities.push_back( line.priority() );
+    messages.push_back( MessageRef{ uOffset, static_cast<uint32_t>( sMessage.size() ), line.truncated() ? 1U : 0U } );
+    addSeqnum( seqnumId, line.seqid().seqnum );
+    minRealtime = std::min( minRealtime, line.realtime() );
+    maxRealtime = std::max( maxRealtime, line.realtime() );
+  }
+
+  /// copies the value of the next column of the last line into the chunk
+  void appendField( const std::string_view sValue )
+  {
+    fields.push_back( FieldRef{ static_cast<uint32_t>( arena.size() ), static_cast<uint32_t>( sValue.size() ) } );
+    arena.insert( arena.end(), sValue.begin(), sValue.end() );
+  }
+
+  void addSeqid( const SdSeqid seqid ) { addSeqnum( internSeqnumId( seqid.seqnumId ), seqid.seqnum ); }
+
+  /// widens the range of the seqnum id to the seqnum, lines may be added in either direction
+  void addSeqnum( const uint32_t seqnumId, const SdSeqnum seqnum )
+  {
+    const auto it = std::lower_bound( seqnumRanges.begin(), seqnumRanges.end(), seqnumId, []( const SeqnumRange& range, const uint32_t id ) { return range.seqnumId < id; } );
+    if ( it == seqnumRanges.end() || it->seqnumId != seqnumId )
+    {
+      seqnumRanges.insert( it, SeqnumRange{ seqnumId, seqnum, seqnum } );
+      return;
+    }
+    it->lowest = std::min( it->lowest, seqnum );
+    it->highest = std::max( it->highest, seqnum );
+  }
+
+  /// reserves room for uNumLines lines in all columns
+  void reserve( const size_t uNumLines )
+  {
+    seqnums.reserve( uNumLines );
+    seqnumIds.reserve( uNumLines );
+    realtimes.reserve( uNumLines );
+    priorities.reserve( uNumLines );
+    messages.reserve( uNumLines );
+  }
+
+  /// reverses the order of the lines
+  ///
+  /// only the lines are reordered, their messages stay where they are in the arena. Reversing all field references
+  /// reverses the columns of each line as well, which is undone line by line.
+  void reverse()
+  {
+    std::reverse( seqnums.begin(), seqnums.end() );
+    std::reverse( seqnumIds.begin(), seqnumIds.end() );
+    std::reverse( realtimes.begin(), realtimes.end() );
+    std::reverse( priorities.begin(), priorities.end() );
+    std::reverse( messages.begin(), messages.end() );
+    std::reverse( fields.begin(), fields.end() );
+    for ( auto it = fields.begin(); it != fields.end(); it += static_cast<std::ptrdiff_t>( columnCount ) )
+    {
+      std::reverse( it, it + static_cast<std::ptrdiff_t>( columnCount ) );
+    }
+  }
+
+  [[nodiscard]] size_t computeSizeInBytes() const
+  {
+    return sizeof( Chunk ) + seqnums.capacity() * sizeof( uint64_t ) + seqnumIds.capacity() * sizeof( uint32_t ) + realtimes.capacity() * sizeof( int64_t ) +
+      priorities.capacity() + messages.capacity() * sizeof( MessageRef ) + arena.capacity() + fields.capacity() * sizeof( FieldRef ) +
+      seqnumRanges.capacity() * sizeof( SeqnumRange );
+  }
+
+private:
+  // consecutive lines almost always share the seqnum id, so the last one is remembered instead of searching the table
+  std::optional<std::pair<SdSeqnumId, uint32_t>> m_lastSeqnumId{};
+
+  uint32_t internSeqnumId( const SdSeqnumId& seqnumId )
+  {
+    if ( !m_lastSeqnumId || m_lastSeqnumId->first != seqnumId )
+    {
+      m_lastSeqnumId.emplace( seqnumId, SeqnumIdTable::global().intern( seqnumId ) );
+    }
+    return m_lastSeqnumId->second;
+  }
+};
+
+/// positions the journal at the first entry after (or before) the anchor
+///
+/// returns false if there is no such entry
+template<SeekableStream TJournal>
+bool seekBeyondCursor( TJournal& journal, const SdCursor& anchor, const Adjacency adjacency )
+{
+  const bool bForward = adjacency == Adjacency::AFTER_CURRENT;
+  const auto step = [&] { return bForward ? journal.next() : journal.previous(); };
+
+  journal.seekToCursor( anchor.toString() );
+
+  // the first step lands on the anchor itself, unless it has been removed from the journal in the meantime
+  if ( !step() )
+  {
+    return false;
+  }
+  return journal.getSeqid() != anchor.seqid || step();
+}
+
+/// copies the line and the values of the columns of the current entry of the journal into the chunk
+///
+/// only the projected fields are read from the journal. The message of the line must be copied before, as reading
+/// other fields of the entry may invalidate it.
+template<SeekableStream TJournal>
+void appendEntry( TJournal& journal, Chunk& chunk, const SdLine& line, const std::span<const std::string> columns )
+{
+  chunk.append( line );
+  for ( const std::string& sColumn : columns )
+  {
+    chunk.appendField( journal.getFieldString( sColumn ) );
+  }
+}
+
+/// appends up to uNumLines lines starting at (and including) the current entry of the journal to the end of the chunk
+///
+/// the chunk must have been read with the same columns.
+/// reading stops early at the line stopAt, which is usually the first line of an already cached chunk; in that case the
+/// end of the chunk is marked as contiguous. It is marked as the end of the journal if that is reached, but not if the
+/// journal stopped early, see journalStoppedEarly().
+/// the journal must be positioned at a valid entry; afterwards it is positioned after the last line of the chunk.
+/// returns the number of lines appended
+template<SeekableStream TJournal>
+size_t appendChunkForward( TJournal& journal, Chunk& chunk, const size_t uNumLines, const std::optional<SdSeqid> stopAt = {},
+  const std::span<const std::string> columns = {} )
+{
+  chunk.isLastInJournal = false;
+
+  for ( size_t i = 0; i < uNumLines; ++i )
+  {
+    const SdLine line = journal.getLine();
+    if ( stopAt && line.seqid() == *stopAt )
+    {
+      chunk.contiguityEnd = Contiguity::CONTIGUOUS;
+      if ( i > 0 && journal.previous() )
+      {
+        chunk.cursorLast = journal.getCursor();
+      }
+      return i;
+    }
+
+    appendEntry( journal, chunk, line, columns );
+
+    // only query the cursor of the last line, a failed next() keeps the journal at the current entry
+    const bool bLastLine = i + 1 == uNumLines;
+    if ( bLastLine )
+    {
+      chunk.cursorLast = journal.getCursor();
+    }
+
+    if ( !journal.next() )
+    {
+      if ( !bLastLine )
+      {
+        chunk.cursorLast = journal.getCursor();
+      }
+      chunk.isLastInJournal = !journalStoppedEarly( journal );
+      return i + 1;
+    }
+  }
+
+  return uNumLines;
+}
+
+/// returns an empty chunk with room for uNumLines lines
+inline Chunk makeChunk( ChunkArenaPool& arenaPool, const size_t uNumLines, const size_t uNumColumns )
+{
+  Chunk chunk{};
+  chunk.reserve( uNumLines );
+  chunk.fields.reserve( uNumLines * uNumColumns );
+  chunk.columnCount = uNumColumns;
+  chunk.arena = arenaPool.acquire( uNumLines * ( Chunk::EXPECTED_MESSAGE_SIZE + uNumColumns * Chunk::EXPECTED_FIELD_SIZE ) );
+  return chunk;
+}
+
+/// reads up to uNumLines lines starting at (and including) the current entry of the journal in forward direction
+///
+/// the values of the columns are stored along with the lines. See appendChunkForward()
+template<SeekableStream TJournal>
+Chunk readChunkForward( TJournal& journal, ChunkArenaPool& arenaPool, const size_t uNumLines, const std::optional<SdSeqid> stopAt = {},
+  const std::span<const std::string> columns = {} )
+{
+  Chunk chunk = makeChunk( arenaPool, uNumLines, columns.size() );
+  chunk.cursorFirst = journal.getCursor();
+  appendChunkForward( journal, chunk, uNumLines, stopAt, columns );
+  return chunk;
+}
+
+/// reads up to uNumLines lines ending at (and including) the current entry of the journal in backward direction
+///
+/// reading stops early at the line stopAt, see appendChunkForward().
+/// the journal must be positioned at a valid entry; afterwards it is positioned before the first line of the chunk
+template<SeekableStream TJournal>
+Chunk readChunkBackward( TJournal& journal, ChunkArenaPool& arenaPool, const size_t uNumLines, const std::optional<SdSeqid> stopAt = {},
+  const std::span<const std::string> columns = {} )
+{
+  Chunk chunk = makeChunk( arenaPool, uNumLines, columns.size() );
+  chunk.cursorLast = journal.getCursor();
+
+  for ( size_t i = 0; i < uNumLines; ++i )
+  {
+    const SdLine line = journal.getLine();
+    if ( stopAt && line.seqid() == *stopAt )
+    {
+      chunk.contiguityBeginning = Contiguity::CONTIGUOUS;
+      if ( i > 0 && journal.next() )
+      {
+        chunk.cursorFirst = journal.getCursor();
+      }
+      break;
+    }
+
+    appendEntry( journal, chunk, line, columns );
+
+    const bool bLastLine = i + 1 == uNumLines;
+    if ( bLastLine )
+    {
+      chunk.cursorFirst = journal.getCursor();
+    }
+
+    if ( !journal.previous() )
+    {
+      if ( !bLastLine )
+      {
+        chunk.cursorFirst = journal.getCursor();
+      }
+      chunk.isFirstInJournal = !journalStoppedEarly( journal );
+      break;
+    }
+  }
+
+  chunk.reverse();
+  return chunk;
+}
+
+}// namespace jess
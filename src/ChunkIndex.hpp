@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Chunk.hpp"
+#include "SdSeqid.hpp"
+#include "SeqnumIdTable.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+namespace jess
+{
+
+/// maps the seqnum ranges of the cached chunks to the chunks
+///
+/// every chunk contributes one interval per seqnum id it contains. Cached chunks never overlap, so the intervals of one
+/// seqnum id do not overlap either and the interval containing a seqid is found with a single binary search. The
+/// intervals are kept in a sorted array, which is far cheaper to search than a tree; inserting and erasing move at most
+/// a few thousand intervals.
+template<typename TChunkIterator>
+class ChunkIndex
+{
+  struct Interval {
+    // index of the seqnum id in SeqnumIdTable::global()
+    uint32_t seqnumId;
+    SdSeqnum first;
+    SdSeqnum last;
+    TChunkIterator pChunk;
+  };
+
+  // sorted by the seqnum id and the first seqnum of the interval
+  std::vector<Interval> m_intervals{};
+
+  /// index of the first interval starting after the seqnum
+  [[nodiscard]] size_t upperBound( const uint32_t seqnumId, const SdSeqnum seqnum ) const
+  {
+    const auto it = std::upper_bound( m_intervals.begin(), m_intervals.end(), std::tuple{ seqnumId, seqnum }, []( const auto& key, const Interval& interval ) {
+      return key < std::tuple{ interval.seqnumId, interval.first };
+    } );
+    return static_cast<size_t>( it - m_intervals.begin() );
+  }
+
+  /// index of the interval starting at the first seqnum of the range, nothing if there is none
+  [[nodiscard]] std::optional<size_t> findStart( const SeqnumRange& range ) const
+  {
+    const size_t uIndex = upperBound( range.seqnumId, range.lowest );
+    if ( uIndex == 0 || m_intervals[uIndex - 1].seqnumId != range.seqnumId || m_intervals[uIndex - 1].first != range.lowest )
+    {
+      return std::nullopt;
+    }
+    return uIndex - 1;
+  }
+
+public:
+  void insert( const TChunkIterator pChunk )
+  {
+    for ( const SeqnumRange& range : pChunk->seqnumRanges )
+    {
+      const Interval interval{ range.seqnumId, range.lowest, range.highest, pChunk };
+      if ( const auto uIndex = findStart( range ) )
+      {
+        m_intervals[*uIndex] = interval;
+      }
+      else
+      {
+        m_intervals.insert( m_intervals.begin() + static_cast<std::ptrdiff_t>( upperBound( range.seqnumId, range.lowest ) ), interval );
+      }
+    }
+  }
+
+  void erase( const TChunkIterator pChunk )
+  {
+    for ( const SeqnumRange& range : pChunk->seqnumRanges )
+    {
+      if ( const auto uIndex = findStart( range ); uIndex && m_intervals[*uIndex].pChunk == pChunk )
+      {
+        m_intervals.erase( m_intervals.begin() + static_cast<std::ptrdiff_t>( *uIndex ) );
+      }
+    }
+  }
+
+  void clear() { m_intervals.clear(); }
+
+  [[nodiscard]] size_t size() const { return m_intervals.size(); }
+
+  /// returns the chunk containing the seqid
+  [[nodiscard]] std::optional<TChunkIterator> find( const SdSeqid seqid ) const
+  {
+    const auto seqnumId = SeqnumIdTable::global().find( seqid.seqnumId );
+    if ( !seqnumId )
+    {
+      return std::nullopt;
+    }
+    const size_t uIndex = upperBound( *seqnumId, seqid.seqnum );
+    if ( uIndex == 0 || m_intervals[uIndex - 1].seqnumId != *seqnumId || seqid.seqnum > m_intervals[uIndex - 1].last )
+    {
+      return std::nullopt;
+    }
+    return m_intervals[uIndex - 1].pChunk;
+  }
+
+  /// returns the first chunk with lines of the same seqnum id after the seqid
+  [[nodiscard]] std::optional<TChunkIterator> findNext( const SdSeqid seqid ) const
+  {
+    const auto seqnumId = SeqnumIdTable::global().find( seqid.seqnumId );
+    if ( !seqnumId )
+    {
+      return std::nullopt;
+    }
+    const size_t uIndex = upperBound( *seqnumId, seqid.seqnum );
+    if ( uIndex == m_intervals.size() || m_intervals[uIndex].seqnumId != *seqnumId )
+    {
+      return std::nullopt;
+    }
+    return m_intervals[uIndex].pChunk;
+  }
+};
+
+}// namespace jess
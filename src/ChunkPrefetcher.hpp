@@ -0,0 +1,231 @@
+#pragma once
+
+#include "CSeekableStream.hpp"
+#include "Chunk.hpp"
+#include "SdCursor.hpp"
+#include "Stats.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace jess
+{
+
+struct PrefetchRequest {
+  // boundary line of the cached chunk the new chunk shall be adjacent to
+  SdCursor anchor;
+  // AFTER_CURRENT loads the lines after the anchor, BEFORE_CURRENT the lines before it
+  Adjacency adjacency;
+  // boundary line of the next cached chunk in load direction, loading stops there
+  std::optional<SdSeqid> stopAt;
+
+  // a request with another stopAt is not a duplicate: its result would be discarded as not fitting the cache, see
+  // ChunkedJournal::integratePrefetched()
+  bool operator==( const PrefetchRequest& other ) const
+  {
+    return anchor.seqid == other.anchor.seqid && adjacency == other.adjacency && stopAt == other.stopAt;
+  }
+};
+
+struct PrefetchResult {
+  PrefetchRequest request;
+  // empty if there is no line beyond the anchor or the anchor is directly followed by stopAt
+  Chunk chunk;
+  // set if the chunk is empty because the journal stopped early, see journalStoppedEarly(); the anchor is not at the
+  // boundary of the journal then
+  bool stoppedEarly{};
+};
+
+/// loads chunks adjacent to already cached chunks on a worker thread with its own journal handle
+///
+/// the worker never touches the cache itself, finished chunks are collected with takeResults(). An exception thrown by
+/// the worker, e.g. because the journal could not be opened, ends it and is rethrown by takeResults() and waitFor().
+template<SeekableStream TJournal>
+class ChunkPrefetcher
+{
+  size_t m_uChunkSize;
+  ChunkArenaPool& m_arenaPool;
+  CacheStats& m_stats;
+  std::function<TJournal()> m_openJournal;
+  std::function<void( TJournal& )> m_configureJournal;
+  std::vector<std::string> m_columns;
+  std::mutex m_mutex{};
+  std::condition_variable_any m_cv{};
+  std::deque<PrefetchRequest> m_requests{};
+  std::optional<PrefetchRequest> m_inFlight{};
+  std::vector<PrefetchResult> m_results{};
+  std::exception_ptr m_pError{};
+  std::jthread m_worker;
+
+public:
+  /// the worker opens its journal with openJournal and applies configureJournal to it before loading, e.g. to add the
+  /// matches of a filter. The chunks are read with the given columns and accounted for in stats.
+  ChunkPrefetcher( const size_t uChunkSize, ChunkArenaPool& arenaPool, CacheStats& stats, std::function<TJournal()> openJournal,
+    std::function<void( TJournal& )> configureJournal = {}, std::vector<std::string> columns = {} )
+    : m_uChunkSize( uChunkSize )
+    , m_arenaPool( arenaPool )
+    , m_stats( stats )
+    , m_openJournal( std::move( openJournal ) )
+    , m_configureJournal( std::move( configureJournal ) )
+    , m_columns( std::move( columns ) )
+    , m_worker( [this]( const std::stop_token& stopToken ) { run( stopToken ); } )
+  {
+  }
+
+  ChunkPrefetcher( const ChunkPrefetcher& ) = delete;
+  ChunkPrefetcher& operator=( const ChunkPrefetcher& ) = delete;
+
+  ~ChunkPrefetcher()
+  {
+    m_worker.request_stop();
+    m_cv.notify_all();
+  }
+
+  /// enqueues a request unless an identical one is already queued, being loaded or waiting to be collected
+  void request( const PrefetchRequest& request )
+  {
+    {
+      std::scoped_lock lock{ m_mutex };
+      if ( m_pError || isKnown( request ) )
+      {
+        return;
+      }
+      m_requests.push_back( request );
+    }
+    m_cv.notify_all();
+  }
+
+  /// blocks until the given request is no longer queued or being loaded
+  ///
+  /// returns false if the request was unknown, i.e. there is nothing to wait for
+  bool waitFor( const PrefetchRequest& request )
+  {
+    std::unique_lock lock{ m_mutex };
+    rethrowError();
+    if ( !isPending( request ) )
+    {
+      return false;
+    }
+    m_cv.wait( lock, [&] { return !isPending( request ); } );
+    rethrowError();
+    return true;
+  }
+
+  /// blocks until all requests have been processed
+  void waitIdle()
+  {
+    std::unique_lock lock{ m_mutex };
+    m_cv.wait( lock, [&] { return m_requests.empty() && !m_inFlight; } );
+  }
+
+  [[nodiscard]] std::vector<PrefetchResult> takeResults()
+  {
+    std::scoped_lock lock{ m_mutex };
+    rethrowError();
+    return std::exchange( m_results, {} );
+  }
+
+private:
+  /// m_mutex must be held
+  void rethrowError() const
+  {
+    if ( m_pError )
+    {
+      std::rethrow_exception( m_pError );
+    }
+  }
+
+  bool isPending( const PrefetchRequest& request ) const
+  {
+    return m_inFlight == request || std::find( m_requests.begin(), m_requests.end(), request ) != m_requests.end();
+  }
+
+  bool isKnown( const PrefetchRequest& request ) const
+  {
+    return isPending( request ) ||
+      std::find_if( m_results.begin(), m_results.end(), [&]( const PrefetchResult& result ) { return result.request == request; } ) != m_results.end();
+  }
+
+  void run( const std::stop_token& stopToken )
+  {
+    try
+    {
+      prefetch( stopToken );
+    }
+    catch ( ... )
+    {
+      // the requests left would never be loaded, nobody must wait for them
+      std::scoped_lock lock{ m_mutex };
+      m_pError = std::current_exception();
+      m_requests.clear();
+      m_inFlight.reset();
+    }
+    m_cv.notify_all();
+  }
+
+  void prefetch( const std::stop_token& stopToken )
+  {
+    // the journal is opened on the worker thread, the handle must never be shared with the ui thread
+    TJournal journal = m_openJournal();
+    if ( m_configureJournal )
+    {
+      m_configureJournal( journal );
+    }
+
+    while ( !stopToken.stop_requested() )
+    {
+      PrefetchRequest request{};
+      {
+        std::unique_lock lock{ m_mutex };
+        if ( !m_cv.wait( lock, stopToken, [&] { return !m_requests.empty(); } ) )
+        {
+          return;
+        }
+        request = m_requests.front();
+        m_requests.pop_front();
+        m_inFlight = request;
+      }
+
+      const auto start = std::chrono::steady_clock::now();
+      PrefetchResult result{ request, load( journal, request ) };
+      result.stoppedEarly = result.chunk.empty() && journalStoppedEarly( journal );
+      if ( !result.chunk.empty() )
+      {
+        m_stats.recordChunkBuilt( result.chunk.size(), std::chrono::steady_clock::now() - start );
+        m_stats.chunksPrefetched.fetch_add( 1, std::memory_order_relaxed );
+      }
+
+      {
+        std::scoped_lock lock{ m_mutex };
+        m_results.push_back( std::move( result ) );
+        m_inFlight.reset();
+      }
+      m_cv.notify_all();
+    }
+  }
+
+  Chunk load( TJournal& journal, const PrefetchRequest& request )
+  {
+    if ( !seekBeyondCursor( journal, request.anchor, request.adjacency ) )
+    {
+      return {};
+    }
+
+    if ( request.adjacency == Adjacency::AFTER_CURRENT )
+    {
+      return readChunkForward( journal, m_arenaPool, m_uChunkSize, request.stopAt, m_columns );
+    }
+    return readChunkBackward( journal, m_arenaPool, m_uChunkSize, request.stopAt, m_columns );
+  }
+};
+
+}// namespace jess
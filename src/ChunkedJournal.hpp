@@ -1,36 +1,51 @@
 #pragma once
 
 #include "CSeekableStream.hpp"
+#include "Chunk.hpp"
+#include "ChunkIndex.hpp"
+#include "ChunkPrefetcher.hpp"
 #include "SdCursor.hpp"
 #include "SdJournal.hpp"
 #include "SdLine.hpp"
+#include "Stats.hpp"
 
+#include <array>
 #include <cassert>
+#include <chrono>
+#include <concepts>
+#include <functional>
 #include <list>
-#include <span>
+#include <memory>
+#include <optional>
+#include <string>
+#include <stop_token>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace jess
 {
 
-enum class Adjacency {
-  NON_ADJACENT,
-  AFTER_CURRENT,
-  BEFORE_CURRENT,
+/// upper bounds of the chunk cache, 0 means unlimited
+///
+/// the current chunk and its neighbours are never evicted, so the cache may exceed a budget smaller than three chunks
+struct ChunkCacheBudget {
+  size_t maxBytes{};
+  size_t maxChunks{};
 };
 
-enum class Contiguity {
-  CONTIGUOUS,
-  NON_CONTIGUOUS,
-  OVERLAPPING,
+/// a line of the journal, along with the first line of the chunk it was cached in
+struct JournalPosition {
+  SdCursor line;
+  SdCursor chunkStart;
 };
 
-struct Chunk {
-  std::map<SdSeqnumId, SdSeqnum> lowestIdsInChunk{};
-  std::map<SdSeqnumId, SdSeqnum> highestIdsInChunk{};
-  std::vector<SdLine> lines;
-  Contiguity contiguityBeginning{ Contiguity::NON_CONTIGUOUS };
-  Contiguity contiguityEnd{ Contiguity::NON_CONTIGUOUS };
+enum class SearchResult {
+  FOUND,
+  NOT_FOUND,
+  // the search loaded too many lines, it continues from the current position when searching again
+  INTERRUPTED,
 };
 
 template<SeekableStream TJournal>
@@ -38,88 +53,189 @@ class ChunkedJournal
 {
   size_t m_uChunkSize;
   size_t m_uPreloadLines;
-  TJournal m_journal{};
+  // opens a journal handle, the prefetcher opens its own one with it
+  std::function<TJournal()> m_openJournal;
+  TJournal m_journal;
   std::list<Chunk> m_chunks{};
   decltype( m_chunks.begin() ) m_pCurrentChunk{ m_chunks.begin() };
   size_t m_uLineOffsetInChunk{ 0 };
+  Adjacency m_lastDirection{ Adjacency::AFTER_CURRENT };
+  ChunkCacheBudget m_budget;
+  size_t m_uCachedBytes{ 0 };
+  uint64_t m_uUseCounter{ 0 };
+  ChunkIndex<decltype( m_chunks.begin() )> m_index{};
+  // shared with the prefetcher, so they must outlive it
+  ChunkArenaPool m_arenaPool{};
+  CacheStats m_stats{};
+  // applied to every journal handle, see reconfigure()
+  std::function<void( TJournal& )> m_configureJournal{};
+  // fields read into the chunks along with the messages, see setColumns()
+  std::vector<std::string> m_columns{};
+  std::unique_ptr<ChunkPrefetcher<TJournal>> m_pPrefetcher{};
 
 public:
-  explicit ChunkedJournal( const size_t uChunkSize, const size_t uPreloadLines )
+  /// uPreloadLines: neighbouring chunks are loaded in the background as soon as the current position is at most this
+  /// many lines away from the respective chunk boundary; 0 disables background loading
+  /// openJournal: opens the journal handles, e.g. with a JournalScope; a default constructed TJournal by default
+  /// configure, columns: the initial configuration, see reconfigure() and setColumns(); passing them here rather than
+  /// setting them afterwards starts the prefetcher only once
+  explicit ChunkedJournal( const size_t uChunkSize, const size_t uPreloadLines, const ChunkCacheBudget budget = {},
+    std::function<TJournal()> openJournal = [] { return TJournal{}; }, std::function<void( TJournal& )> configure = {},
+    std::vector<std::string> columns = {} )
     : m_uChunkSize( uChunkSize )
     , m_uPreloadLines( uPreloadLines )
+    , m_openJournal( std::move( openJournal ) )
+    , m_journal( m_openJournal() )
+    , m_budget( budget )
+    , m_configureJournal( std::move( configure ) )
+    , m_columns( std::move( columns ) )
   {
+    if ( m_configureJournal )
+    {
+      m_configureJournal( m_journal );
+    }
+    startPrefetcher();
   }
 
   const auto& getChunks() const { return m_chunks; }
 
+  /// the journal used for loading on the calling thread, e.g. to wait for changes of the journal
+  TJournal& journal() { return m_journal; }
+
+  [[nodiscard]] size_t getCachedBytes() const { return m_uCachedBytes; }
+
+  [[nodiscard]] size_t getNumChunks() const { return m_chunks.size(); }
+
+  [[nodiscard]] const CacheStats& stats() const { return m_stats; }
+
+  /// applies configure to the journal handles, e.g. to change their matches, and drops the whole cache
+  ///
+  /// background loads in progress are cancelled. There is no current line until the next seekToBof() or seekToEof().
+  void reconfigure( std::function<void( TJournal& )> configure )
+  {
+    // the worker has to be stopped first, it must not load with the old configuration into the new cache
+    m_pPrefetcher.reset();
+    m_configureJournal = std::move( configure );
+    m_configureJournal( m_journal );
+    clear();
+  }
+
+  [[nodiscard]] const std::vector<std::string>& columns() const { return m_columns; }
+
+  /// sets the fields stored along with the messages, see SdLine::field(); the other fields are never read
+  ///
+  /// the cache is dropped like by reconfigure()
+  void setColumns( std::vector<std::string> columns )
+  {
+    m_pPrefetcher.reset();
+    m_columns = std::move( columns );
+    clear();
+  }
+
+  /// blocks until all background loads have finished and adds their chunks to the cache
+  void waitForPrefetch()
+  {
+    if ( m_pPrefetcher )
+    {
+      m_pPrefetcher->waitIdle();
+      integratePrefetched();
+    }
+  }
+
 private:
-  decltype( m_pCurrentChunk ) findChunkInsertionPosition( const Chunk& chunk )
+  void startPrefetcher()
   {
-    const auto firstId = chunk.lines.front().seqid();
-    auto lastValidId = m_chunks.begin();
-    for ( auto it = m_chunks.begin(); it != m_chunks.end(); ++it )
+    if ( m_uPreloadLines > 0 )
     {
-      if ( auto seq = it->highestIdsInChunk.find( firstId.seqnumId ); seq != it->highestIdsInChunk.end() )
-      {
-        if ( firstId.seqnum > seq->second )
-        {
-          lastValidId = it;
-        }
-        else
-        {
-          return lastValidId;
-        }
-      }
+      m_pPrefetcher = std::make_unique<ChunkPrefetcher<TJournal>>( m_uChunkSize, m_arenaPool, m_stats, m_openJournal, m_configureJournal, m_columns );
     }
-    return m_chunks.end();
   }
 
-  auto createChunkAtCurrentPosition( const Adjacency adjacency ) -> decltype( m_chunks.begin() )
+  /// drops all chunks and restarts the stopped prefetcher
+  void clear()
   {
-    Chunk newChunk{ {}, {}, {} };
+    for ( Chunk& chunk : m_chunks )
+    {
+      m_arenaPool.release( std::move( chunk.arena ) );
+    }
+    m_index = {};
+    m_chunks.clear();
+    m_pCurrentChunk = m_chunks.end();
+    m_uLineOffsetInChunk = 0;
+    m_uCachedBytes = 0;
 
-    newChunk.lines.reserve( m_uChunkSize );
+    startPrefetcher();
+  }
 
-    for ( size_t i = 0; i < m_uChunkSize; ++i )
-    {
-      newChunk.lines.push_back( m_journal.getLine() );
-      const SdSeqnumId key = newChunk.lines.back().seqid().seqnumId;
-      const SdSeqnum value = newChunk.lines.back().seqid().seqnum;
+  /// returns the cached chunk a new chunk starting at the seqid has to be inserted before
+  decltype( m_pCurrentChunk ) findChunkInsertionPosition( const SdSeqid firstSeqid )
+  {
+    return m_index.findNext( firstSeqid ).value_or( m_chunks.end() );
+  }
 
-      // if we have not seen the seqnumid before, add the first seqnum we encountered
-      if ( !newChunk.lowestIdsInChunk.contains( key ) )
-      {
-        newChunk.lowestIdsInChunk[key] = value;
-        newChunk.highestIdsInChunk[key] = value;
-      }
+  /// reads a chunk with read and accounts for it in the statistics
+  template<typename TRead>
+  Chunk buildChunk( TRead&& read )
+  {
+    const auto start = std::chrono::steady_clock::now();
+    Chunk chunk = read();
+    m_stats.recordChunkBuilt( chunk.size(), std::chrono::steady_clock::now() - start );
+    return chunk;
+  }
 
-      // if we know the seqnumid already, update the last known seqnum
-      if ( newChunk.highestIdsInChunk.contains( key ) )
+  /// reads a new chunk at the current journal position and inserts it into the cache
+  ///
+  /// adjacent chunks are read towards pReference's neighbour, non-adjacent chunks in the given direction
+  auto createChunkAtCurrentPosition( const Adjacency adjacency, const decltype( m_chunks.begin() ) pReference, const bool bBackward )
+    -> decltype( m_chunks.begin() )
+  {
+    if ( adjacency == Adjacency::NON_ADJACENT )
+    {
+      // read up to the neighbouring cached chunk at most, so that cached chunks never overlap
+      const auto insertIt = findChunkInsertionPosition( m_journal.getSeqid() );
+      if ( bBackward )
       {
-        newChunk.highestIdsInChunk[key] = value;
-      }
-
-      if ( !m_journal.next() )
-      {
-        break;
+        const auto stopAt = insertIt != m_chunks.begin() ? std::optional{ std::prev( insertIt )->lastSeqid() } : std::nullopt;
+        return insertChunk( buildChunk( [&] { return readChunkBackward( m_journal, m_arenaPool, m_uChunkSize, stopAt, m_columns ); } ), adjacency,
+          insertIt );
       }
+      const auto stopAt = insertIt != m_chunks.end() ? std::optional{ insertIt->firstSeqid() } : std::nullopt;
+      return insertChunk( buildChunk( [&] { return readChunkForward( m_journal, m_arenaPool, m_uChunkSize, stopAt, m_columns ); } ), adjacency, insertIt );
     }
 
+    const auto stopAt = getNeighbourBoundary( pReference, adjacency );
+    Chunk newChunk = buildChunk( [&] {
+      return adjacency == Adjacency::AFTER_CURRENT ? readChunkForward( m_journal, m_arenaPool, m_uChunkSize, stopAt, m_columns )
+                                                   : readChunkBackward( m_journal, m_arenaPool, m_uChunkSize, stopAt, m_columns );
+    } );
+    return insertChunk( std::move( newChunk ), adjacency, pReference );
+  }
+
+  /// inserts the chunk into the cache next to pReference and links the contiguity of both chunks
+  ///
+  /// NON_ADJACENT chunks are inserted right before pReference. If the new chunk has been read up to the next cached
+  /// chunk (see appendChunkForward()), the far side is linked as well.
+  auto insertChunk( Chunk&& newChunk, const Adjacency adjacency, const decltype( m_chunks.begin() ) pReference ) -> decltype( m_chunks.begin() )
+  {
     decltype( m_pCurrentChunk ) insertIt;
 
     switch ( adjacency )
     {
       case Adjacency::NON_ADJACENT: {
-        insertIt = findChunkInsertionPosition( newChunk );
+        insertIt = pReference;
         break;
       }
       case Adjacency::BEFORE_CURRENT: {
-        insertIt = m_pCurrentChunk;
+        assert( pReference != m_chunks.end() );
+        insertIt = pReference;
+        newChunk.contiguityEnd = Contiguity::CONTIGUOUS;
         break;
       }
       case Adjacency::AFTER_CURRENT: {
-        insertIt = m_pCurrentChunk;
+        assert( pReference != m_chunks.end() );
+        insertIt = pReference;
         std::advance( insertIt, 1 );
+        newChunk.contiguityBeginning = Contiguity::CONTIGUOUS;
         break;
       }
       default: {
@@ -128,117 +244,768 @@ private:
     }
 
     auto newChunkIt = m_chunks.insert( insertIt, std::move( newChunk ) );
+    newChunkIt->sizeInBytes = newChunkIt->computeSizeInBytes();
+    newChunkIt->lastUsed = ++m_uUseCounter;
+    m_uCachedBytes += newChunkIt->sizeInBytes;
+    m_index.insert( newChunkIt );
 
-    if ( adjacency == Adjacency::BEFORE_CURRENT )
+    if ( newChunkIt->contiguityBeginning == Contiguity::CONTIGUOUS )
     {
-      assert( m_pCurrentChunk != m_chunks.end() );
-      newChunkIt->contiguityEnd = Contiguity::CONTIGUOUS;
-      m_pCurrentChunk->contiguityBeginning = Contiguity::CONTIGUOUS;
+      assert( newChunkIt != m_chunks.begin() );
+      std::prev( newChunkIt )->contiguityEnd = Contiguity::CONTIGUOUS;
     }
-    else if ( adjacency == Adjacency::AFTER_CURRENT )
+    if ( newChunkIt->contiguityEnd == Contiguity::CONTIGUOUS )
     {
-      assert( m_pCurrentChunk != m_chunks.end() );
-      m_pCurrentChunk->contiguityEnd = Contiguity::CONTIGUOUS;
-      newChunkIt->contiguityBeginning = Contiguity::CONTIGUOUS;
+      assert( std::next( newChunkIt ) != m_chunks.end() );
+      std::next( newChunkIt )->contiguityBeginning = Contiguity::CONTIGUOUS;
     }
 
     return newChunkIt;
   }
 
-  [[nodiscard]] std::vector<decltype( m_chunks.begin() )> getChunksBySeqid( SdSeqid seqid )
+  /// returns the boundary line of the cached chunk following pChunk in the given direction
+  std::optional<SdSeqid> getNeighbourBoundary( const decltype( m_chunks.begin() ) pChunk, const Adjacency adjacency ) const
+  {
+    if ( adjacency == Adjacency::AFTER_CURRENT && std::next( pChunk ) != m_chunks.end() )
+    {
+      return std::next( pChunk )->firstSeqid();
+    }
+    if ( adjacency == Adjacency::BEFORE_CURRENT && pChunk != m_chunks.begin() )
+    {
+      return std::prev( pChunk )->lastSeqid();
+    }
+    return std::nullopt;
+  }
+
+  static bool isContiguous( const Chunk& chunk, const Adjacency adjacency )
+  {
+    const Contiguity contiguity = adjacency == Adjacency::AFTER_CURRENT ? chunk.contiguityEnd : chunk.contiguityBeginning;
+    return contiguity == Contiguity::CONTIGUOUS;
+  }
+
+  [[nodiscard]] std::optional<decltype( m_chunks.begin() )> getChunkBySeqid( const SdSeqid seqid ) const { return m_index.find( seqid ); }
+
+  /// returns the chunk containing the current journal entry, loading it if necessary, and the index of the entry in it
+  ///
+  /// pReference is the chunk the current entry is adjacent to, see createChunkAtCurrentPosition()
+  auto loadChunkAtCurrentPosition( const Adjacency adjacency, const decltype( m_chunks.begin() ) pReference, const bool bBackward = false )
+    -> std::pair<decltype( m_chunks.begin() ), size_t>
+  {
+    const auto seqid = m_journal.getSeqid();
+    if ( const auto pChunk = getChunkBySeqid( seqid ) )
+    {
+      m_stats.cacheHits.fetch_add( 1, std::memory_order_relaxed );
+      const size_t uIndex = ( *pChunk )->indexOf( seqid ).value_or( 0 );
+
+      // we stepped over the boundary of the reference chunk right into a cached chunk
+      if ( adjacency == Adjacency::AFTER_CURRENT && uIndex == 0 && std::next( pReference ) == *pChunk )
+      {
+        pReference->contiguityEnd = Contiguity::CONTIGUOUS;
+        ( *pChunk )->contiguityBeginning = Contiguity::CONTIGUOUS;
+      }
+      if ( adjacency == Adjacency::BEFORE_CURRENT && uIndex + 1 == ( *pChunk )->size() && pReference != m_chunks.begin() && std::prev( pReference ) == *pChunk )
+      {
+        pReference->contiguityBeginning = Contiguity::CONTIGUOUS;
+        ( *pChunk )->contiguityEnd = Contiguity::CONTIGUOUS;
+      }
+      return { *pChunk, uIndex };
+    }
+
+    m_stats.cacheMisses.fetch_add( 1, std::memory_order_relaxed );
+    const auto pChunk = createChunkAtCurrentPosition( adjacency, pReference, bBackward );
+    const bool bEndsAtCurrentEntry = adjacency == Adjacency::BEFORE_CURRENT || ( adjacency == Adjacency::NON_ADJACENT && bBackward );
+    return { pChunk, bEndsAtCurrentEntry ? pChunk->size() - 1 : 0 };
+  }
+
+  /// returns the chunk adjacent to pChunk, loading it if necessary, or nothing at the beginning / end of the journal
+  ///
+  /// a background load of exactly that chunk that is still in progress is waited for, as this is never slower than
+  /// loading the chunk again
+  auto getAdjacentChunk( const decltype( m_chunks.begin() ) pChunk, const Adjacency adjacency ) -> std::optional<decltype( m_chunks.begin() )>
+  {
+    const bool bAfter = adjacency == Adjacency::AFTER_CURRENT;
+
+    if ( !isContiguous( *pChunk, adjacency ) && m_pPrefetcher && m_pPrefetcher->waitFor( makePrefetchRequest( pChunk, adjacency ) ) )
+    {
+      integratePrefetched();
+    }
+
+    if ( isContiguous( *pChunk, adjacency ) )
+    {
+      return bAfter ? std::next( pChunk ) : std::prev( pChunk );
+    }
+
+    if ( !seekJournalBeyond( pChunk, adjacency ) )
+    {
+      // a journal that stopped early is tried again next time
+      ( bAfter ? pChunk->isLastInJournal : pChunk->isFirstInJournal ) = !journalStoppedEarly( m_journal );
+      return std::nullopt;
+    }
+
+    return loadChunkAtCurrentPosition( adjacency, pChunk ).first;
+  }
+
+  PrefetchRequest makePrefetchRequest( const decltype( m_chunks.begin() ) pChunk, const Adjacency adjacency ) const
+  {
+    const SdCursor& anchor = adjacency == Adjacency::AFTER_CURRENT ? pChunk->cursorLast : pChunk->cursorFirst;
+    return PrefetchRequest{ anchor, adjacency, getNeighbourBoundary( pChunk, adjacency ) };
+  }
+
+  /// bookkeeping after the current position has changed
+  void finishNavigation( const Adjacency direction )
+  {
+    m_lastDirection = direction;
+    m_pCurrentChunk->lastUsed = ++m_uUseCounter;
+    evictChunks();
+    schedulePrefetch();
+  }
+
+  [[nodiscard]] bool isOverBudget() const
   {
-    std::vector<decltype( m_chunks.begin() )> ret{};
-    for ( auto chunkIt = m_chunks.begin(); chunkIt != m_chunks.end(); ++chunkIt )
+    return ( m_budget.maxBytes > 0 && m_uCachedBytes > m_budget.maxBytes ) || ( m_budget.maxChunks > 0 && m_chunks.size() > m_budget.maxChunks );
+  }
+
+  /// evicts the least recently used chunks until the cache fits into the budget
+  ///
+  /// pKeep is protected in addition to the current chunk and its neighbours
+  void evictChunks( const std::optional<decltype( m_chunks.begin() )> pKeep = std::nullopt )
+  {
+    while ( isOverBudget() )
     {
-      if ( auto highestIt = chunkIt->highestIdsInChunk.find( seqid.seqnumId );
-           highestIt != chunkIt->highestIdsInChunk.end() && seqid.seqnum <= highestIt->second )
+      // there is no current chunk if the journal turned out empty on seeking, the cached chunks are kept then
+      const bool bHasCurrent = m_pCurrentChunk != m_chunks.end();
+      const auto isProtected = [&]( const decltype( m_chunks.begin() ) pChunk ) {
+        return pChunk == pKeep ||
+          ( bHasCurrent && ( pChunk == m_pCurrentChunk || std::next( pChunk ) == m_pCurrentChunk || pChunk == std::next( m_pCurrentChunk ) ) );
+      };
+
+      auto pVictim = m_chunks.end();
+      for ( auto it = m_chunks.begin(); it != m_chunks.end(); ++it )
       {
-        if ( auto lowestIt = chunkIt->lowestIdsInChunk.find( seqid.seqnumId ); lowestIt == chunkIt->lowestIdsInChunk.end() || seqid.seqnum >= lowestIt->second )
+        if ( !isProtected( it ) && ( pVictim == m_chunks.end() || it->lastUsed < pVictim->lastUsed ) )
         {
-          ret.push_back( chunkIt );
+          pVictim = it;
         }
       }
+
+      if ( pVictim == m_chunks.end() )
+      {
+        return;
+      }
+      evictChunk( pVictim );
     }
-    return ret;
   }
 
-  void loadChunkAtCurrentPosition( const Adjacency adjacency )
+  void evictChunk( const decltype( m_chunks.begin() ) pChunk )
   {
-    const auto seqid = m_journal.getSeqid();
-    if ( auto chunks = getChunksBySeqid( seqid ); !chunks.empty() )
+    // the neighbours are no longer known to be contiguous with anything
+    if ( pChunk->contiguityBeginning == Contiguity::CONTIGUOUS )
     {
-      m_pCurrentChunk = chunks.back();
+      assert( pChunk != m_chunks.begin() );
+      std::prev( pChunk )->contiguityEnd = Contiguity::NON_CONTIGUOUS;
     }
-    else
+    if ( pChunk->contiguityEnd == Contiguity::CONTIGUOUS )
+    {
+      assert( std::next( pChunk ) != m_chunks.end() );
+      std::next( pChunk )->contiguityBeginning = Contiguity::NON_CONTIGUOUS;
+    }
+
+    m_uCachedBytes -= pChunk->sizeInBytes;
+    m_index.erase( pChunk );
+    m_arenaPool.release( std::move( pChunk->arena ) );
+    m_chunks.erase( pChunk );
+    m_stats.chunksEvicted.fetch_add( 1, std::memory_order_relaxed );
+  }
+
+  /// requests the neighbours of the current chunk which are not cached yet, starting with the scroll direction
+  void schedulePrefetch()
+  {
+    if ( !m_pPrefetcher || m_pCurrentChunk == m_chunks.end() )
+    {
+      return;
+    }
+
+    const std::array<Adjacency, 2> directions = m_lastDirection == Adjacency::BEFORE_CURRENT
+      ? std::array{ Adjacency::BEFORE_CURRENT, Adjacency::AFTER_CURRENT }
+      : std::array{ Adjacency::AFTER_CURRENT, Adjacency::BEFORE_CURRENT };
+
+    for ( const Adjacency adjacency : directions )
+    {
+      const bool bAfter = adjacency == Adjacency::AFTER_CURRENT;
+      const size_t uDistance = bAfter ? m_pCurrentChunk->size() - m_uLineOffsetInChunk : m_uLineOffsetInChunk;
+      const bool bAtJournalBoundary = bAfter ? m_pCurrentChunk->isLastInJournal : m_pCurrentChunk->isFirstInJournal;
+
+      if ( uDistance <= m_uPreloadLines && !bAtJournalBoundary && !isContiguous( *m_pCurrentChunk, adjacency ) )
+      {
+        m_pPrefetcher->request( makePrefetchRequest( m_pCurrentChunk, adjacency ) );
+      }
+    }
+  }
+
+  /// adds the chunks loaded in the background to the cache
+  void integratePrefetched()
+  {
+    if ( !m_pPrefetcher )
+    {
+      return;
+    }
+
+    for ( PrefetchResult& result : m_pPrefetcher->takeResults() )
+    {
+      integratePrefetched( std::move( result ) );
+    }
+  }
+
+  void integratePrefetched( PrefetchResult&& result )
+  {
+    const PrefetchRequest& request = result.request;
+    const bool bAfter = request.adjacency == Adjacency::AFTER_CURRENT;
+    const auto discard = [&] {
+      if ( !result.chunk.empty() )
+      {
+        m_stats.prefetchesDiscarded.fetch_add( 1, std::memory_order_relaxed );
+      }
+      m_arenaPool.release( std::move( result.chunk.arena ) );
+    };
+
+    // the anchor chunk must still exist and must still end (or begin) at the anchor
+    const auto pAnchorChunk = getChunkBySeqid( request.anchor.seqid );
+    if ( !pAnchorChunk )
+    {
+      discard();
+      return;
+    }
+    const auto pAnchor = *pAnchorChunk;
+    if ( ( bAfter ? pAnchor->lastSeqid() : pAnchor->firstSeqid() ) != request.anchor.seqid || isContiguous( *pAnchor, request.adjacency ) )
+    {
+      discard();
+      return;
+    }
+
+    // a chunk has been cached next to the anchor in the meantime, the loaded lines may overlap it
+    if ( getNeighbourBoundary( pAnchor, request.adjacency ) != request.stopAt )
+    {
+      discard();
+      return;
+    }
+
+    if ( result.chunk.empty() )
+    {
+      discard();
+      if ( isContiguous( result.chunk, request.adjacency ) )
+      {
+        // the anchor is directly followed by the neighbouring chunk
+        const auto pNeighbour = bAfter ? std::next( pAnchor ) : std::prev( pAnchor );
+        ( bAfter ? pAnchor->contiguityEnd : pAnchor->contiguityBeginning ) = Contiguity::CONTIGUOUS;
+        ( bAfter ? pNeighbour->contiguityBeginning : pNeighbour->contiguityEnd ) = Contiguity::CONTIGUOUS;
+      }
+      else
+      {
+        ( bAfter ? pAnchor->isLastInJournal : pAnchor->isFirstInJournal ) = !result.stoppedEarly;
+      }
+      return;
+    }
+
+    insertChunk( std::move( result.chunk ), request.adjacency, pAnchor );
+  }
+
+  /// returns the cached line seekToTime() moves to, nothing if it may be in a part of the journal that is not cached
+  auto findCachedTime( const std::chrono::time_point<std::chrono::system_clock> realtime ) -> std::optional<std::pair<decltype( m_chunks.begin() ), size_t>>
+  {
+    // the chunks are checked one by one rather than bisected: the realtime is not monotonic across clock changes, so
+    // the time ranges of the chunks in journal order are not sorted. The default budget holds thousands of chunks,
+    // two comparisons each are still far cheaper than seeking the journal.
+    for ( auto it = m_chunks.begin(); it != m_chunks.end(); ++it )
+    {
+      if ( it->maxRealtime < realtime )
+      {
+        continue;
+      }
+      if ( it->minRealtime < realtime )
+      {
+        return std::pair{ it, std::min( it->lowerBoundRealtime( realtime ), it->size() - 1 ) };
+      }
+      // the time is before the chunk, it is only known to be its first line if nothing is missing in between
+      if ( it->contiguityBeginning == Contiguity::CONTIGUOUS || it->isFirstInJournal )
+      {
+        return std::pair{ it, size_t{ 0 } };
+      }
+      return std::nullopt;
+    }
+
+    if ( !m_chunks.empty() && m_chunks.back().isLastInJournal )
+    {
+      return std::pair{ std::prev( m_chunks.end() ), m_chunks.back().size() - 1 };
+    }
+    return std::nullopt;
+  }
+
+  /// moves to the next line after (or before) the current position that find returns, see search()
+  ///
+  /// find( chunk, uFrom ) returns the index of the first line of the chunk found at or after (at or before) uFrom in
+  /// the direction, nothing if there is none
+  template<typename TFind>
+  SearchResult findLine( const TFind& find, const Adjacency direction, const size_t uMaxLoadedLines, const std::stop_token& stopToken )
+  {
+    if ( m_pCurrentChunk == m_chunks.end() )
     {
-      m_pCurrentChunk = createChunkAtCurrentPosition( adjacency );
+      return SearchResult::NOT_FOUND;
     }
+    integratePrefetched();
+
+    const bool bForward = direction == Adjacency::AFTER_CURRENT;
+    auto pChunk = m_pCurrentChunk;
+    // the line to check next, may be one past either end of the chunk
+    auto iLine = static_cast<int64_t>( m_uLineOffsetInChunk ) + ( bForward ? 1 : -1 );
+    size_t uLoadedLines = 0;
+
+    while ( true )
+    {
+      const std::optional<size_t> uFound =
+        iLine >= 0 && iLine < static_cast<int64_t>( pChunk->size() ) ? find( std::as_const( *pChunk ), static_cast<size_t>( iLine ) ) : std::nullopt;
+      if ( uFound )
+      {
+        m_pCurrentChunk = pChunk;
+        m_uLineOffsetInChunk = *uFound;
+        finishNavigation( direction );
+        return SearchResult::FOUND;
+      }
+
+      const bool bCached = isContiguous( *pChunk, direction );
+      if ( !bCached && ( uLoadedLines >= uMaxLoadedLines || stopToken.stop_requested() ) )
+      {
+        m_pCurrentChunk = pChunk;
+        m_uLineOffsetInChunk = bForward ? pChunk->size() - 1 : 0;
+        finishNavigation( direction );
+        return SearchResult::INTERRUPTED;
+      }
+
+      const auto pNext = getAdjacentChunk( pChunk, direction );
+      if ( !pNext )
+      {
+        return SearchResult::NOT_FOUND;
+      }
+      if ( !bCached )
+      {
+        uLoadedLines += ( *pNext )->size();
+      }
+
+      // the chunks searched before may be evicted to make room, the one being searched must stay
+      pChunk = *pNext;
+      pChunk->lastUsed = ++m_uUseCounter;
+      evictChunks( pChunk );
+      iLine = bForward ? 0 : static_cast<int64_t>( pChunk->size() ) - 1;
+    }
+  }
+
+  /// positions the journal at the first entry after (or before) the chunk
+  bool seekJournalBeyond( const decltype( m_chunks.begin() ) pChunk, const Adjacency adjacency )
+  {
+    const SdCursor& anchor = adjacency == Adjacency::AFTER_CURRENT ? pChunk->cursorLast : pChunk->cursorFirst;
+    return seekBeyondCursor( m_journal, anchor, adjacency );
+  }
+
+  void moveForward( const size_t uNumLines )
+  {
+    // offset of the new position relative to the beginning of the current chunk
+    size_t uNewOffset = m_uLineOffsetInChunk + uNumLines;
+
+    while ( uNewOffset >= m_pCurrentChunk->size() )
+    {
+      uNewOffset -= m_pCurrentChunk->size();
+
+      // walking through cached chunks does not need any journal access
+      if ( uNewOffset < m_uChunkSize || isContiguous( *m_pCurrentChunk, Adjacency::AFTER_CURRENT ) )
+      {
+        if ( const auto pNext = getAdjacentChunk( m_pCurrentChunk, Adjacency::AFTER_CURRENT ) )
+        {
+          m_pCurrentChunk = *pNext;
+          continue;
+        }
+
+        // end of the journal, stay at the last line
+        uNewOffset = m_pCurrentChunk->size() - 1;
+        break;
+      }
+
+      // skip whole chunks without reading them
+      if ( !seekJournalBeyond( m_pCurrentChunk, Adjacency::AFTER_CURRENT ) )
+      {
+        uNewOffset = m_pCurrentChunk->size() - 1;
+        m_pCurrentChunk->isLastInJournal = !journalStoppedEarly( m_journal );
+        break;
+      }
+
+      const size_t uLinesToSeek = uNewOffset / m_uChunkSize * m_uChunkSize;
+      m_journal.seekLinesForward( uLinesToSeek );
+      if ( journalStoppedEarly( m_journal ) )
+      {
+        // the number of lines skipped is not known, the move ends at the line reached
+        const auto [pChunk, uIndex] = loadChunkAtCurrentPosition( Adjacency::NON_ADJACENT, m_pCurrentChunk );
+        m_pCurrentChunk = pChunk;
+        uNewOffset = uIndex;
+        break;
+      }
+      uNewOffset -= uLinesToSeek;
+
+      const auto [pChunk, uIndex] = loadChunkAtCurrentPosition( Adjacency::NON_ADJACENT, m_pCurrentChunk );
+      m_pCurrentChunk = pChunk;
+      uNewOffset += uIndex;
+    }
+
+    m_uLineOffsetInChunk = uNewOffset;
+  }
+
+  void moveBackward( const size_t uNumLines )
+  {
+    size_t uLinesLeft = uNumLines;
+
+    while ( uLinesLeft > m_uLineOffsetInChunk )
+    {
+      // continue from the last line of the previous chunk
+      uLinesLeft -= m_uLineOffsetInChunk + 1;
+
+      // walking through cached chunks does not need any journal access
+      if ( uLinesLeft < m_uChunkSize || isContiguous( *m_pCurrentChunk, Adjacency::BEFORE_CURRENT ) )
+      {
+        if ( const auto pPrevious = getAdjacentChunk( m_pCurrentChunk, Adjacency::BEFORE_CURRENT ) )
+        {
+          m_pCurrentChunk = *pPrevious;
+          m_uLineOffsetInChunk = m_pCurrentChunk->size() - 1;
+          continue;
+        }
+
+        // beginning of the journal, stay at the first line
+        uLinesLeft = 0;
+        m_uLineOffsetInChunk = 0;
+        break;
+      }
+
+      // skip whole chunks without reading them
+      if ( !seekJournalBeyond( m_pCurrentChunk, Adjacency::BEFORE_CURRENT ) )
+      {
+        uLinesLeft = 0;
+        m_uLineOffsetInChunk = 0;
+        m_pCurrentChunk->isFirstInJournal = !journalStoppedEarly( m_journal );
+        break;
+      }
+
+      const size_t uLinesToSeek = uLinesLeft / m_uChunkSize * m_uChunkSize;
+      m_journal.seekLinesBackward( uLinesToSeek );
+      if ( journalStoppedEarly( m_journal ) )
+      {
+        // the number of lines skipped is not known, the move ends at the line reached
+        const auto [pChunk, uIndex] = loadChunkAtCurrentPosition( Adjacency::NON_ADJACENT, m_pCurrentChunk, true );
+        m_pCurrentChunk = pChunk;
+        m_uLineOffsetInChunk = uIndex;
+        uLinesLeft = 0;
+        break;
+      }
+      uLinesLeft -= uLinesToSeek;
+
+      // the new chunk ends at the line we landed on, as the lines above it are the ones needed next
+      const auto [pChunk, uIndex] = loadChunkAtCurrentPosition( Adjacency::NON_ADJACENT, m_pCurrentChunk, true );
+      m_pCurrentChunk = pChunk;
+      m_uLineOffsetInChunk = uIndex;
+    }
+
+    m_uLineOffsetInChunk -= uLinesLeft;
   }
 
 public:
+  /// positions at the first line of the journal; if the journal is empty, there is no current line
   void seekToBof()
   {
+    integratePrefetched();
     m_journal.seekToBof();
-    m_journal.next();
-    loadChunkAtCurrentPosition( Adjacency::NON_ADJACENT );
-    m_uLineOffsetInChunk = 0;
+    if ( !m_journal.next() )
+    {
+      m_pCurrentChunk = m_chunks.end();
+      m_uLineOffsetInChunk = 0;
+      return;
+    }
+    std::tie( m_pCurrentChunk, m_uLineOffsetInChunk ) = loadChunkAtCurrentPosition( Adjacency::NON_ADJACENT, m_pCurrentChunk );
+    if ( m_uLineOffsetInChunk == 0 )
+    {
+      m_pCurrentChunk->isFirstInJournal = true;
+    }
+    finishNavigation( Adjacency::AFTER_CURRENT );
   }
 
+  /// positions at the last line of the journal; if the journal is empty, there is no current line
   void seekToEof()
   {
+    integratePrefetched();
     m_journal.seekToEof();
-    m_journal.seekLinesBackward( m_uChunkSize );
-    loadChunkAtCurrentPosition( Adjacency::NON_ADJACENT );
-    // bug: this will explode if there are fewer than m_uChunkSize lines in the chunk
-    m_uLineOffsetInChunk = m_uChunkSize - 1;
+    if ( !m_journal.previous() )
+    {
+      m_pCurrentChunk = m_chunks.end();
+      m_uLineOffsetInChunk = 0;
+      return;
+    }
+    std::tie( m_pCurrentChunk, m_uLineOffsetInChunk ) = loadChunkAtCurrentPosition( Adjacency::NON_ADJACENT, m_pCurrentChunk, true );
+    if ( m_uLineOffsetInChunk + 1 == m_pCurrentChunk->size() )
+    {
+      m_pCurrentChunk->isLastInJournal = true;
+    }
+    finishNavigation( Adjacency::BEFORE_CURRENT );
   }
 
   void seekLines( const int64_t uNumLines )
   {
-    assert( m_pCurrentChunk != m_chunks.end() );
-
-    if ( uNumLines < 0 && static_cast<size_t>( std::abs( uNumLines ) ) > m_uLineOffsetInChunk )
+    if ( m_pCurrentChunk == m_chunks.end() )
     {
-      m_uLineOffsetInChunk = 0;
-      // todo: load previous chunk
       return;
     }
-    if ( m_uLineOffsetInChunk + uNumLines >= m_pCurrentChunk->lines.size() )
+    integratePrefetched();
+
+    if ( uNumLines < 0 )
+    {
+      moveBackward( static_cast<size_t>( -uNumLines ) );
+      finishNavigation( Adjacency::BEFORE_CURRENT );
+    }
+    else
     {
-      const int64_t uNewOffsetRelativeToEndOfCurrentChunk = uNumLines - static_cast<int64_t>( m_pCurrentChunk->lines.size() - m_uLineOffsetInChunk );
-      const size_t uNumChunksToSkip = uNewOffsetRelativeToEndOfCurrentChunk / m_uChunkSize;
-      m_uLineOffsetInChunk = uNewOffsetRelativeToEndOfCurrentChunk - uNumChunksToSkip * m_uChunkSize;
+      moveForward( static_cast<size_t>( uNumLines ) );
+      finishNavigation( Adjacency::AFTER_CURRENT );
+    }
+  }
 
-      if ( const size_t uLinesToSeek = uNumChunksToSkip * m_uChunkSize; uLinesToSeek > 0 )
+  /// positions at the first line at or after the time, or at the last line if there is none
+  ///
+  /// the time ranges of the cached chunks are checked first, the journal is only sought if the time is not cached
+  void seekToTime( const std::chrono::time_point<std::chrono::system_clock> realtime )
+  {
+    integratePrefetched();
+    if ( const auto cached = findCachedTime( realtime ) )
+    {
+      std::tie( m_pCurrentChunk, m_uLineOffsetInChunk ) = *cached;
+    }
+    else
+    {
+      m_journal.seekToRealtime( realtime );
+      if ( !m_journal.next() )
       {
-        m_journal.seekLinesForward( uLinesToSeek );
+        seekToEof();
+        return;
       }
+      std::tie( m_pCurrentChunk, m_uLineOffsetInChunk ) = loadChunkAtCurrentPosition( Adjacency::NON_ADJACENT, m_pCurrentChunk );
+    }
+    finishNavigation( Adjacency::AFTER_CURRENT );
+  }
 
-      const Adjacency adjacency = uNumChunksToSkip == 0 ? Adjacency::AFTER_CURRENT : Adjacency::NON_ADJACENT;
-      loadChunkAtCurrentPosition( adjacency );
-      return;
+  /// returns the current position, nothing if there is no current line or the journal no longer contains it
+  ///
+  /// the cache only keeps the cursors of the chunk boundaries, the cursor of the line is looked up in the journal
+  std::optional<JournalPosition> getPosition()
+  {
+    if ( m_pCurrentChunk == m_chunks.end() )
+    {
+      return std::nullopt;
+    }
+
+    const SdCursor& chunkStart = m_pCurrentChunk->cursorFirst;
+    m_journal.seekToCursor( chunkStart.toString() );
+    if ( !m_journal.next() )
+    {
+      return std::nullopt;
+    }
+    if ( m_uLineOffsetInChunk > 0 )
+    {
+      m_journal.seekLinesForward( m_uLineOffsetInChunk );
+    }
+    if ( m_journal.getSeqid() != m_pCurrentChunk->seqid( m_uLineOffsetInChunk ) )
+    {
+      return std::nullopt;
     }
+    return JournalPosition{ m_journal.getCursor(), chunkStart };
+  }
+
+  /// positions at the line of the position, or at the closest line if the journal no longer contains it
+  ///
+  /// the chunk of the line is read from position.chunkStart on, so that it lines up with the chunk it was cached in
+  /// when the position was taken. Both are found by seeking to the cursors, which needs no scanning.
+  /// returns false if the line itself could not be found
+  bool seekToPosition( const JournalPosition& position )
+  {
+    integratePrefetched();
 
-    m_uLineOffsetInChunk += uNumLines;
+    if ( const auto pChunk = getChunkBySeqid( position.line.seqid ) )
+    {
+      m_pCurrentChunk = *pChunk;
+      m_uLineOffsetInChunk = m_pCurrentChunk->indexOf( position.line.seqid ).value_or( 0 );
+      finishNavigation( Adjacency::AFTER_CURRENT );
+      return true;
+    }
+
+    m_journal.seekToCursor( position.chunkStart.toString() );
+    if ( m_journal.next() && m_journal.getSeqid() == position.chunkStart.seqid )
+    {
+      const auto pChunk = loadChunkAtCurrentPosition( Adjacency::NON_ADJACENT, m_pCurrentChunk ).first;
+      if ( const auto uIndex = pChunk->indexOf( position.line.seqid ) )
+      {
+        m_pCurrentChunk = pChunk;
+        m_uLineOffsetInChunk = *uIndex;
+        finishNavigation( Adjacency::AFTER_CURRENT );
+        return true;
+      }
+    }
+
+    m_journal.seekToCursor( position.line.toString() );
+    if ( !m_journal.next() )
+    {
+      seekToEof();
+      return false;
+    }
+    const bool bFound = m_journal.getSeqid() == position.line.seqid;
+    std::tie( m_pCurrentChunk, m_uLineOffsetInChunk ) = loadChunkAtCurrentPosition( Adjacency::NON_ADJACENT, m_pCurrentChunk );
+    finishNavigation( Adjacency::AFTER_CURRENT );
+    return bFound;
   }
 
-  std::span<SdLine> getLines( size_t uNumLines )
+  /// returns up to uNumLines lines starting at the current position, continuing into the following chunks
+  ///
+  /// the messages refer to the arenas of the cached chunks and are valid until the cache is modified by the next call
+  std::vector<SdLine> getLines( const size_t uNumLines )
   {
+    std::vector<SdLine> ret{};
     if ( m_pCurrentChunk == m_chunks.end() )
     {
-      return {};
+      return ret;
     }
-    const std::span ret{ m_pCurrentChunk->lines };
-    return ret.subspan( m_uLineOffsetInChunk, std::min( ret.size() - m_uLineOffsetInChunk, uNumLines ) );
+
+    ret.reserve( uNumLines );
+    auto pChunk = m_pCurrentChunk;
+    size_t uOffset = m_uLineOffsetInChunk;
+
+    while ( true )
+    {
+      const size_t uCount = std::min( pChunk->size() - uOffset, uNumLines - ret.size() );
+      for ( size_t i = uOffset; i < uOffset + uCount; ++i )
+      {
+        ret.push_back( pChunk->line( i ) );
+      }
+      if ( ret.size() == uNumLines )
+      {
+        break;
+      }
+
+      const auto pNext = getAdjacentChunk( pChunk, Adjacency::AFTER_CURRENT );
+      if ( !pNext )
+      {
+        break;
+      }
+      pChunk = *pNext;
+      uOffset = 0;
+    }
+
+    return ret;
+  }
+
+  /// reads the entries added to the journal after the cached end of the journal
+  ///
+  /// the lines are appended to the last chunk until it is full, then new chunks are created. At most uMaxLines lines are
+  /// read, the remaining ones are loaded on demand like any other uncached part of the journal. Nothing is read as long
+  /// as the end of the journal has not been cached.
+  /// returns the number of lines read; if it is not 0, the lines returned by getLines() before are invalidated
+  size_t appendNewEntries( const size_t uMaxLines )
+  {
+    integratePrefetched();
+    if ( m_chunks.empty() )
+    {
+      // the journal was empty, e.g. because no entry matched its filter yet
+      seekToBof();
+      return m_chunks.empty() ? 0 : m_pCurrentChunk->size();
+    }
+    if ( !std::prev( m_chunks.end() )->isLastInJournal )
+    {
+      return 0;
+    }
+
+    auto pTail = std::prev( m_chunks.end() );
+    if ( !seekJournalBeyond( pTail, Adjacency::AFTER_CURRENT ) )
+    {
+      return 0;
+    }
+
+    size_t uRead = 0;
+    while ( uRead < uMaxLines )
+    {
+      if ( pTail->size() < m_uChunkSize )
+      {
+        // the bounds and the size of the chunk change, it is taken out of the bookkeeping while it grows
+        m_index.erase( pTail );
+        m_uCachedBytes -= pTail->sizeInBytes;
+        const size_t uAppended = appendChunkForward( m_journal, *pTail, std::min( m_uChunkSize - pTail->size(), uMaxLines - uRead ), std::nullopt, m_columns );
+        m_stats.entriesRead.fetch_add( uAppended, std::memory_order_relaxed );
+        uRead += uAppended;
+        pTail->sizeInBytes = pTail->computeSizeInBytes();
+        m_uCachedBytes += pTail->sizeInBytes;
+        m_index.insert( pTail );
+      }
+      else
+      {
+        const size_t uNumLines = std::min( m_uChunkSize, uMaxLines - uRead );
+        pTail = insertChunk( buildChunk( [&] { return readChunkForward( m_journal, m_arenaPool, uNumLines, std::nullopt, m_columns ); } ),
+          Adjacency::AFTER_CURRENT, pTail );
+        uRead += pTail->size();
+      }
+
+      if ( pTail->isLastInJournal )
+      {
+        break;
+      }
+    }
+
+    evictChunks();
+    return uRead;
+  }
+
+  /// moves to the next line after (or before) the current position whose message matches
+  ///
+  /// the cached chunks are searched first, uncached parts of the journal are loaded on the way. Once more than
+  /// uMaxLoadedLines lines have been loaded, or before loading once stop is requested through stopToken, the search is
+  /// interrupted and the position is moved to the last line searched, so that searching again continues from there.
+  /// The position does not change if there is no match.
+  template<std::predicate<std::string_view> TMatcher>
+  SearchResult search( const TMatcher& matches, const Adjacency direction, const size_t uMaxLoadedLines, const std::stop_token& stopToken = {} )
+  {
+    const bool bForward = direction == Adjacency::AFTER_CURRENT;
+    return findLine(
+      [&]( const Chunk& chunk, const size_t uFrom ) -> std::optional<size_t> {
+        for ( auto iLine = static_cast<int64_t>( uFrom ); iLine >= 0 && iLine < static_cast<int64_t>( chunk.size() ); iLine += bForward ? 1 : -1 )
+        {
+          if ( matches( chunk.message( static_cast<size_t>( iLine ) ) ) )
+          {
+            return static_cast<size_t>( iLine );
+          }
+        }
+        return std::nullopt;
+      },
+      direction, uMaxLoadedLines, stopToken );
+  }
+
+  /// moves to the next line after (or before) the current position with a priority at or below uMaxPriority, i.e. one
+  /// that is at least as severe; see search()
+  ///
+  /// only the priorities of the chunks are scanned, their messages are not touched
+  SearchResult searchPriority( const uint8_t uMaxPriority, const Adjacency direction, const size_t uMaxLoadedLines, const std::stop_token& stopToken = {} )
+  {
+    return findLine( [&]( const Chunk& chunk, const size_t uFrom ) { return chunk.findPriority( uFrom, uMaxPriority, direction ); }, direction,
+      uMaxLoadedLines, stopToken );
   }
 
   std::string getChunkPositionString()
   {
+    if ( m_pCurrentChunk == m_chunks.end() )
+    {
+      return "no entries";
+    }
     const size_t uNthChunk = std::distance( m_chunks.begin(), m_pCurrentChunk );
     const size_t uNumChunks = m_chunks.size();
 
     return "chunk " + std::to_string( uNthChunk + 1 ) + "/" + std::to_string( uNumChunks ) + "; line " + std::to_string( m_uLineOffsetInChunk + 1 ) + "/" +
-      std::to_string( m_pCurrentChunk->lines.size() );
+      std::to_string( m_pCurrentChunk->size() );
   }
 };
 
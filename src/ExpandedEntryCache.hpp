@@ -0,0 +1,69 @@
+#pragma once
+
+#include "SdSeqid.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <list>
+#include <string>
+#include <utility>
+
+namespace jess
+{
+
+/// complete messages of entries that are truncated in the chunks, see SdJournal::readFullMessage()
+///
+/// the messages are kept apart from the chunk cache with a budget of their own, so that expanding a few huge entries
+/// neither evicts chunks nor is evicted by scrolling
+class ExpandedEntryCache
+{
+  size_t m_uMaxBytes;
+  size_t m_uBytes{};
+  // most recently used first
+  std::list<std::pair<SdSeqid, std::string>> m_entries{};
+
+public:
+  explicit ExpandedEntryCache( const size_t uMaxBytes )
+    : m_uMaxBytes( uMaxBytes )
+  {
+  }
+
+  /// returns the message of the entry, nullptr if it is not cached
+  [[nodiscard]] const std::string* find( const SdSeqid seqid )
+  {
+    const auto it = std::find_if( m_entries.begin(), m_entries.end(), [seqid]( const auto& entry ) { return entry.first == seqid; } );
+    if ( it == m_entries.end() )
+    {
+      return nullptr;
+    }
+    m_entries.splice( m_entries.begin(), m_entries, it );
+    return &it->second;
+  }
+
+  /// adds the message of the entry, evicting the least recently used messages beyond the budget
+  ///
+  /// the added message is kept even if it exceeds the budget on its own
+  const std::string& insert( const SdSeqid seqid, std::string sMessage )
+  {
+    if ( const auto it = std::find_if( m_entries.begin(), m_entries.end(), [seqid]( const auto& entry ) { return entry.first == seqid; } );
+         it != m_entries.end() )
+    {
+      m_uBytes -= it->second.size();
+      m_entries.erase( it );
+    }
+
+    m_uBytes += sMessage.size();
+    m_entries.emplace_front( seqid, std::move( sMessage ) );
+    while ( m_uBytes > m_uMaxBytes && m_entries.size() > 1 )
+    {
+      m_uBytes -= m_entries.back().second.size();
+      m_entries.pop_back();
+    }
+    return m_entries.front().second;
+  }
+
+  [[nodiscard]] size_t size() const { return m_entries.size(); }
+  [[nodiscard]] size_t sizeInBytes() const { return m_uBytes; }
+};
+
+}// namespace jess
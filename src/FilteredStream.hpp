@@ -0,0 +1,303 @@
+#pragma once
+
+#include "CSeekableStream.hpp"
+#include "SdCursor.hpp"
+#include "SdLine.hpp"
+#include "SdSeqid.hpp"
+#include "SubstringSearcher.hpp"
+
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace jess
+{
+
+/// matches the lines whose message contains the needle, see SubstringSearcher
+class MessageContains
+{
+  SubstringSearcher m_searcher;
+
+public:
+  explicit MessageContains( const std::string_view sNeedle, const bool bIgnoreCase = false )
+    : m_searcher( sNeedle, bIgnoreCase )
+  {
+  }
+
+  /// an empty needle is contained in every message
+  [[nodiscard]] bool acceptsAll() const { return m_searcher.needle().empty(); }
+
+  bool operator()( const SdLine& line ) const { return m_searcher( line.message() ); }
+};
+
+/// matches the lines whose message contains a match of the ECMAScript regular expression
+class MessageMatches
+{
+  std::regex m_regex;
+
+public:
+  /// throws std::invalid_argument if the expression is invalid
+  explicit MessageMatches( const std::string& sExpression, const bool bIgnoreCase = false )
+  {
+    try
+    {
+      m_regex = std::regex{ sExpression, bIgnoreCase ? std::regex::ECMAScript | std::regex::icase : std::regex::ECMAScript };
+    }
+    catch ( const std::regex_error& ex )
+    {
+      throw std::invalid_argument{ "invalid regular expression '" + sExpression + "': " + ex.what() };
+    }
+  }
+
+  bool operator()( const SdLine& line ) const
+  {
+    const std::string_view sMessage = line.message();
+    return std::regex_search( sMessage.begin(), sMessage.end(), m_regex );
+  }
+};
+
+/// matches the lines with a priority between mostSevere and leastSevere, both included; lines without a priority
+/// never match
+struct PriorityRange {
+  uint8_t mostSevere{ 0 };
+  uint8_t leastSevere{ 7 };
+
+  bool operator()( const SdLine& line ) const { return line.priority() != SdLine::NO_PRIORITY && line.priority() >= mostSevere && line.priority() <= leastSevere; }
+};
+
+/// the entries of the journal for which the predicate holds, for filters that sd_journal_add_match() cannot express,
+/// e.g. on the content of the message
+///
+/// the stream is a SeekableStream itself, so it can be read by ChunkedJournal, whose chunks then only hold the matching
+/// lines, or be wrapped by a further FilteredStream to combine predicates.
+/// The entries in between are read and checked one by one. A step examines at most uScanBudget of them, so that a
+/// filter on a rare message cannot keep a chunk load busy for minutes: if the budget runs out, the step fails like it
+/// does at the end of the journal, and budgetExhausted() tells the two apart. The next step in the same direction from
+/// the same entry continues where the scan stopped, so that repeated attempts, e.g. reading past the end of the cache
+/// again, make progress.
+/// A predicate may declare with acceptsAll() that it holds for every line at the moment; the stream then moves like the
+/// unfiltered journal, skipping lines without reading them.
+template<SeekableStream TJournal, typename TPredicate>
+  requires std::predicate<const TPredicate&, const SdLine&>
+class FilteredStream
+{
+public:
+  static constexpr size_t DEFAULT_SCAN_BUDGET = 100'000;
+
+private:
+  /// where a step that ran out of budget stopped scanning
+  struct Resume {
+    SdSeqid from;
+    bool bForward;
+    SdCursor frontier;
+  };
+
+  TJournal m_journal{};
+  TPredicate m_predicate{};
+  size_t m_uScanBudget{ DEFAULT_SCAN_BUDGET };
+  // set while the journal is positioned at a matching entry, unset after seeking
+  bool m_bOnMatch{};
+  // the line of the matching entry as read for the predicate, returned by getLine() until a field is read or the
+  // journal moves, so that the entry is not read twice
+  std::optional<SdLine> m_line{};
+  bool m_bBudgetExhausted{};
+  std::optional<Resume> m_resume{};
+  uint64_t m_uEntriesScanned{};
+
+public:
+  FilteredStream() = default;
+
+  explicit FilteredStream( TJournal journal, TPredicate predicate = {}, const size_t uScanBudget = DEFAULT_SCAN_BUDGET )
+    : m_journal( std::move( journal ) )
+    , m_predicate( std::move( predicate ) )
+    , m_uScanBudget( uScanBudget )
+  {
+  }
+
+  /// the unfiltered journal, e.g. to add matches or to wait for changes; the filtered stream must be seeked after
+  /// moving it
+  TJournal& journal() { return m_journal; }
+
+  /// replaces the predicate, it applies from the next step on
+  void setPredicate( TPredicate predicate )
+  {
+    m_predicate = std::move( predicate );
+    m_resume.reset();
+  }
+
+  /// set if the predicate holds for every line, see MessageContains::acceptsAll()
+  [[nodiscard]] bool acceptsAll() const
+  {
+    if constexpr ( requires { { m_predicate.acceptsAll() } -> std::same_as<bool>; } )
+    {
+      return m_predicate.acceptsAll();
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  /// set if the last step failed because it ran out of budget rather than at the end of the journal
+  [[nodiscard]] bool budgetExhausted() const { return m_bBudgetExhausted; }
+
+  /// entries read from the unfiltered journal so far, matching or not
+  [[nodiscard]] uint64_t entriesScanned() const { return m_uEntriesScanned; }
+
+  void seekToBof()
+  {
+    m_journal.seekToBof();
+    leaveMatch();
+  }
+
+  void seekToEof()
+  {
+    m_journal.seekToEof();
+    leaveMatch();
+  }
+
+  /// the next step lands on the entry of the cursor if it matches, otherwise on the next match in that direction
+  void seekToCursor( const std::string& sCursor )
+  {
+    m_journal.seekToCursor( sCursor );
+    leaveMatch();
+  }
+
+  void seekToRealtime( const std::chrono::time_point<std::chrono::system_clock> realtime )
+  {
+    m_journal.seekToRealtime( realtime );
+    leaveMatch();
+  }
+
+  /// stops early at the end of the journal or if a step runs out of budget, see budgetExhausted()
+  void seekLinesForward( const size_t uNumLines )
+  {
+    if ( acceptsAll() )
+    {
+      seekUnfiltered( [&] { m_journal.seekLinesForward( uNumLines ); } );
+      return;
+    }
+    for ( size_t i = 0; i < uNumLines && next(); ++i )
+    {
+    }
+  }
+
+  void seekLinesBackward( const size_t uNumLines )
+  {
+    if ( acceptsAll() )
+    {
+      seekUnfiltered( [&] { m_journal.seekLinesBackward( uNumLines ); } );
+      return;
+    }
+    for ( size_t i = 0; i < uNumLines && previous(); ++i )
+    {
+    }
+  }
+
+  bool next() { return step( true ); }
+
+  bool previous() { return step( false ); }
+
+  SdLine getLine() { return m_line ? *m_line : m_journal.getLine(); }
+
+  [[nodiscard]] SdSeqid getSeqid() const { return m_journal.getSeqid(); }
+
+  /// may invalidate the line, like reading a field of the unfiltered journal
+  std::string_view getFieldString( const std::string_view sFieldName )
+  {
+    m_line.reset();
+    return m_journal.getFieldString( sFieldName );
+  }
+
+  [[nodiscard]] SdCursor getCursor() { return m_journal.getCursor(); }
+
+private:
+  void leaveMatch()
+  {
+    m_bOnMatch = false;
+    m_line.reset();
+  }
+
+  /// moves the unfiltered journal while every line matches; a journal at an entry stays at one, even if it cannot move
+  template<typename TSeek>
+  void seekUnfiltered( const TSeek& seek )
+  {
+    m_bBudgetExhausted = false;
+    m_line.reset();
+    seek();
+  }
+
+  /// moves to the next matching entry in the direction
+  ///
+  /// a failed step keeps the journal at the matching entry it started from, like a failed step of sd_journal keeps it
+  /// at the current entry
+  bool step( const bool bForward )
+  {
+    const auto move = [this]( const bool bDirection ) { return bDirection ? m_journal.next() : m_journal.previous(); };
+    if ( acceptsAll() )
+    {
+      bool bMoved{};
+      seekUnfiltered( [&] { bMoved = move( bForward ); } );
+      m_bOnMatch = m_bOnMatch || bMoved;
+      return bMoved;
+    }
+
+    // a failed step returns here, the cursor is taken before the scan moves the journal
+    const std::optional<SdCursor> origin = m_bOnMatch ? std::optional{ m_journal.getCursor() } : std::nullopt;
+    m_bBudgetExhausted = false;
+    // a failed step returns to the origin, but the line is read again as the scan has reused its storage
+    m_line.reset();
+
+    // the entries up to the frontier have been scanned by the previous step from here, they do not match
+    const bool bResumed = origin && m_resume && m_resume->bForward == bForward && m_resume->from == origin->seqid;
+    if ( bResumed )
+    {
+      m_journal.seekToCursor( m_resume->frontier.toString() );
+      // lands on the frontier itself
+      move( bForward );
+    }
+
+    size_t uScanned = 0;
+    while ( move( bForward ) )
+    {
+      ++uScanned;
+      ++m_uEntriesScanned;
+      SdLine line = m_journal.getLine();
+      if ( std::invoke( m_predicate, std::as_const( line ) ) )
+      {
+        m_line.emplace( std::move( line ) );
+        m_bOnMatch = true;
+        // the resume point stays valid, e.g. for ChunkedJournal stepping onto the anchor of a chunk and beyond it
+        return true;
+      }
+      if ( uScanned >= m_uScanBudget )
+      {
+        m_bBudgetExhausted = true;
+        if ( origin )
+        {
+          m_resume = Resume{ origin->seqid, bForward, m_journal.getCursor() };
+        }
+        break;
+      }
+    }
+
+    // the journal has not moved if it could not step at all
+    if ( origin && ( bResumed || uScanned > 0 ) )
+    {
+      // lands on the origin itself
+      m_journal.seekToCursor( origin->toString() );
+      move( bForward );
+    }
+    return false;
+  }
+};
+
+}// namespace jess
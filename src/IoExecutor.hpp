@@ -0,0 +1,226 @@
+#pragma once
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace jess
+{
+
+/// runs the journal i/o of the ui on a worker thread, one task at a time, so that the ui keeps reading keys meanwhile
+///
+/// a task is split into its work, which runs on the worker, and its completion, which the ui thread runs with
+/// runCompletions() after the work is done. notifyFd() becomes readable when completions are ready, so that the ui can
+/// poll it along with its other input.
+/// A task submitted with SUPERSEDE makes the tasks before it stale, e.g. a jump to the end of the journal makes a
+/// scroll still being loaded pointless: the queued ones are dropped, the running one is asked to stop through the stop
+/// token passed to its work, and the completions of all of them are never run.
+class IoExecutor
+{
+public:
+  using Work = std::function<void( const std::stop_token& )>;
+  using Completion = std::function<void()>;
+
+  enum class Mode {
+    // run after the tasks submitted before, e.g. a relative move that builds on the previous ones
+    QUEUE,
+    // replace the tasks submitted before
+    SUPERSEDE,
+  };
+
+private:
+  struct Task {
+    uint64_t id;
+    Work work;
+    Completion completion;
+  };
+
+  std::mutex m_mutex{};
+  std::condition_variable_any m_cv{};
+  std::deque<Task> m_tasks{};
+  // stop source of the running task, if any
+  std::optional<std::stop_source> m_running{};
+  std::vector<Task> m_completions{};
+  // thrown by the work of a task and rethrown by runCompletions()
+  std::exception_ptr m_pError{};
+  uint64_t m_uNextId{};
+  // tasks with a lower id are stale
+  uint64_t m_uFirstValidId{};
+  int m_notifyFd;
+  std::jthread m_worker;
+
+public:
+  IoExecutor()
+    : m_notifyFd( ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) )
+  {
+    if ( m_notifyFd < 0 )
+    {
+      throw std::system_error{ errno, std::generic_category(), "eventfd" };
+    }
+    m_worker = std::jthread{ [this]( const std::stop_token& stopToken ) { run( stopToken ); } };
+  }
+
+  IoExecutor( const IoExecutor& ) = delete;
+  IoExecutor& operator=( const IoExecutor& ) = delete;
+
+  ~IoExecutor()
+  {
+    cancel();
+    m_worker.request_stop();
+    m_worker.join();
+    ::close( m_notifyFd );
+  }
+
+  void submit( const Mode mode, Work work, Completion completion = {} )
+  {
+    {
+      std::scoped_lock lock{ m_mutex };
+      const uint64_t uId = m_uNextId++;
+      if ( mode == Mode::SUPERSEDE )
+      {
+        dropLocked( uId );
+      }
+      m_tasks.push_back( Task{ uId, std::move( work ), std::move( completion ) } );
+    }
+    m_cv.notify_all();
+  }
+
+  /// drops all tasks like a superseding one would, without submitting a new one
+  void cancel()
+  {
+    {
+      std::scoped_lock lock{ m_mutex };
+      dropLocked( m_uNextId );
+    }
+    m_cv.notify_all();
+  }
+
+  /// set while tasks are queued or running, or their completions have not been run yet
+  [[nodiscard]] bool busy()
+  {
+    std::scoped_lock lock{ m_mutex };
+    return !m_tasks.empty() || m_running || !m_completions.empty();
+  }
+
+  /// blocks until no task is queued or running; the completions may still have to be run
+  void waitIdle()
+  {
+    std::unique_lock lock{ m_mutex };
+    m_cv.wait( lock, [&] { return m_tasks.empty() && !m_running; } );
+  }
+
+  /// becomes readable when there are completions to run
+  [[nodiscard]] int notifyFd() const { return m_notifyFd; }
+
+  /// runs the completions of the finished tasks which have not become stale, in the order the tasks were submitted
+  ///
+  /// rethrows the exception the work of a task has thrown, its completion is dropped
+  void runCompletions()
+  {
+    uint64_t uCount{};
+    [[maybe_unused]] const ssize_t iRead = ::read( m_notifyFd, &uCount, sizeof( uCount ) );
+
+    std::vector<Task> completions{};
+    {
+      std::scoped_lock lock{ m_mutex };
+      if ( m_pError )
+      {
+        std::rethrow_exception( std::exchange( m_pError, nullptr ) );
+      }
+      completions = std::exchange( m_completions, {} );
+    }
+    for ( const Task& task : completions )
+    {
+      // a completion may submit a superseding task, which makes the remaining ones stale
+      if ( task.completion && isValid( task.id ) )
+      {
+        task.completion();
+      }
+    }
+  }
+
+private:
+  bool isValid( const uint64_t uId )
+  {
+    std::scoped_lock lock{ m_mutex };
+    return uId >= m_uFirstValidId;
+  }
+
+  /// makes the tasks before uFirstValidId stale, the mutex must be held
+  void dropLocked( const uint64_t uFirstValidId )
+  {
+    m_uFirstValidId = uFirstValidId;
+    m_tasks.clear();
+    m_completions.clear();
+    if ( m_running )
+    {
+      m_running->request_stop();
+    }
+  }
+
+  void notify()
+  {
+    const uint64_t uOne = 1;
+    [[maybe_unused]] const ssize_t iWritten = ::write( m_notifyFd, &uOne, sizeof( uOne ) );
+  }
+
+  void run( const std::stop_token& stopToken )
+  {
+    while ( true )
+    {
+      Task task{};
+      std::stop_token taskStopToken{};
+      {
+        std::unique_lock lock{ m_mutex };
+        if ( !m_cv.wait( lock, stopToken, [&] { return !m_tasks.empty(); } ) )
+        {
+          return;
+        }
+        task = std::move( m_tasks.front() );
+        m_tasks.pop_front();
+        taskStopToken = m_running.emplace().get_token();
+      }
+
+      std::exception_ptr pError{};
+      try
+      {
+        task.work( taskStopToken );
+      }
+      catch ( ... )
+      {
+        pError = std::current_exception();
+      }
+
+      {
+        std::scoped_lock lock{ m_mutex };
+        m_running.reset();
+        if ( pError )
+        {
+          m_pError = pError;
+        }
+        else if ( task.id >= m_uFirstValidId )
+        {
+          m_completions.push_back( std::move( task ) );
+        }
+      }
+      notify();
+      m_cv.notify_all();
+    }
+  }
+};
+
+}// namespace jess
@@ -1,85 +1,903 @@
 #pragma once
 
 #include "ChunkedJournal.hpp"
+#include "ExpandedEntryCache.hpp"
+#include "FilteredStream.hpp"
+#include "IoExecutor.hpp"
+#include "JessOptions.hpp"
+#include "JournalFilter.hpp"
 #include "MainFrame.hpp"
 #include "Modeline.hpp"
 #include "NcTerminal.hpp"
+#include "ScrollCoalescer.hpp"
 #include "SdJournal.hpp"
+#include "Session.hpp"
+#include "Stats.hpp"
+#include "SubstringSearcher.hpp"
+#include "TimeExpression.hpp"
+#include "Timeline.hpp"
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace jess
 {
 
 class JessMain
 {
+  // new entries are read at most this often, so that bursts of entries do not cause a redraw each
+  static constexpr auto TAIL_UPDATE_INTERVAL = std::chrono::milliseconds{ 100 };
+  // entries beyond are not read right away, following jumps to the end of the journal instead
+  static constexpr size_t MAX_APPENDED_LINES = 16 * 1024;
+  // a search pauses after loading this many uncached lines, so that a search without matches cannot hang the ui
+  static constexpr size_t MAX_SEARCH_LOADED_LINES = 100'000;
+  // the least severe priority jumpToError() stops at, LOG_ERR
+  static constexpr uint8_t ERROR_PRIORITY = 3;
+  // budget of the complete messages of expanded entries, kept apart from the chunk cache
+  static constexpr size_t EXPANDED_ENTRIES_BYTES = 64 * 1024 * 1024;
+  // the timeline is computed at this resolution and merged to the width of the strip
+  static constexpr size_t TIMELINE_BUCKETS = 512;
+  static constexpr size_t MAX_TIMELINE_WIDTH = 64;
+  // while the timeline is being refined, the status line picks up new passes at least this often
+  static constexpr auto TIMELINE_UPDATE_INTERVAL = std::chrono::milliseconds{ 250 };
+  // loads that take longer are shown in the status line, quicker ones would only make it flicker
+  static constexpr auto LOADING_INDICATOR_DELAY = std::chrono::milliseconds{ 100 };
+
+  /// the journal as shown, narrowed by the grep command; libsystemd only matches whole field values
+  using ViewedJournal = FilteredStream<SdJournal, MessageContains>;
+
+  /// the lines on screen and the chunk position shown in the status line, read on the i/o thread
+  struct Frame {
+    std::string sCursor;
+    std::vector<SdLine> lines;
+    // set if the grep ran out of its scan budget, the lines may continue beyond
+    bool bScanStopped{};
+  };
+
   NcTerminal m_rootTerminal{};
   NcWindow m_rootWindow = m_rootTerminal.rootWindow();
   Modeline m_modeline{ m_rootWindow };
   MainFrame m_mainFrame{ m_rootWindow };
   std::string m_currentCursor{};
   bool m_bModelineActive{};
-  std::span<SdLine> m_currentLines{};
-  ChunkedJournal<SdJournal> m_journal{ 1024, 0 };
+  // the messages refer to the cached chunks, they must not be read while m_executor is busy
+  std::vector<SdLine> m_currentLines{};
+  // calls into libsystemd by all journal handles, including those of the background workers
+  std::atomic<uint64_t> m_uJournalCalls{};
+  // opens a journal handle of the scope given on the command line, the background workers open their own
+  std::function<SdJournal()> m_openJournal;
+  ChunkedJournal<ViewedJournal> m_journal;
+  // runs everything that touches m_journal once the viewer is started, declared after it to be stopped before it
+  IoExecutor m_executor{};
+  // when the executor became busy
+  std::chrono::steady_clock::time_point m_loadingSince{};
+  ExpandedEntryCache m_expandedEntries{ EXPANDED_ENTRIES_BYTES };
+  int m_journalFd{ -1 };
+  // keep showing the end of the journal as new entries arrive
+  bool m_bFollow{};
+  // set when the journal reported changes that have not been read yet
+  bool m_bJournalChanged{};
+  std::chrono::steady_clock::time_point m_nextTailUpdate{};
+  bool m_bIgnoreCase{};
+  std::optional<SubstringSearcher> m_search{};
+  Adjacency m_searchDirection{ Adjacency::AFTER_CURRENT };
+  // the active filter and grep, empty if all entries are shown
+  JournalFilter m_filter{};
+  std::string m_sGrep{};
+  // the grep of the frame on screen ran out of its scan budget
+  bool m_bScanStopped{};
+  std::unique_ptr<TimelineBuilder<SdJournal>> m_pTimelineBuilder{};
+  std::optional<Timeline> m_timeline{};
+  bool m_bShowTimeline{ true };
+  // empty if the session is neither restored nor saved
+  std::filesystem::path m_sessionPath{};
+  // shown next to the position until the status line is updated again
+  std::string m_sMessage{};
+  LatencyHistogram m_redrawTime{};
+  // from reading a key until the screen is updated, unset while no key waits for its redraw
+  LatencyHistogram m_keyToScreenTime{};
+  std::optional<std::chrono::steady_clock::time_point> m_keyTime{};
+  ScrollCoalescer m_scroll{};
+  // empty if the statistics are not written on exit
+  std::filesystem::path m_statsPath{};
 
 public:
-  KeyCombination getNextKey() { return m_modeline.getKeyCombination().value(); }
+  explicit JessMain( const JessOptions& options )
+    : m_openJournal( [this, scope = options.scope, uDataThreshold = options.dataThreshold] {
+      SdJournal journal{ scope };
+      journal.setCallCounter( &m_uJournalCalls );
+      journal.setDataThreshold( uDataThreshold );
+      return journal;
+    } )
+    , m_journal( 1024, 1024, options.cacheBudget, [this] { return ViewedJournal{ m_openJournal(), MessageContains{ "" } }; },
+        journalConfiguration( options.filter, options.grep, options.ignoreCase ), options.columns )
+  {
+    m_mainFrame.setTimestampFormat( options.timestampFormat );
+    m_journalFd = m_journal.journal().journal().getFd();
+    m_bIgnoreCase = options.ignoreCase;
+    m_bShowTimeline = options.timeline;
+    m_sGrep = options.grep;
+    useFilter( options.filter );
+    if ( options.session )
+    {
+      m_sessionPath = defaultSessionPath();
+    }
+    m_statsPath = options.statsFile;
+  }
+
+  JessMain( const JessMain& ) = delete;
+  JessMain& operator=( const JessMain& ) = delete;
+
+  /// moves to the position saved by the previous run, returns false if there is none
+  bool restoreSession()
+  {
+    if ( m_sessionPath.empty() )
+    {
+      return false;
+    }
+    const Session session = readSession( m_sessionPath );
+    if ( !session.position )
+    {
+      return false;
+    }
+    navigate( IoExecutor::Mode::SUPERSEDE, [this, position = *session.position]( const std::stop_token& ) { m_journal.seekToPosition( position ); } );
+    return true;
+  }
+
+  /// stops the loads in progress, afterwards the journal may only be accessed by the calling thread
+  void stopLoading()
+  {
+    m_executor.cancel();
+    m_executor.waitIdle();
+  }
+
+  /// saves the position, stopLoading() must have been called before
+  void saveSession()
+  {
+    if ( !m_sessionPath.empty() )
+    {
+      writeSession( m_sessionPath, Session{ m_journal.getPosition() } );
+    }
+  }
+
+  /// writes the statistics to the file given with --stats-file, returns false if that fails; stopLoading() must have
+  /// been called before
+  bool writeStatsFile() const
+  {
+    if ( m_statsPath.empty() )
+    {
+      return true;
+    }
+    std::ofstream file{ m_statsPath, std::ios::trunc };
+    file << formatStats( m_journal.getNumChunks(), m_journal.getCachedBytes() );
+    return static_cast<bool>( file.flush() );
+  }
+
+  /// counters of the chunk cache and the journal, and latencies of the ui, one per line
+  ///
+  /// the size of the cache is passed in, as it can only be read on the thread using the journal
+  std::string formatStats( const size_t uNumChunks, const size_t uCachedBytes ) const
+  {
+    const CacheStats& stats = m_journal.stats();
+    const uint64_t uHits = stats.cacheHits.load();
+    const uint64_t uLookups = uHits + stats.cacheMisses.load();
+    std::string sStats{};
+    sStats += "chunks cached:       " + std::to_string( uNumChunks ) + " (" + std::to_string( uCachedBytes ) + " bytes)\n";
+    sStats += "chunks built:        " + std::to_string( stats.chunksBuilt.load() ) + " (prefetched: " + std::to_string( stats.chunksPrefetched.load() ) +
+      ", discarded: " + std::to_string( stats.prefetchesDiscarded.load() ) + ")\n";
+    sStats += "chunks evicted:      " + std::to_string( stats.chunksEvicted.load() ) + "\n";
+    sStats += "entries read:        " + std::to_string( stats.entriesRead.load() ) + "\n";
+    sStats += "cache hits:          " + std::to_string( uHits ) + " of " + std::to_string( uLookups ) + " lookups" +
+      ( uLookups == 0 ? "" : " (" + std::to_string( uHits * 100 / uLookups ) + "%)" ) + "\n";
+    sStats += "sd_journal calls:    " + std::to_string( m_uJournalCalls.load() ) + "\n";
+    sStats += "expanded entries:    " + std::to_string( m_expandedEntries.size() ) + " (" + std::to_string( m_expandedEntries.sizeInBytes() ) + " bytes)\n";
+    sStats += "chunk build time:    " + stats.chunkBuildTime.toString() + "\n";
+    sStats += "redraw time:         " + m_redrawTime.toString() + "\n";
+    sStats += "key to screen time:  " + m_keyToScreenTime.toString() + "\n";
+    sStats += "scroll keys:         " + std::to_string( m_scroll.keys() ) + " in " + std::to_string( m_scroll.frames() ) + " frames\n";
+    return sStats;
+  }
+
+  /// waits for the next key other than a scroll key, reading new journal entries in the meantime
+  ///
+  /// scroll keys are handled right here: the pending ones are drained and merged into a single seek, which is drawn at
+  /// most once per frame, see ScrollCoalescer. While a seek is being loaded, the following scroll keys are merged until
+  /// it is done; other keys are returned right away.
+  KeyCombination getNextKey()
+  {
+    while ( true )
+    {
+      m_executor.runCompletions();
+      const auto kc = m_modeline.pollKeyCombination();
+      const auto now = std::chrono::steady_clock::now();
+      const auto iLines = kc ? scrollDistance( *kc, m_mainFrame.height() ) : std::nullopt;
+      if ( iLines )
+      {
+        // the latency of merged keys is measured from the first one
+        if ( !m_scroll.pending() )
+        {
+          m_keyTime = now;
+        }
+        m_scroll.add( *iLines );
+      }
+
+      // other keys act on the scrolled position, so the pending scroll is submitted before they are returned; otherwise
+      // the keys read while a load is in progress are merged until it is done
+      if ( ( kc && !iLines ) || !m_executor.busy() )
+      {
+        if ( const auto iNetLines = m_scroll.take( now, iLines.has_value() ) )
+        {
+          scrollBy( *iNetLines );
+        }
+      }
+
+      if ( kc && !iLines )
+      {
+        m_keyTime = now;
+        return *kc;
+      }
+      if ( !kc )
+      {
+        waitForInput();
+      }
+    }
+  }
 
   void scrollToBof()
   {
-    m_journal.seekToBof();
-    redrawTranslation();
+    m_bFollow = false;
+    navigate( IoExecutor::Mode::SUPERSEDE, [this]( const std::stop_token& ) { m_journal.seekToBof(); } );
   }
 
   void scrollToEof()
   {
-    m_journal.seekToEof();
-    redrawTranslation();
+    navigate( IoExecutor::Mode::SUPERSEDE, [this, uHeight = m_mainFrame.height()]( const std::stop_token& ) { showLastPage( uHeight ); } );
   }
 
-  void scrollUpLine()
+  /// moves to the first entry at or after the time
+  void scrollToTime( const std::chrono::system_clock::time_point time )
   {
-    m_journal.seekLines( -1 );
-    redrawTranslation();
+    m_bFollow = false;
+    navigate( IoExecutor::Mode::SUPERSEDE, [this, time]( const std::stop_token& ) { m_journal.seekToTime( time ); } );
   }
 
-  void scrollDownLine()
+  void toggleFollow()
   {
-    m_journal.seekLines( 1 );
-    redrawTranslation();
+    m_bFollow = !m_bFollow;
+    if ( !m_bFollow )
+    {
+      redraw();
+      return;
+    }
+
+    m_bJournalChanged = false;
+    navigate( IoExecutor::Mode::SUPERSEDE, [this, uHeight = m_mainFrame.height()]( const std::stop_token& ) {
+      m_journal.journal().journal().process();
+      m_journal.appendNewEntries( MAX_APPENDED_LINES );
+      showLastPage( uHeight );
+    } );
   }
 
-  void scrollUpPage()
+  /// moves the view by the number of lines, negative upwards; scrolling up stops following the end of the journal
+  void scrollBy( const int64_t iLines )
   {
-    m_journal.seekLines( -static_cast<int64_t>( m_mainFrame.height() ) );
-    redrawTranslation();
+    if ( iLines < 0 )
+    {
+      m_bFollow = false;
+    }
+    navigate( IoExecutor::Mode::QUEUE, [this, iLines]( const std::stop_token& ) {
+      if ( iLines != 0 )
+      {
+        m_journal.seekLines( iLines );
+      }
+    } );
   }
 
-  void scrollDownPage()
+  void toggleLocalTime()
   {
-    m_journal.seekLines( static_cast<int64_t>( m_mainFrame.height() ) );
-    redrawTranslation();
+    TimestampFormat format = m_mainFrame.timestampFormat();
+    format.localTime = !format.localTime;
+    m_mainFrame.setTimestampFormat( format );
+    redraw();
   }
 
+  void toggleMicroseconds()
+  {
+    TimestampFormat format = m_mainFrame.timestampFormat();
+    format.microseconds = !format.microseconds;
+    m_mainFrame.setTimestampFormat( format );
+    redraw();
+  }
+
+  void toggleTimeline()
+  {
+    m_bShowTimeline = !m_bShowTimeline;
+    redraw();
+  }
+
+  /// asks for a pattern and searches for it, an empty pattern repeats the previous search
+  void startSearch( const Adjacency direction )
+  {
+    const std::string sPattern = m_modeline.prompt( direction == Adjacency::AFTER_CURRENT ? "/" : "?" );
+    if ( !sPattern.empty() )
+    {
+      m_search.emplace( sPattern, m_bIgnoreCase );
+    }
+    m_searchDirection = direction;
+    search( direction );
+  }
+
+  void searchNext() { search( m_searchDirection ); }
+
+  void searchPrevious() { search( m_searchDirection == Adjacency::AFTER_CURRENT ? Adjacency::BEFORE_CURRENT : Adjacency::AFTER_CURRENT ); }
+
+  /// moves to the next entry after (or before) the top line with the priority err or a more severe one
+  void jumpToError( const Adjacency direction )
+  {
+    const auto pResult = std::make_shared<SearchResult>();
+    navigate(
+      IoExecutor::Mode::QUEUE,
+      [this, pResult, direction]( const std::stop_token& stopToken ) {
+        *pResult = m_journal.searchPriority( ERROR_PRIORITY, direction, MAX_SEARCH_LOADED_LINES, stopToken );
+      },
+      [this, pResult, direction] {
+        if ( *pResult == SearchResult::NOT_FOUND )
+        {
+          m_sMessage = direction == Adjacency::AFTER_CURRENT ? "no error below" : "no error above";
+        }
+        else if ( *pResult == SearchResult::INTERRUPTED )
+        {
+          m_bFollow = false;
+          m_sMessage = "no error in " + std::to_string( MAX_SEARCH_LOADED_LINES ) + " lines, press again to continue";
+        }
+        else
+        {
+          m_bFollow = false;
+        }
+      } );
+  }
+
+  /// shows the complete message of the entry at the top of the screen until q is pressed
+  ///
+  /// the message is read again from the journal, as the chunks only hold its beginning if it is truncated
+  void expandEntry()
+  {
+    if ( m_currentLines.empty() )
+    {
+      showMessage( "no entry to expand" );
+      return;
+    }
+
+    if ( const std::string* pMessage = m_expandedEntries.find( m_currentLines.front().seqid() ) )
+    {
+      showPager( *pMessage );
+      redraw();
+      return;
+    }
+
+    // the entry is read at the position the queued moves end at, which is the one shown once they are done
+    const auto pMessage = std::make_shared<std::optional<std::pair<SdSeqid, std::string>>>();
+    load(
+      IoExecutor::Mode::QUEUE,
+      [this, pMessage]( const std::stop_token& ) {
+        const auto position = m_journal.getPosition();
+        if ( auto sMessage = position ? m_journal.journal().journal().readFullMessage( position->line ) : std::nullopt )
+        {
+          pMessage->emplace( position->line.seqid, std::move( *sMessage ) );
+        }
+      },
+      [this, pMessage] {
+        if ( !*pMessage )
+        {
+          showMessage( "the entry is no longer in the journal" );
+          return;
+        }
+        showPager( m_expandedEntries.insert( ( *pMessage )->first, std::move( ( *pMessage )->second ) ) );
+        redraw();
+      } );
+  }
+
+  /// reads a command from the modeline and executes it
   void activateModeline()
   {
     m_bModelineActive = true;
-    m_modeline.setActive();
+    const std::string sCommandLine = m_modeline.setActive();
     m_bModelineActive = false;
+    executeCommand( sCommandLine );
   }
 
 private:
+  /// while a load is in progress only the status line is updated, the lines on screen stay as they were drawn last
   void redraw()
   {
+    if ( m_executor.busy() )
+    {
+      displayOffset();
+      NcTerminal::update();
+      return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
     m_mainFrame.drawLines( m_currentLines );
-    m_modeline.focus();
+    displayOffset();
+    NcTerminal::update();
+    const auto end = std::chrono::steady_clock::now();
+    m_redrawTime.record( end - start );
+    if ( m_keyTime )
+    {
+      m_keyToScreenTime.record( end - *std::exchange( m_keyTime, std::nullopt ) );
+    }
+  }
+
+  /// moves through the journal on the i/o thread and shows the lines at the new position once it is done
+  ///
+  /// done is run right before they are drawn, e.g. to set the message shown along with them; neither is run if a later
+  /// task supersedes this one
+  void navigate( const IoExecutor::Mode mode, std::function<void( const std::stop_token& )> move, std::function<void()> done = {} )
+  {
+    const auto pFrame = std::make_shared<Frame>();
+    load(
+      mode,
+      [this, pFrame, move = std::move( move ), uHeight = m_mainFrame.height()]( const std::stop_token& stopToken ) {
+        move( stopToken );
+        if ( !stopToken.stop_requested() )
+        {
+          *pFrame = readFrame( uHeight );
+        }
+      },
+      [this, pFrame, done = std::move( done )] {
+        if ( done )
+        {
+          done();
+        }
+        showFrame( std::move( *pFrame ) );
+      } );
   }
-  void redrawTranslation()
+
+  /// submits the task to the i/o thread, see IoExecutor
+  void load( const IoExecutor::Mode mode, IoExecutor::Work work, IoExecutor::Completion completion )
+  {
+    if ( !m_executor.busy() )
+    {
+      m_loadingSince = std::chrono::steady_clock::now();
+    }
+    m_executor.submit( mode, std::move( work ), std::move( completion ) );
+  }
+
+  /// called on the i/o thread
+  Frame readFrame( const size_t uHeight )
   {
-    m_currentCursor = m_journal.getChunkPositionString();
-    m_currentLines = m_journal.getLines( m_mainFrame.height() );
+    // the initializers are evaluated in order, the budget is read after the steps of getLines()
+    return Frame{ m_journal.getChunkPositionString(), m_journal.getLines( uHeight ), m_journal.journal().budgetExhausted() };
+  }
+
+  void showFrame( Frame&& frame )
+  {
+    m_currentCursor = std::move( frame.sCursor );
+    m_currentLines = std::move( frame.lines );
+    m_bScanStopped = frame.bScanStopped;
     redraw();
+    m_sMessage.clear();
+    m_scroll.frameDrawn( std::chrono::steady_clock::now() );
+  }
+
+  void displayOffset()
+  {
+    const bool bLoading = m_executor.busy() && std::chrono::steady_clock::now() - m_loadingSince >= LOADING_INDICATOR_DELAY;
+    const std::string sGrep = m_sGrep.empty() ? ""
+      : " [grep: " + m_sGrep + ( m_bScanStopped ? ", no match in " + std::to_string( ViewedJournal::DEFAULT_SCAN_BUDGET ) + " entries, move on to scan further" : "" ) + "]";
+    m_modeline.displayStatusString( "cursor: " + m_currentCursor + ( m_bFollow ? " [follow]" : "" ) + ( m_filter.empty() ? "" : " [filter: " + m_filter.toString() + "]" ) +
+        sGrep + ( bLoading ? " [loading]" : "" ) + ( m_sMessage.empty() ? "" : " | " + m_sMessage ),
+      timelineStrip() );
+  }
+
+  /// the entry density over the whole journal with the position of the top line, empty if hidden or not known yet
+  std::string timelineStrip() const
+  {
+    if ( !m_bShowTimeline || !m_timeline || m_timeline->counts.empty() )
+    {
+      return {};
+    }
+    const size_t uWidth = std::min( MAX_TIMELINE_WIDTH, m_rootWindow.width() / 3 );
+    const auto marker = m_currentLines.empty() ? std::nullopt : std::optional{ m_currentLines.front().realtime() };
+    // a trailing '~' shows that the counts are still estimates
+    return "[" + renderTimeline( *m_timeline, uWidth, marker ) + ( m_timeline->complete ? "]" : "~" );
+  }
+
+  /// shows the latest pass of the timeline if there is one
+  void updateTimeline()
+  {
+    if ( auto timeline = m_pTimelineBuilder->takeUpdate() )
+    {
+      m_timeline = std::move( timeline );
+      displayOffset();
+      NcTerminal::update();
+    }
+  }
+
+  /// commands are a name followed by arguments, e.g. "filter _SYSTEMD_UNIT=cron.service"
+  void executeCommand( std::string_view sCommandLine )
+  {
+    sCommandLine.remove_prefix( std::min( sCommandLine.find_first_not_of( ' ' ), sCommandLine.size() ) );
+    const size_t uNameEnd = std::min( sCommandLine.find( ' ' ), sCommandLine.size() );
+    const std::string_view sName = sCommandLine.substr( 0, uNameEnd );
+    const std::string_view sArguments = sCommandLine.substr( uNameEnd );
+
+    if ( sName.empty() )
+    {
+      redraw();
+    }
+    else if ( sName == "filter" )
+    {
+      setFilter( sArguments );
+    }
+    else if ( sName == "grep" )
+    {
+      setGrep( sArguments );
+    }
+    else if ( sName == "columns" )
+    {
+      setColumns( sArguments );
+    }
+    else if ( sName == "expand" )
+    {
+      expandEntry();
+    }
+    else if ( sName == "stats" )
+    {
+      // the size of the cache is read after the loads in progress
+      const auto pCacheSize = std::make_shared<std::pair<size_t, size_t>>();
+      load(
+        IoExecutor::Mode::QUEUE,
+        [this, pCacheSize]( const std::stop_token& ) { *pCacheSize = { m_journal.getNumChunks(), m_journal.getCachedBytes() }; },
+        [this, pCacheSize] {
+          showPager( formatStats( pCacheSize->first, pCacheSize->second ), "stats" );
+          redraw();
+        } );
+    }
+    else if ( sName == "goto" )
+    {
+      gotoTime( sArguments );
+    }
+    else
+    {
+      showMessage( "unknown command: " + std::string{ sName } );
+    }
+  }
+
+  /// shows the fields of the comma separated list between the timestamp and the message
+  void setColumns( std::string_view sList )
+  {
+    sList.remove_prefix( std::min( sList.find_first_not_of( ' ' ), sList.size() ) );
+    sList.remove_suffix( sList.size() - std::min( sList.find_last_not_of( ' ' ) + 1, sList.size() ) );
+    std::vector<std::string> columns{};
+    try
+    {
+      columns = parseColumns( sList );
+    }
+    catch ( const std::invalid_argument& ex )
+    {
+      showMessage( ex.what() );
+      return;
+    }
+
+    m_mainFrame.resetColumns();
+    // the cached chunks hold the values of the previous columns, they are read again at the same position
+    navigate( IoExecutor::Mode::SUPERSEDE, [this, columns = std::move( columns )]( const std::stop_token& ) mutable {
+      const auto position = m_journal.getPosition();
+      m_journal.setColumns( std::move( columns ) );
+      if ( !position || !m_journal.seekToPosition( *position ) )
+      {
+        m_journal.seekToBof();
+      }
+    } );
+  }
+
+  /// moves to the first entry at or after the time, see parseTimeExpression()
+  ///
+  /// absolute times are read in the time zone the timestamps are shown in
+  void gotoTime( const std::string_view sExpression )
+  {
+    std::chrono::system_clock::time_point target{};
+    try
+    {
+      target = parseTimeExpression( sExpression, std::chrono::system_clock::now(), m_mainFrame.timestampFormat().localTime );
+    }
+    catch ( const std::invalid_argument& ex )
+    {
+      showMessage( ex.what() );
+      return;
+    }
+
+    scrollToTime( target );
+  }
+
+  /// shows only the entries matching the filter expression, see parseFilter(); an empty expression shows all entries
+  ///
+  /// the matching is done by libsystemd, which looks the entries up in the indexes of the journal files
+  void setFilter( const std::string_view sExpression )
+  {
+    JournalFilter filter{};
+    try
+    {
+      filter = parseFilter( sExpression );
+    }
+    catch ( const std::invalid_argument& ex )
+    {
+      showMessage( ex.what() );
+      return;
+    }
+
+    useFilter( filter );
+    reloadJournal();
+  }
+
+  /// shows only the entries whose message contains the text, all entries if it is empty
+  ///
+  /// unlike the filter, the messages are read and compared one by one on the i/o thread, see FilteredStream
+  void setGrep( std::string_view sText )
+  {
+    sText.remove_prefix( std::min( sText.find_first_not_of( ' ' ), sText.size() ) );
+    sText.remove_suffix( sText.size() - std::min( sText.find_last_not_of( ' ' ) + 1, sText.size() ) );
+    m_sGrep = sText;
+    m_bScanStopped = false;
+    reloadJournal();
+  }
+
+  /// reads the journal again with the current filter and grep, at its end if following it, otherwise at its beginning
+  void reloadJournal()
+  {
+    navigate( IoExecutor::Mode::SUPERSEDE,
+      [this, configure = journalConfiguration( m_filter, m_sGrep, m_bIgnoreCase ), bFollow = m_bFollow, uHeight = m_mainFrame.height()]( const std::stop_token& ) {
+        // the cached lines were read with the previous configuration, the journal has no current line afterwards
+        m_journal.reconfigure( configure );
+        if ( bFollow )
+        {
+          showLastPage( uHeight );
+        }
+        else
+        {
+          m_journal.seekToBof();
+        }
+      } );
+  }
+
+  /// the function that applies the filter to a journal handle
+  static std::function<void( SdJournal& )> filterConfiguration( const JournalFilter& filter )
+  {
+    return [filter]( SdJournal& journal ) { applyFilter( journal, filter ); };
+  }
+
+  /// the function that applies the filter and the grep to a handle of the viewed journal
+  static std::function<void( ViewedJournal& )> journalConfiguration( const JournalFilter& filter, const std::string& sGrep, const bool bIgnoreCase )
+  {
+    return [filter, sGrep, bIgnoreCase]( ViewedJournal& journal ) {
+      applyFilter( journal.journal(), filter );
+      journal.setPredicate( MessageContains{ sGrep, bIgnoreCase } );
+    };
+  }
+
+  /// shows the filter in the status line and restarts the timeline with it, the journal handles are configured apart
+  void useFilter( const JournalFilter& filter )
+  {
+    m_filter = filter;
+    // the timeline shows the density of the entries matching the filter; the grep is left out, as it would have to
+    // read every message of the journal
+    m_timeline.reset();
+    m_pTimelineBuilder = std::make_unique<TimelineBuilder<SdJournal>>( TIMELINE_BUCKETS, m_openJournal, filterConfiguration( filter ) );
+  }
+
+  void showMessage( std::string sMessage )
+  {
+    m_sMessage = std::move( sMessage );
     displayOffset();
+    NcTerminal::update();
+    m_sMessage.clear();
+  }
+
+  void search( const Adjacency direction )
+  {
+    if ( !m_search )
+    {
+      showMessage( "no previous search" );
+      return;
+    }
+
+    // the searcher is copied, a new pattern may be entered while this search is still running
+    const auto pResult = std::make_shared<SearchResult>();
+    navigate(
+      IoExecutor::Mode::QUEUE,
+      [this, pResult, searcher = *m_search, direction]( const std::stop_token& stopToken ) {
+        *pResult = m_journal.search( searcher, direction, MAX_SEARCH_LOADED_LINES, stopToken );
+      },
+      [this, pResult, sNeedle = std::string{ m_search->needle() }] {
+        if ( *pResult == SearchResult::NOT_FOUND )
+        {
+          m_sMessage = "pattern not found: " + sNeedle;
+        }
+        else if ( *pResult == SearchResult::INTERRUPTED )
+        {
+          m_bFollow = false;
+          m_sMessage = "no match in " + std::to_string( MAX_SEARCH_LOADED_LINES ) + " lines, search again to continue";
+        }
+        else
+        {
+          m_bFollow = false;
+        }
+      } );
+  }
+
+  /// shows the text wrapped at the width of the screen and scrolls through it until q is pressed
+  void showPager( const std::string_view sText, const std::string_view sTitle = "entry" )
+  {
+    const std::vector<std::string_view> rows = wrapRows( sText, m_mainFrame.width() );
+    const size_t uPageHeight = m_mainFrame.height();
+    const size_t uMaxTop = rows.size() > uPageHeight ? rows.size() - uPageHeight : 0;
+    size_t uTop = 0;
+
+    while ( true )
+    {
+      m_mainFrame.drawPage( std::span{ rows }.subspan( uTop ) );
+      m_modeline.displayStatusString( std::string{ sTitle } + ": rows " + std::to_string( uTop + 1 ) + "-" + std::to_string( std::min( uTop + uPageHeight, rows.size() ) ) +
+        " of " + std::to_string( rows.size() ) + " | q: back" );
+      NcTerminal::update();
+
+      const KeyCombination kc = m_modeline.getKeyCombination().value_or( KeyCombination{} );
+      if ( kc == KeyCombination( 'q' ) || kc == KeyCombination( 'e' ) )
+      {
+        return;
+      }
+      if ( kc == ctrl( 'n' ) || kc == KeyCombination( KEY_DOWN ) || kc == KeyCombination( 'j' ) )
+      {
+        uTop = std::min( uTop + 1, uMaxTop );
+      }
+      else if ( kc == ctrl( 'p' ) || kc == KeyCombination( KEY_UP ) || kc == KeyCombination( 'k' ) )
+      {
+        uTop -= std::min<size_t>( uTop, 1 );
+      }
+      else if ( kc == KeyCombination( 'f' ) || kc == KeyCombination( ' ' ) || kc == ctrl( 'v' ) || kc == KeyCombination( KEY_NPAGE ) )
+      {
+        uTop = std::min( uTop + uPageHeight, uMaxTop );
+      }
+      else if ( kc == KeyCombination( 'b' ) || kc == meta( 'v' ) || kc == KeyCombination( KEY_PPAGE ) )
+      {
+        uTop -= std::min( uTop, uPageHeight );
+      }
+      else if ( kc == KeyCombination( 'g' ) )
+      {
+        uTop = 0;
+      }
+      else if ( kc == KeyCombination( 'G' ) )
+      {
+        uTop = uMaxTop;
+      }
+    }
+  }
+
+  /// called on the i/o thread
+  void showLastPage( const size_t uHeight )
+  {
+    // show the last page, not just the last line
+    m_journal.seekToEof();
+    m_journal.seekLines( 1 - static_cast<int64_t>( uHeight ) );
+  }
+
+  /// waits for keyboard input or finished loads, handling changes of the journal in the meantime
+  ///
+  /// the journal is only watched while no load is in progress, as its handle is in use by the i/o thread otherwise
+  void waitForInput()
+  {
+    std::array<pollfd, 3> fds{ { { STDIN_FILENO, POLLIN, 0 }, { m_executor.notifyFd(), POLLIN, 0 }, { m_journalFd, 0, 0 } } };
+    nfds_t uNumFds = 2;
+    std::optional<std::chrono::milliseconds> timeout{};
+    const bool bLoading = m_executor.busy();
+    if ( bLoading )
+    {
+      // the indicator is shown once the load takes long enough
+      const auto untilIndicator = std::chrono::ceil<std::chrono::milliseconds>( m_loadingSince + LOADING_INDICATOR_DELAY - std::chrono::steady_clock::now() );
+      if ( untilIndicator.count() > 0 )
+      {
+        timeout = untilIndicator;
+      }
+    }
+    else if ( m_journalFd >= 0 )
+    {
+      fds[2].events = static_cast<short>( m_journal.journal().journal().getEvents() );
+      uNumFds = 3;
+      if ( const auto journalTimeout = m_journal.journal().journal().getTimeout() )
+      {
+        timeout = std::chrono::ceil<std::chrono::milliseconds>( *journalTimeout );
+      }
+    }
+    if ( !m_pTimelineBuilder->done() )
+    {
+      timeout = std::min<std::chrono::milliseconds>( timeout.value_or( TIMELINE_UPDATE_INTERVAL ), TIMELINE_UPDATE_INTERVAL );
+    }
+    if ( m_bJournalChanged )
+    {
+      const auto untilUpdate = std::chrono::ceil<std::chrono::milliseconds>( m_nextTailUpdate - std::chrono::steady_clock::now() );
+      timeout = std::min( timeout.value_or( untilUpdate ), std::max( untilUpdate, std::chrono::milliseconds{ 0 } ) );
+    }
+
+    ::poll( fds.data(), uNumFds, timeout ? static_cast<int>( timeout->count() ) : -1 );
+    updateTimeline();
+    m_executor.runCompletions();
+
+    if ( m_executor.busy() )
+    {
+      if ( bLoading )
+      {
+        displayOffset();
+        NcTerminal::update();
+      }
+      return;
+    }
+    if ( m_journalFd >= 0 && m_journal.journal().journal().process() )
+    {
+      m_bJournalChanged = true;
+    }
+    if ( m_bJournalChanged && std::chrono::steady_clock::now() >= m_nextTailUpdate )
+    {
+      updateTail();
+    }
+  }
+
+  /// reads the new entries of the journal on the i/o thread and redraws if they are on screen
+  void updateTail()
+  {
+    m_bJournalChanged = false;
+    m_nextTailUpdate = std::chrono::steady_clock::now() + TAIL_UPDATE_INTERVAL;
+
+    // unset if no entries were appended
+    const auto pFrame = std::make_shared<std::optional<Frame>>();
+    load(
+      IoExecutor::Mode::QUEUE,
+      [this, pFrame, bFollow = m_bFollow, uHeight = m_mainFrame.height()]( const std::stop_token& ) {
+        if ( m_journal.appendNewEntries( MAX_APPENDED_LINES ) == 0 )
+        {
+          return;
+        }
+        if ( bFollow )
+        {
+          showLastPage( uHeight );
+        }
+        *pFrame = readFrame( uHeight );
+      },
+      [this, pFrame] {
+        if ( !*pFrame )
+        {
+          return;
+        }
+        // appending invalidated the current lines, they are replaced even if nothing changes on screen
+        const size_t uPreviousNumLines = m_currentLines.size();
+        const auto previousFirst = m_currentLines.empty() ? std::nullopt : std::optional{ m_currentLines.front().seqid() };
+        const bool bChanged = ( *pFrame )->lines.size() != uPreviousNumLines ||
+          ( ( *pFrame )->lines.empty() ? std::nullopt : std::optional{ ( *pFrame )->lines.front().seqid() } ) != previousFirst;
+        m_currentLines = std::move( ( *pFrame )->lines );
+        m_bScanStopped = ( *pFrame )->bScanStopped;
+        if ( bChanged )
+        {
+          m_currentCursor = std::move( ( *pFrame )->sCursor );
+          redraw();
+        }
+      } );
   }
-  void displayOffset() { m_modeline.displayStatusString( "cursor: " + m_currentCursor ); }
 };
 
 }// namespace jess
\ No newline at end of file
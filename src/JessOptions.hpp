@@ -0,0 +1,301 @@
+#pragma once
+
+#include "ChunkedJournal.hpp"
+#include "JournalFilter.hpp"
+#include "TimeExpression.hpp"
+#include "TimestampFormatter.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jess
+{
+
+struct JessOptions {
+  ChunkCacheBudget cacheBudget{ 256 * 1024 * 1024, 0 };
+  // longer fields are truncated in the chunks, see SdJournal::setDataThreshold()
+  size_t dataThreshold{ 8 * 1024 };
+  JournalScope scope{};
+  // fields shown between the timestamp and the message
+  std::vector<std::string> columns{};
+  // only the matching entries are shown, see parseFilter()
+  JournalFilter filter{};
+  // only the entries whose message contains it are shown, all if empty; see the grep command
+  std::string grep{};
+  // the first entry shown, the last entry written by the dump
+  std::optional<std::chrono::system_clock::time_point> since{};
+  std::optional<std::chrono::system_clock::time_point> until{};
+  // write the entries to stdout instead of showing them
+  bool dump{};
+  TimestampFormat timestampFormat{};
+  bool follow{};
+  bool ignoreCase{};
+  // reopen at the position of the previous run and remember the position on exit
+  bool session{ true };
+  // show the entry density over time in the status line
+  bool timeline{ true };
+  // the statistics of the :stats command are written to this file on exit if set
+  std::string statsFile{};
+  bool showHelp{};
+};
+
+inline constexpr std::string_view USAGE = R"(usage: jess [OPTIONS]
+
+options:
+  --cache-size=SIZE     memory budget of the chunk cache in bytes, K/M/G suffixes are accepted (default: 256M, 0: unlimited)
+  --cache-chunks=N      maximum number of cached chunks (default: 0, unlimited)
+  --data-threshold=SIZE read at most SIZE bytes of each field, longer messages are marked with [+] and can be
+                        expanded with e; searches only see the part read (default: 8K, 0: unlimited)
+  --system              show the system journal (can be combined with --user)
+  --user                show the journal of the current user (can be combined with --system)
+  --local               show only journals of this host, no remote journals
+  -D, --directory=DIR   show the journal files in DIR instead of the journals of the host
+  --file=FILE           show the journal file FILE instead of the journals of the host, may be repeated
+  --columns=FIELDS      show the comma separated fields between the timestamp and the message, e.g. "_SYSTEMD_UNIT,_PID"
+  --filter=EXPRESSION   show only the entries matching the expression, see the filter command
+  --grep=TEXT           show only the entries whose message contains TEXT, see the grep command
+  --since=TIME          start at the first entry at or after TIME, see the goto command for the format
+  --dump                write the entries to stdout as they are shown instead of starting the viewer; messages are
+                        written in full, their continuation lines indented
+  --until=TIME          with --dump, stop after the last entry at or before TIME
+  --local-time          show timestamps in local time instead of UTC (toggle: t)
+  --usec                show timestamps with microseconds (toggle: u)
+  -i, --ignore-case     ignore the case of ASCII letters when searching and in the grep command
+  -f, --follow          start at the end of the journal and show new entries as they arrive (toggle: F)
+  --no-session          start at the beginning of the journal instead of the position of the previous run, and do
+                        not remember the position on exit (stored in $XDG_CACHE_HOME/jess/session)
+  --no-timeline         do not show the density of the entries over time in the status line (toggle: H); the strip
+                        spans the whole journal, '|' marks the top line and a trailing '~' shows it is being refined
+  --stats-file=FILE     write the statistics of the stats command to FILE on exit
+  -h, --help            show this help
+
+commands (entered after ':'):
+  columns [FIELDS]      show the comma separated fields between the timestamp and the message, none without FIELDS
+  expand                show the complete message of the entry at the top (key: e, q returns)
+  filter [EXPRESSION]   show only the entries matching all FIELD=value terms of the expression, e.g.
+                        "_SYSTEMD_UNIT=cron.service PRIORITY<=warning"; terms of the same field and groups separated
+                        by '+' are alternatives. Without an expression all entries are shown.
+  goto TIME             move to the first entry at or after TIME: "YYYY-MM-DD [HH:MM[:SS]]", "HH:MM[:SS]" (today),
+                        "now" or relative to now like "-15m", "-1h30m" or "-2d"; in the time zone of the timestamps
+  grep [TEXT]           show only the entries whose message contains TEXT, ignoring the case with -i; the messages are
+                        read one by one, a scan that finds no match in 100000 entries stops and continues on the
+                        next move. Without TEXT all entries are shown.
+  stats                 show counters of the chunk cache and the journal, and latencies of loading chunks and redrawing
+)";
+
+/// parses an unsigned number with an optional binary K/M/G suffix
+inline size_t parseSize( const std::string_view sValue )
+{
+  size_t uValue{};
+  const auto [pEnd, ec] = std::from_chars( sValue.data(), sValue.data() + sValue.size(), uValue );
+  if ( ec != std::errc{} || pEnd == sValue.data() )
+  {
+    throw std::invalid_argument{ "invalid size: " + std::string{ sValue } };
+  }
+
+  const std::string_view sSuffix = sValue.substr( pEnd - sValue.data() );
+  if ( sSuffix.empty() )
+  {
+    return uValue;
+  }
+  const auto shifted = [&]( const unsigned uShift ) {
+    if ( uValue > ( std::numeric_limits<size_t>::max() >> uShift ) )
+    {
+      throw std::invalid_argument{ "size too large: " + std::string{ sValue } };
+    }
+    return uValue << uShift;
+  };
+  if ( sSuffix == "K" || sSuffix == "k" )
+  {
+    return shifted( 10 );
+  }
+  if ( sSuffix == "M" )
+  {
+    return shifted( 20 );
+  }
+  if ( sSuffix == "G" )
+  {
+    return shifted( 30 );
+  }
+  throw std::invalid_argument{ "invalid size suffix: " + std::string{ sValue } };
+}
+
+/// parses a comma separated list of field names, an empty list results in no columns
+///
+/// throws std::invalid_argument if a name is not a valid journal field name
+inline std::vector<std::string> parseColumns( std::string_view sValue )
+{
+  std::vector<std::string> columns{};
+  while ( !sValue.empty() )
+  {
+    const size_t uSeparator = std::min( sValue.find( ',' ), sValue.size() );
+    const std::string_view sName = sValue.substr( 0, uSeparator );
+    if ( !detail::isValidFieldName( sName ) )
+    {
+      throw std::invalid_argument{ "invalid field name: " + std::string{ sName } };
+    }
+    columns.emplace_back( sName );
+    sValue.remove_prefix( std::min( uSeparator + 1, sValue.size() ) );
+  }
+  return columns;
+}
+
+/// parses the command line arguments (without the program name)
+///
+/// throws std::invalid_argument on unknown options or malformed values
+inline JessOptions parseArguments( const std::span<const char* const> arguments )
+{
+  JessOptions options{};
+  // the times are parsed once the time zone of the timestamps is known
+  std::optional<std::string_view> sSince{};
+  std::optional<std::string_view> sUntil{};
+
+  for ( size_t i = 0; i < arguments.size(); ++i )
+  {
+    const std::string_view sArgument{ arguments[i] };
+
+    // accepts both "--name=value" and "--name value"
+    const auto getValue = [&]( const std::string_view sName ) -> std::optional<std::string_view> {
+      if ( sArgument == sName )
+      {
+        if ( i + 1 >= arguments.size() )
+        {
+          throw std::invalid_argument{ std::string{ sName } + " requires a value" };
+        }
+        return std::string_view{ arguments[++i] };
+      }
+      if ( sArgument.starts_with( sName ) && sArgument.size() > sName.size() && sArgument[sName.size()] == '=' )
+      {
+        return sArgument.substr( sName.size() + 1 );
+      }
+      return std::nullopt;
+    };
+
+    if ( sArgument == "-h" || sArgument == "--help" )
+    {
+      options.showHelp = true;
+    }
+    else if ( sArgument == "-i" || sArgument == "--ignore-case" )
+    {
+      options.ignoreCase = true;
+    }
+    else if ( sArgument == "-f" || sArgument == "--follow" )
+    {
+      options.follow = true;
+    }
+    else if ( sArgument == "--no-session" )
+    {
+      options.session = false;
+    }
+    else if ( sArgument == "--dump" )
+    {
+      options.dump = true;
+    }
+    else if ( sArgument == "--no-timeline" )
+    {
+      options.timeline = false;
+    }
+    else if ( sArgument == "--local-time" )
+    {
+      options.timestampFormat.localTime = true;
+    }
+    else if ( sArgument == "--usec" )
+    {
+      options.timestampFormat.microseconds = true;
+    }
+    else if ( sArgument == "--system" )
+    {
+      options.scope.flags |= SD_JOURNAL_SYSTEM;
+    }
+    else if ( sArgument == "--user" )
+    {
+      options.scope.flags |= SD_JOURNAL_CURRENT_USER;
+    }
+    else if ( sArgument == "--local" )
+    {
+      options.scope.flags |= SD_JOURNAL_LOCAL_ONLY;
+    }
+    else if ( const auto sValue = getValue( sArgument == "-D" ? "-D" : "--directory" ) )
+    {
+      options.scope.directory = *sValue;
+    }
+    else if ( const auto sValue = getValue( "--file" ) )
+    {
+      options.scope.files.emplace_back( *sValue );
+    }
+    else if ( const auto sValue = getValue( "--columns" ) )
+    {
+      options.columns = parseColumns( *sValue );
+    }
+    else if ( const auto sValue = getValue( "--filter" ) )
+    {
+      options.filter = parseFilter( *sValue );
+    }
+    else if ( const auto sValue = getValue( "--grep" ) )
+    {
+      options.grep = *sValue;
+    }
+    else if ( const auto sValue = getValue( "--since" ) )
+    {
+      sSince = *sValue;
+    }
+    else if ( const auto sValue = getValue( "--until" ) )
+    {
+      sUntil = *sValue;
+    }
+    else if ( const auto sValue = getValue( "--stats-file" ) )
+    {
+      options.statsFile = *sValue;
+    }
+    else if ( const auto sValue = getValue( "--cache-size" ) )
+    {
+      options.cacheBudget.maxBytes = parseSize( *sValue );
+    }
+    else if ( const auto sValue = getValue( "--data-threshold" ) )
+    {
+      options.dataThreshold = parseSize( *sValue );
+    }
+    else if ( const auto sValue = getValue( "--cache-chunks" ) )
+    {
+      options.cacheBudget.maxChunks = parseSize( *sValue );
+    }
+    else
+    {
+      throw std::invalid_argument{ "unknown option: " + std::string{ sArgument } };
+    }
+  }
+
+  // sd_journal_open_directory() and sd_journal_open_files() do not take the flags of sd_journal_open()
+  const int numScopes = ( options.scope.flags != 0 ? 1 : 0 ) + ( options.scope.directory.empty() ? 0 : 1 ) + ( options.scope.files.empty() ? 0 : 1 );
+  if ( numScopes > 1 )
+  {
+    throw std::invalid_argument{ "--directory, --file and --system / --user / --local cannot be combined" };
+  }
+
+  const auto now = std::chrono::system_clock::now();
+  if ( sSince )
+  {
+    options.since = parseTimeExpression( *sSince, now, options.timestampFormat.localTime );
+  }
+  if ( sUntil )
+  {
+    if ( !options.dump )
+    {
+      throw std::invalid_argument{ "--until requires --dump" };
+    }
+    options.until = parseTimeExpression( *sUntil, now, options.timestampFormat.localTime );
+  }
+
+  return options;
+}
+
+}// namespace jess
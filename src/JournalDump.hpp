@@ -0,0 +1,270 @@
+#pragma once
+
+#include "CSeekableStream.hpp"
+#include "Chunk.hpp"
+#include "LineFormatter.hpp"
+#include "TimestampFormatter.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace jess
+{
+
+struct DumpOptions {
+  // the entries from the first one at or after since up to the last one at or before until
+  std::optional<std::chrono::system_clock::time_point> since{};
+  std::optional<std::chrono::system_clock::time_point> until{};
+  std::vector<std::string> columns{};
+  TimestampFormat timestampFormat{};
+};
+
+/// reads the entries of a journal in chunks on a worker thread with its own journal handle
+///
+/// the worker stays at most MAX_QUEUED_CHUNKS chunks ahead of the consumer, so reading the journal and formatting the
+/// entries overlap without buffering the whole journal
+template<SeekableStream TJournal>
+class ChunkStreamReader
+{
+public:
+  static constexpr size_t MAX_QUEUED_CHUNKS = 4;
+
+private:
+  size_t m_uChunkSize;
+  std::function<TJournal()> m_openJournal;
+  std::function<void( TJournal& )> m_configureJournal;
+  DumpOptions m_options;
+  ChunkArenaPool m_arenaPool{};
+  std::mutex m_mutex{};
+  std::condition_variable_any m_cv{};
+  std::deque<Chunk> m_chunks{};
+  bool m_bDone{};
+  // thrown by the worker, e.g. because the journal could not be opened, and rethrown by take()
+  std::exception_ptr m_pError{};
+  std::jthread m_worker;
+
+public:
+  /// the worker opens its journal with openJournal and applies configureJournal to it, e.g. to add the matches of a
+  /// filter
+  ChunkStreamReader( const size_t uChunkSize, std::function<TJournal()> openJournal, std::function<void( TJournal& )> configureJournal, DumpOptions options )
+    : m_uChunkSize( uChunkSize )
+    , m_openJournal( std::move( openJournal ) )
+    , m_configureJournal( std::move( configureJournal ) )
+    , m_options( std::move( options ) )
+    , m_worker( [this]( const std::stop_token& stopToken ) { run( stopToken ); } )
+  {
+  }
+
+  ChunkStreamReader( const ChunkStreamReader& ) = delete;
+  ChunkStreamReader& operator=( const ChunkStreamReader& ) = delete;
+
+  /// blocks until the next chunk is read, returns nothing after the last one
+  std::optional<Chunk> take()
+  {
+    std::unique_lock lock{ m_mutex };
+    m_cv.wait( lock, [&] { return !m_chunks.empty() || m_bDone; } );
+    if ( m_chunks.empty() )
+    {
+      if ( m_pError )
+      {
+        std::rethrow_exception( m_pError );
+      }
+      return std::nullopt;
+    }
+    Chunk chunk = std::move( m_chunks.front() );
+    m_chunks.pop_front();
+    lock.unlock();
+    m_cv.notify_all();
+    return chunk;
+  }
+
+  /// hands the storage of a consumed chunk back to the worker
+  void release( Chunk&& chunk ) { m_arenaPool.release( std::move( chunk.arena ) ); }
+
+private:
+  void run( const std::stop_token& stopToken )
+  {
+    try
+    {
+      read( stopToken );
+    }
+    catch ( ... )
+    {
+      std::scoped_lock lock{ m_mutex };
+      m_pError = std::current_exception();
+    }
+    {
+      std::scoped_lock lock{ m_mutex };
+      m_bDone = true;
+    }
+    m_cv.notify_all();
+  }
+
+  void read( const std::stop_token& stopToken )
+  {
+    // the journal is opened on the worker thread, the handle must never be shared with the consumer
+    TJournal journal = m_openJournal();
+    if ( m_configureJournal )
+    {
+      m_configureJournal( journal );
+    }
+
+    if ( m_options.since )
+    {
+      journal.seekToRealtime( *m_options.since );
+    }
+    else
+    {
+      journal.seekToBof();
+    }
+    if ( !journal.next() )
+    {
+      return;
+    }
+
+    while ( true )
+    {
+      Chunk chunk = readChunkForward( journal, m_arenaPool, m_uChunkSize, std::nullopt, m_options.columns );
+      // the consumer stops at the first line beyond until, later chunks are not needed
+      const bool bLast = chunk.isLastInJournal || ( m_options.until && chunk.maxRealtime > *m_options.until );
+      {
+        std::unique_lock lock{ m_mutex };
+        if ( !m_cv.wait( lock, stopToken, [&] { return m_chunks.size() < MAX_QUEUED_CHUNKS; } ) )
+        {
+          return;
+        }
+        m_chunks.push_back( std::move( chunk ) );
+      }
+      m_cv.notify_all();
+      if ( bLast )
+      {
+        return;
+      }
+    }
+  }
+};
+
+/// writes the entries of the journal in the time range of the options as formatted by LineFormatter
+///
+/// the text is handed to write in blocks of about uBlockSize bytes; write clears the block it was passed and returns
+/// false to stop the dump, e.g. because the reader of a pipe has gone away. Returns the number of entries written.
+template<SeekableStream TJournal, typename TWrite>
+size_t dumpJournal( std::function<TJournal()> openJournal, std::function<void( TJournal& )> configureJournal, const DumpOptions& options,
+  const size_t uBlockSize, TWrite&& write )
+{
+  static constexpr size_t CHUNK_SIZE = 4096;
+
+  ChunkStreamReader<TJournal> reader{ CHUNK_SIZE, std::move( openJournal ), std::move( configureJournal ), options };
+  LineFormatter formatter{ options.timestampFormat };
+  std::string sBlock{};
+  sBlock.reserve( uBlockSize + uBlockSize / 4 );
+  size_t uNumEntries{};
+
+  while ( auto chunk = reader.take() )
+  {
+    for ( size_t i = 0; i < chunk->size(); ++i )
+    {
+      const SdLine line = chunk->line( i );
+      if ( options.until && line.realtime() > *options.until )
+      {
+        write( sBlock );
+        return uNumEntries;
+      }
+      if ( !options.columns.empty() )
+      {
+        formatter.updateColumnWidths( { &line, 1 } );
+      }
+      formatter.append( sBlock, line );
+      ++uNumEntries;
+
+      if ( sBlock.size() >= uBlockSize && !write( sBlock ) )
+      {
+        return uNumEntries;
+      }
+    }
+    reader.release( std::move( *chunk ) );
+  }
+  write( sBlock );
+  return uNumEntries;
+}
+
+/// writes blocks of text to a file descriptor
+///
+/// pipes get bigger blocks and a bigger pipe buffer, so that the reader of the pipe is woken up less often; a
+/// terminal gets small blocks, so that the first entries show up right away
+class OutputWriter
+{
+public:
+  static constexpr size_t PIPE_BLOCK_SIZE = 1024 * 1024;
+  static constexpr size_t FILE_BLOCK_SIZE = 256 * 1024;
+  static constexpr size_t TERMINAL_BLOCK_SIZE = 16 * 1024;
+
+private:
+  int m_fd;
+  size_t m_uBlockSize{ FILE_BLOCK_SIZE };
+  // errno of the first failed write, 0 if none failed
+  int m_iError{};
+
+public:
+  explicit OutputWriter( const int fd )
+    : m_fd( fd )
+  {
+    struct stat status
+    {
+    };
+    if ( ::isatty( fd ) )
+    {
+      m_uBlockSize = TERMINAL_BLOCK_SIZE;
+    }
+    else if ( ::fstat( fd, &status ) == 0 && S_ISFIFO( status.st_mode ) )
+    {
+      m_uBlockSize = PIPE_BLOCK_SIZE;
+      // best effort, the size is capped by /proc/sys/fs/pipe-max-size
+      ::fcntl( fd, F_SETPIPE_SZ, static_cast<int>( PIPE_BLOCK_SIZE ) );
+    }
+  }
+
+  [[nodiscard]] size_t blockSize() const { return m_uBlockSize; }
+
+  /// errno of the failed write, e.g. EPIPE if the reader of the pipe has gone away
+  [[nodiscard]] int error() const { return m_iError; }
+
+  /// writes and clears the block, returns false if that fails
+  bool operator()( std::string& sBlock )
+  {
+    std::string_view sRemaining = sBlock;
+    while ( !sRemaining.empty() && m_iError == 0 )
+    {
+      const ssize_t iWritten = ::write( m_fd, sRemaining.data(), sRemaining.size() );
+      if ( iWritten < 0 && errno != EINTR )
+      {
+        m_iError = errno;
+      }
+      else if ( iWritten > 0 )
+      {
+        sRemaining.remove_prefix( static_cast<size_t>( iWritten ) );
+      }
+    }
+    sBlock.clear();
+    return m_iError == 0;
+  }
+};
+
+}// namespace jess
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jess
+{
+
+/// field matches evaluated by libsystemd, see sd_journal_add_match(3)
+///
+/// every group is a conjunction of "FIELD=value" matches, except that matches of the same field are alternatives.
+/// An entry passes the filter if it passes any of the groups.
+struct JournalFilter {
+  std::vector<std::vector<std::string>> groups{};
+
+  [[nodiscard]] bool empty() const { return groups.empty(); }
+
+  [[nodiscard]] std::string toString() const
+  {
+    std::string ret{};
+    for ( const auto& group : groups )
+    {
+      if ( !ret.empty() )
+      {
+        ret += " + ";
+      }
+      for ( size_t i = 0; i < group.size(); ++i )
+      {
+        ret += ( i == 0 ? "" : " " ) + group[i];
+      }
+    }
+    return ret;
+  }
+};
+
+namespace detail
+{
+
+constexpr std::array<std::string_view, 8> PRIORITY_NAMES{ "emerg", "alert", "crit", "err", "warning", "notice", "info", "debug" };
+
+/// journal field names consist of uppercase letters, digits and underscores and do not start with a digit
+constexpr bool isValidFieldName( const std::string_view sName )
+{
+  if ( sName.empty() || ( sName.front() >= '0' && sName.front() <= '9' ) )
+  {
+    return false;
+  }
+  for ( const char c : sName )
+  {
+    if ( !( ( c >= 'A' && c <= 'Z' ) || ( c >= '0' && c <= '9' ) || c == '_' ) )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// accepts the numeric priorities 0 to 7 and their syslog names
+inline int parsePriority( const std::string_view sValue )
+{
+  for ( size_t i = 0; i < PRIORITY_NAMES.size(); ++i )
+  {
+    if ( sValue == PRIORITY_NAMES[i] )
+    {
+      return static_cast<int>( i );
+    }
+  }
+
+  int priority{};
+  const auto [pEnd, ec] = std::from_chars( sValue.data(), sValue.data() + sValue.size(), priority );
+  if ( ec != std::errc{} || pEnd != sValue.data() + sValue.size() || priority < 0 || priority >= static_cast<int>( PRIORITY_NAMES.size() ) )
+  {
+    throw std::invalid_argument{ "invalid priority: " + std::string{ sValue } };
+  }
+  return priority;
+}
+
+}// namespace detail
+
+/// parses a filter expression like "_SYSTEMD_UNIT=a.service _SYSTEMD_UNIT=b.service PRIORITY<=err + SYSLOG_IDENTIFIER=c"
+///
+/// terms are separated by spaces, "+" separates alternative groups. PRIORITY<=N matches the priorities 0 to N, a
+/// PRIORITY match accepts the syslog names of the priorities as well. Throws std::invalid_argument on malformed terms.
+inline JournalFilter parseFilter( const std::string_view sExpression )
+{
+  JournalFilter filter{};
+  std::vector<std::string> group{};
+
+  const auto finishGroup = [&] {
+    if ( group.empty() )
+    {
+      throw std::invalid_argument{ "empty filter group" };
+    }
+    filter.groups.push_back( std::move( group ) );
+    group.clear();
+  };
+
+  size_t uPos = 0;
+  while ( true )
+  {
+    uPos = sExpression.find_first_not_of( ' ', uPos );
+    if ( uPos == std::string_view::npos )
+    {
+      break;
+    }
+    const size_t uEnd = std::min( sExpression.find( ' ', uPos ), sExpression.size() );
+    const std::string_view sTerm = sExpression.substr( uPos, uEnd - uPos );
+    uPos = uEnd;
+
+    if ( sTerm == "+" )
+    {
+      finishGroup();
+      continue;
+    }
+
+    if ( const size_t uLessEqual = sTerm.find( "<=" ); uLessEqual != std::string_view::npos )
+    {
+      if ( sTerm.substr( 0, uLessEqual ) != "PRIORITY" )
+      {
+        throw std::invalid_argument{ "<= is only supported for PRIORITY: " + std::string{ sTerm } };
+      }
+      const int maxPriority = detail::parsePriority( sTerm.substr( uLessEqual + 2 ) );
+      for ( int priority = 0; priority <= maxPriority; ++priority )
+      {
+        group.push_back( "PRIORITY=" + std::to_string( priority ) );
+      }
+      continue;
+    }
+
+    const size_t uEquals = sTerm.find( '=' );
+    if ( uEquals == std::string_view::npos || !detail::isValidFieldName( sTerm.substr( 0, uEquals ) ) )
+    {
+      throw std::invalid_argument{ "expected FIELD=value: " + std::string{ sTerm } };
+    }
+    if ( sTerm.substr( 0, uEquals ) == "PRIORITY" )
+    {
+      group.push_back( "PRIORITY=" + std::to_string( detail::parsePriority( sTerm.substr( uEquals + 1 ) ) ) );
+      continue;
+    }
+    group.emplace_back( sTerm );
+  }
+
+  if ( !group.empty() || !filter.groups.empty() )
+  {
+    finishGroup();
+  }
+  return filter;
+}
+
+/// replaces the matches of the journal with the filter
+template<typename TJournal>
+void applyFilter( TJournal& journal, const JournalFilter& filter )
+{
+  journal.flushMatches();
+  for ( size_t i = 0; i < filter.groups.size(); ++i )
+  {
+    if ( i > 0 )
+    {
+      journal.addDisjunction();
+    }
+    for ( const std::string& sMatch : filter.groups[i] )
+    {
+      journal.addMatch( sMatch );
+    }
+  }
+}
+
+}// namespace jess
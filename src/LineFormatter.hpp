@@ -0,0 +1,117 @@
+#pragma once
+
+#include "SdLine.hpp"
+#include "TimestampFormatter.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jess
+{
+
+/// formats lines as "TIMESTAMP COLUMN... MESSAGE", the columns padded to the longest value seen so far
+///
+/// the interactive view and the dump share the formatting, so that both show the same text
+class LineFormatter
+{
+public:
+  // columns are never wider, longer values are cut
+  static constexpr size_t MAX_COLUMN_WIDTH = 32;
+  // precedes messages that are cut at the data threshold
+  static constexpr std::string_view TRUNCATED_MARKER = "[+] ";
+
+private:
+  TimestampFormatter m_formatTimestamp;
+  // widths of the projected columns, they grow to the longest value seen so that the columns stay aligned
+  std::vector<size_t> m_columnWidths{};
+  std::string m_sPrefix{};
+
+public:
+  explicit LineFormatter( const TimestampFormat format = {} )
+    : m_formatTimestamp( format )
+  {
+  }
+
+  [[nodiscard]] TimestampFormat timestampFormat() const { return m_formatTimestamp.format(); }
+  void setTimestampFormat( const TimestampFormat format ) { m_formatTimestamp.setFormat( format ); }
+
+  /// the value of the column as shown, cut at the first line break and at MAX_COLUMN_WIDTH
+  static std::string_view columnValue( const SdLine& line, const size_t uIndex )
+  {
+    const std::string_view sValue = line.field( uIndex );
+    return sValue.substr( 0, std::min( sValue.find( '\n' ), MAX_COLUMN_WIDTH ) );
+  }
+
+  /// widens the columns to the values of the lines, returns true if a column got wider
+  bool updateColumnWidths( const std::span<const SdLine> lines )
+  {
+    bool bChanged = false;
+    for ( const SdLine& line : lines )
+    {
+      if ( line.fieldCount() > m_columnWidths.size() )
+      {
+        m_columnWidths.resize( line.fieldCount() );
+        bChanged = true;
+      }
+      for ( size_t i = 0; i < line.fieldCount(); ++i )
+      {
+        const size_t uWidth = columnValue( line, i ).size();
+        if ( uWidth > m_columnWidths[i] )
+        {
+          m_columnWidths[i] = uWidth;
+          bChanged = true;
+        }
+      }
+    }
+    return bChanged;
+  }
+
+  /// forgets the widths of the columns, e.g. because other fields are shown
+  void resetColumns() { m_columnWidths.clear(); }
+
+  /// the timestamp and the padded columns in front of the message, including the separating space
+  ///
+  /// the returned view refers to an internal buffer and is overwritten by the next call
+  std::string_view prefix( const SdLine& line )
+  {
+    m_sPrefix.assign( m_formatTimestamp( line.realtime() ) );
+    m_sPrefix.push_back( ' ' );
+    for ( size_t i = 0; i < line.fieldCount(); ++i )
+    {
+      const std::string_view sValue = columnValue( line, i );
+      m_sPrefix.append( sValue );
+      m_sPrefix.append( std::max( i < m_columnWidths.size() ? m_columnWidths[i] : 0, sValue.size() ) - sValue.size() + 1, ' ' );
+    }
+    return m_sPrefix;
+  }
+
+  /// appends the whole line and a line break to sOut
+  ///
+  /// unlike the rows of the interactive view, multi-line messages are not cut: their continuation lines are indented
+  /// to the column of the message
+  void append( std::string& sOut, const SdLine& line )
+  {
+    const size_t uIndent = prefix( line ).size();
+    sOut.append( m_sPrefix );
+    if ( line.truncated() )
+    {
+      sOut.append( TRUNCATED_MARKER );
+    }
+
+    std::string_view sMessage = line.message();
+    for ( size_t uLineEnd = sMessage.find( '\n' ); uLineEnd != std::string_view::npos; uLineEnd = sMessage.find( '\n' ) )
+    {
+      sOut.append( sMessage.substr( 0, uLineEnd + 1 ) );
+      sOut.append( uIndent, ' ' );
+      sMessage.remove_prefix( uLineEnd + 1 );
+    }
+    sOut.append( sMessage );
+    sOut.push_back( '\n' );
+  }
+};
+
+}// namespace jess
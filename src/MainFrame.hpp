@@ -1,36 +1,185 @@
 #pragma once
 
+#include "LineFormatter.hpp"
 #include "NcWindow.hpp"
+#include "SdLine.hpp"
+#include "TimestampFormatter.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
 #include <span>
+#include <string>
+#include <string_view>
 #include <vector>
 namespace jess {
 
+/// number of rows the view has been scrolled by from the previous to the current frame, positive towards the end
+///
+/// returns nothing if the frames do not share a run of rows, i.e. the view jumped
+inline std::optional<int64_t> scrollDelta(std::span<const SdSeqid> previous, std::span<const SdSeqid> current) {
+  if (previous.empty() || current.empty()) {
+    return std::nullopt;
+  }
+
+  const auto sharesRows = [](std::span<const SdSeqid> upper, std::span<const SdSeqid> lower, size_t uOffset) {
+    const size_t uOverlap = std::min(upper.size() - uOffset, lower.size());
+    return std::equal(upper.begin() + uOffset, upper.begin() + uOffset + uOverlap, lower.begin());
+  };
+
+  if (auto it = std::find(previous.begin(), previous.end(), current.front()); it != previous.end()) {
+    const size_t uOffset = std::distance(previous.begin(), it);
+    if (sharesRows(previous, current, uOffset)) {
+      return static_cast<int64_t>(uOffset);
+    }
+  }
+  if (auto it = std::find(current.begin(), current.end(), previous.front()); it != current.end()) {
+    const size_t uOffset = std::distance(current.begin(), it);
+    if (sharesRows(current, previous, uOffset)) {
+      return -static_cast<int64_t>(uOffset);
+    }
+  }
+  return std::nullopt;
+}
+
+/// splits the text into rows of at most uWidth columns at its line breaks, longer lines are wrapped
+///
+/// the columns are counted as the rows are drawn, see appendDisplayText()
+inline std::vector<std::string_view> wrapRows(std::string_view sText, size_t uWidth) {
+  std::vector<std::string_view> rows{};
+  uWidth = std::max<size_t>(uWidth, 1);
+  std::string sDisplay{};
+  while (true) {
+    const size_t uLineEnd = std::min(sText.find('\n'), sText.size());
+    std::string_view sLine = sText.substr(0, uLineEnd);
+    do {
+      sDisplay.clear();
+      // a tab wider than the row gets a row of its own, it is clipped when drawn
+      const size_t uLength = std::max<size_t>(appendDisplayText(sDisplay, sLine, 0, uWidth), std::min<size_t>(sLine.size(), 1));
+      rows.push_back(sLine.substr(0, uLength));
+      sLine.remove_prefix(uLength);
+    } while (!sLine.empty());
+
+    if (uLineEnd == sText.size()) {
+      return rows;
+    }
+    sText.remove_prefix(uLineEnd + 1);
+  }
+}
+
 class MainFrame {
   jess::NcWindow &m_rootWindow;
   jess::NcWindow m_mainWindow{m_rootWindow.height() - 1, m_rootWindow.width(), 0, 0};
+  // the rows show the same text as the dump
+  jess::LineFormatter m_formatter{};
+  // seqids of the rows on screen, used to only redraw the rows that changed
+  std::vector<SdSeqid> m_frame{};
+  std::vector<SdSeqid> m_nextFrame{};
 
 public:
-  explicit MainFrame(jess::NcWindow &rootWindow) : m_rootWindow(rootWindow) {}
+  explicit MainFrame(jess::NcWindow &rootWindow) : m_rootWindow(rootWindow) {
+    // lets ncurses scroll the terminal instead of resending the rows moved by scroll()
+    m_mainWindow.setInsertDeleteLine(true);
+  }
 
-  void drawLines(auto lines) {
-    auto it = std::begin(lines);
-    auto end = std::end(lines);
+  /// draws the lines into the window, scrolling the rows already on screen where possible
+  ///
+  /// the window is only marked for output, the terminal is updated by NcTerminal::update()
+  void drawLines(std::span<const SdLine> lines) {
+    const size_t windowHeight = m_mainWindow.height();
+    lines = lines.first(std::min(lines.size(), windowHeight));
+
+    m_nextFrame.clear();
+    std::transform(lines.begin(), lines.end(), std::back_inserter(m_nextFrame),
+                   [](const SdLine &line) { return line.seqid(); });
+    if (m_formatter.updateColumnWidths(lines)) {
+      invalidate();
+    }
+
+    // rows [uValidBegin, uValidEnd) already show the right lines after scrolling
+    size_t uValidBegin = 0;
+    size_t uValidEnd = 0;
+    const auto delta = scrollDelta(m_frame, m_nextFrame);
+    if (delta && static_cast<size_t>(std::abs(*delta)) < windowHeight) {
+      if (*delta != 0) {
+        m_mainWindow.scrollRows(static_cast<int>(*delta));
+      }
+      if (*delta >= 0) {
+        uValidEnd = std::min(m_frame.size() - *delta, lines.size());
+      } else {
+        uValidBegin = static_cast<size_t>(-*delta);
+        uValidEnd = std::min(m_frame.size() + uValidBegin, lines.size());
+      }
+    }
 
-    size_t windowHeight = m_mainWindow.height();
-    m_mainWindow.move(0, 0);
-    for (size_t i = 0; i < windowHeight && it != end; ++i, ++it) {
+    for (size_t i = 0; i < lines.size(); ++i) {
+      if (i < uValidBegin || i >= uValidEnd) {
+        drawRow(i, lines[i]);
+      }
+    }
+    if (lines.size() < windowHeight) {
+      m_mainWindow.move(lines.size(), 0);
+      m_mainWindow.clearToBot();
+    }
+
+    std::swap(m_frame, m_nextFrame);
+    m_mainWindow.noutrefresh();
+  }
+
+  /// draws the rows of a page of text, e.g. of a wrapped message, instead of lines of the journal
+  void drawPage(std::span<const std::string_view> rows) {
+    rows = rows.first(std::min(rows.size(), m_mainWindow.height()));
+    for (size_t i = 0; i < rows.size(); ++i) {
       m_mainWindow.move(i, 0);
-      m_mainWindow.printw("%s ", it->realtimeUtc().c_str());
-      m_mainWindow.printw("%s", it->message().c_str());
-      m_mainWindow.clearToEol();
+      if (m_mainWindow.addStringClipped(rows[i]) < m_mainWindow.width()) {
+        m_mainWindow.clearToEol();
+      }
     }
+    if (rows.size() < m_mainWindow.height()) {
+      m_mainWindow.move(rows.size(), 0);
+      m_mainWindow.clearToBot();
+    }
+    // the rows on screen no longer show the lines of the previous frame
+    invalidate();
+    m_mainWindow.noutrefresh();
+  }
 
-    m_mainWindow.clearToBot();
+  /// forces the next drawLines() to redraw every row, e.g. because the row contents changed
+  void invalidate() { m_frame.clear(); }
 
-    m_mainWindow.refresh();
+  /// forgets the widths of the columns, e.g. because other fields are shown
+  void resetColumns() {
+    m_formatter.resetColumns();
+    invalidate();
   }
 
   [[nodiscard]] size_t height() const { return m_mainWindow.height(); }
+  [[nodiscard]] size_t width() const { return m_mainWindow.width(); }
+
+  [[nodiscard]] TimestampFormat timestampFormat() const { return m_formatter.timestampFormat(); }
+  void setTimestampFormat(TimestampFormat format) {
+    m_formatter.setTimestampFormat(format);
+    invalidate();
+  }
+
+private:
+  void drawRow(size_t uRow, const SdLine &line) {
+    // multi-line messages are cut at the first line break, rows never wrap
+    const std::string_view sMessage = line.message().substr(0, line.message().find('\n'));
+
+    m_mainWindow.move(uRow, 0);
+    size_t uColumns = m_mainWindow.addStringClipped(m_formatter.prefix(line));
+    if (line.truncated()) {
+      // the message is cut at the data threshold, the complete message is shown by expanding the entry
+      m_mainWindow.enableAttributes(A_BOLD);
+      uColumns += m_mainWindow.addStringClipped(LineFormatter::TRUNCATED_MARKER);
+      m_mainWindow.disableAttributes(A_BOLD);
+    }
+    uColumns += m_mainWindow.addStringClipped(sMessage);
+    if (uColumns < m_mainWindow.width()) {
+      m_mainWindow.clearToEol();
+    }
+  }
 };
 
 } // namespace jess
@@ -19,47 +19,70 @@ public:
     m_cliWindow.setKeypad(true);
   }
 
-  std::optional<KeyCombination> getKeyCombination() {
-    KeyCombination ret{};
-
-    int in = m_cliWindow.getChar();
+  std::optional<KeyCombination> getKeyCombination() { return decodeKey(m_cliWindow.getChar()); }
 
-    // meta + <key> sequences are encoded as ESC + <key>
-    if (in == KEY_ESC) {
-      ret.bMeta = true;
-      in = m_cliWindow.getChar();
+  // returns nothing instead of waiting if there is no pending input
+  std::optional<KeyCombination> pollKeyCombination() {
+    m_cliWindow.setNodelay(true);
+    const int in = m_cliWindow.getChar();
+    m_cliWindow.setNodelay(false);
+    if (in == ERR) {
+      return std::nullopt;
     }
-
-    if ((in & KEY_CTRL) == KEY_CTRL) {
-      ret.bCtrl = true;
-      in ^= KEY_CTRL;
-    }
-
-    ret.key = static_cast<int>(in & 0xffffU);
-
-    return ret;
+    return decodeKey(in);
   }
-  void setActive() {
+
+  // reads a command line, without the leading ':'
+  std::string setActive() { return prompt(" :"); }
+  // reads a line of input after showing the prompt
+  std::string prompt(const std::string &sPrompt) {
     m_cliWindow.move(0, 0);
-    m_cliWindow.printw(" :");
+    m_cliWindow.printw("%s", sPrompt.c_str());
     m_cliWindow.clearToBot();
     jess::NcTerminal::echo();
-    m_cliWindow.getString();
+    std::string ret = m_cliWindow.getString().value_or("");
     m_cliWindow.move(0, 0);
     m_cliWindow.printw(":");
     m_cliWindow.clearToBot();
     jess::NcTerminal::noecho();
+    return ret;
   }
   void focus() {
     m_cliWindow.move(0, 1);
   }
-  void displayStatusString(const std::string &sStatus) {
+  // the terminal is updated by the next NcTerminal::update()
+  // sRight is aligned to the right edge and covers the end of a long status
+  void displayStatusString(const std::string &sStatus, std::string_view sRight = {}) {
     m_cliWindow.move(0, 0);
     m_cliWindow.enableAttributes(A_REVERSE);
     m_cliWindow.printw("%s", sStatus.c_str());
     m_cliWindow.disableAttributes(A_REVERSE);
     m_cliWindow.clearToBot();
-    m_cliWindow.refresh();
+    if (!sRight.empty() && sRight.size() < m_cliWindow.width()) {
+      m_cliWindow.move(0, m_cliWindow.width() - sRight.size() - 1);
+      m_cliWindow.addStringClipped(sRight);
+    }
+    m_cliWindow.noutrefresh();
+  }
+
+private:
+  KeyCombination decodeKey(int in) {
+    KeyCombination ret{};
+
+    // meta + <key> sequences are encoded as ESC + <key>
+    if (in == KEY_ESC) {
+      ret.bMeta = true;
+      in = m_cliWindow.getChar();
+    }
+
+    if ((in & KEY_CTRL) == KEY_CTRL) {
+      ret.bCtrl = true;
+      in ^= KEY_CTRL;
+    }
+
+    ret.key = static_cast<int>(in & 0xffffU);
+
+    return ret;
   }
 };
 } // namespace jess
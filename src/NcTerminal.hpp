@@ -21,6 +21,8 @@ public:
   static void nocbreak() { ::nocbreak(); }
   static void echo() { ::echo(); }
   static void noecho() { ::noecho(); }
+  /// sends the changes of all windows marked with noutrefresh() to the terminal at once
+  static void update() { NC_CHECK_RC(::doupdate()); }
 
   NcWindow rootWindow() { return NcWindow{stdscr}; }
 };
@@ -4,13 +4,75 @@
 
 #include <ncurses.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 #include <memory>
 #include <optional>
+#include <string>
+#include <string_view>
 
 namespace jess {
 
+/// the length of the ANSI control sequence at the beginning of the text, e.g. of the colour code "\x1b[31m"; 0 if
+/// there is none
+inline size_t controlSequenceLength(std::string_view sText) {
+  if (sText.size() < 2 || sText[0] != '\x1b' || sText[1] != '[') {
+    return 0;
+  }
+  for (size_t i = 2; i < sText.size(); ++i) {
+    const auto c = static_cast<unsigned char>(sText[i]);
+    if (c >= 0x40 && c <= 0x7e) {
+      return i + 1;
+    }
+    if (c < 0x20 || c > 0x3f) {
+      return 0;
+    }
+  }
+  return 0;
+}
+
+/// appends the text as it is shown from column uColumn on to sOut, as far as it fits before uEndColumn; returns the
+/// number of bytes of the text that fit
+///
+/// tabs are expanded up to the next tab stop and ANSI control sequences such as colour codes are dropped. Other
+/// control bytes and the bytes outside ASCII are replaced by their unctrl() form, e.g. "^G", like ncurses draws them.
+/// The result is printable ASCII, so its size is the number of columns it takes.
+inline size_t appendDisplayText(std::string &sOut, std::string_view sText, size_t uColumn, size_t uEndColumn) {
+  constexpr size_t TAB_WIDTH = 8;
+  size_t uPos = 0;
+  while (uPos < sText.size()) {
+    const auto c = static_cast<unsigned char>(sText[uPos]);
+    if (c >= 0x20 && c < 0x7f) {
+      if (uColumn + 1 > uEndColumn) {
+        break;
+      }
+      sOut += static_cast<char>(c);
+      ++uColumn;
+      ++uPos;
+    } else if (c == '\t') {
+      const size_t uSpaces = TAB_WIDTH - uColumn % TAB_WIDTH;
+      if (uColumn + uSpaces > uEndColumn) {
+        break;
+      }
+      sOut.append(uSpaces, ' ');
+      uColumn += uSpaces;
+      ++uPos;
+    } else if (const size_t uSequenceLength = controlSequenceLength(sText.substr(uPos))) {
+      uPos += uSequenceLength;
+    } else {
+      const std::string_view sControl = ::unctrl(c);
+      if (uColumn + sControl.size() > uEndColumn) {
+        break;
+      }
+      sOut += sControl;
+      uColumn += sControl.size();
+      ++uPos;
+    }
+  }
+  return uPos;
+}
+
 struct WindowDeleter {
   void operator()(WINDOW *ptr) { NC_CHECK_RC(delwin(ptr)); }
 };
@@ -37,6 +99,7 @@ public:
   [[nodiscard]] size_t cursorPosY() const { return getcury(handle.get()); }
   [[nodiscard]] size_t cursorPosX() const { return getcurx(handle.get()); }
   void setKeypad(bool bEnable) { NC_CHECK_RC(::keypad(handle.get(), bEnable)); }
+  void setInsertDeleteLine(bool bEnable) { NC_CHECK_RC(::idlok(handle.get(), bEnable)); }
   void move(size_t uPosY, size_t uPosX) { NC_CHECK_RC(::wmove(handle.get(), uPosY, uPosX)); }
 
 #pragma clang diagnostic push
@@ -46,6 +109,26 @@ public:
   }
 #pragma clang diagnostic pop
 
+  void addString(std::string_view sText) {
+    NC_CHECK_RC(::waddnstr(handle.get(), sText.data(), static_cast<int>(sText.size())));
+  }
+  /// writes as much of the text as fits into the current row without wrapping, returns the number of columns written
+  ///
+  /// the text is cleaned by appendDisplayText(), so that tabs and control bytes cannot spill into the next row
+  size_t addStringClipped(std::string_view sText) {
+    const size_t uAvailable = width() - cursorPosX();
+    std::string sDisplay{};
+    appendDisplayText(sDisplay, sText, cursorPosX(), width());
+    const size_t uLength = sDisplay.size();
+    const int result = ::waddnstr(handle.get(), sDisplay.data(), static_cast<int>(uLength));
+    // filling the last column of the last row fails to advance the cursor, the text is written nonetheless
+    const bool bLowerRightCorner = uLength == uAvailable && cursorPosY() + 1 == height();
+    if (!bLowerRightCorner) {
+      NC_CHECK_RC(result);
+    }
+    return uLength;
+  }
+
   void clear() { NC_CHECK_RC(::wclear(handle.get())); }
   void clearToEol() {
     //    if(cursorPosX() + 10 >= width()) {
@@ -55,6 +138,14 @@ public:
   }
   void clearToBot() { NC_CHECK_RC(::wclrtobot(handle.get())); }
   void refresh() { NC_CHECK_RC(::wrefresh(handle.get())); }
+  /// marks the window for output with the next NcTerminal::update()
+  void noutrefresh() { NC_CHECK_RC(::wnoutrefresh(handle.get())); }
+  /// scrolls the contents up by iRows rows (down if negative), the exposed rows are blank
+  void scrollRows(int iRows) {
+    NC_CHECK_RC(::scrollok(handle.get(), true));
+    NC_CHECK_RC(::wscrl(handle.get(), iRows));
+    NC_CHECK_RC(::scrollok(handle.get(), false));
+  }
   int getChar() { return ::wgetch(handle.get()); }
   std::optional<std::string> getString() {
     constexpr size_t uMaxSize = 1024;
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "KeyCombination.hpp"
+
+#include <ncurses.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+namespace jess
+{
+
+/// the number of lines a scroll key moves the view by, negative upwards; nothing for other keys
+inline std::optional<int64_t> scrollDistance( const KeyCombination& kc, const size_t uPageHeight )
+{
+  const auto iPage = static_cast<int64_t>( uPageHeight );
+  if ( kc == ctrl( 'p' ) || kc == KeyCombination( KEY_UP ) )
+  {
+    return -1;
+  }
+  if ( kc == ctrl( 'n' ) || kc == KeyCombination( KEY_DOWN ) )
+  {
+    return 1;
+  }
+  if ( kc == KeyCombination( 'b' ) || kc == meta( 'v' ) || kc == KeyCombination( KEY_PPAGE ) )
+  {
+    return -iPage;
+  }
+  if ( kc == KeyCombination( 'f' ) || kc == ctrl( 'v' ) || kc == KeyCombination( KEY_NPAGE ) )
+  {
+    return iPage;
+  }
+  return std::nullopt;
+}
+
+/// merges scroll keys that arrive faster than the view can be drawn, e.g. while a key is held down
+///
+/// the keys are added as they are read, their net distance is taken once per frame: right away if no more input is
+/// pending, otherwise once the frame interval has passed since the last frame was drawn. Holding a key scrolls at the
+/// frame rate, and releasing it leaves no queued keys behind.
+class ScrollCoalescer
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // about 60 frames per second
+  static constexpr Clock::duration DEFAULT_FRAME_INTERVAL = std::chrono::microseconds{ 16'667 };
+
+private:
+  Clock::duration m_frameInterval;
+  std::optional<int64_t> m_iPendingLines{};
+  Clock::time_point m_nextFrame{};
+  uint64_t m_uKeys{};
+  uint64_t m_uFrames{};
+
+public:
+  explicit ScrollCoalescer( const Clock::duration frameInterval = DEFAULT_FRAME_INTERVAL )
+    : m_frameInterval( frameInterval )
+  {
+  }
+
+  void add( const int64_t iLines )
+  {
+    m_iPendingLines = m_iPendingLines.value_or( 0 ) + iLines;
+    ++m_uKeys;
+  }
+
+  /// set if keys have been added since the last take()
+  [[nodiscard]] bool pending() const { return m_iPendingLines.has_value(); }
+
+  /// returns the net distance of the pending keys if they are to be drawn now, nothing otherwise
+  ///
+  /// bMoreInput tells whether further input is waiting to be read
+  std::optional<int64_t> take( const Clock::time_point now, const bool bMoreInput )
+  {
+    if ( !m_iPendingLines || ( bMoreInput && now < m_nextFrame ) )
+    {
+      return std::nullopt;
+    }
+    ++m_uFrames;
+    return std::exchange( m_iPendingLines, std::nullopt );
+  }
+
+  /// the distance taken last has been drawn, the next frame is due one frame interval later
+  void frameDrawn( const Clock::time_point now ) { m_nextFrame = now + m_frameInterval; }
+
+  [[nodiscard]] uint64_t keys() const { return m_uKeys; }
+  [[nodiscard]] uint64_t frames() const { return m_uFrames; }
+};
+
+}// namespace jess
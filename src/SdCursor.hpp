@@ -3,30 +3,61 @@
 #include "SdSeqid.hpp"
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
-#include <cstring>
-#include <iomanip>
-#include <iostream>
+#include <iosfwd>
 #include <stdexcept>
+#include <string>
 #include <string_view>
 
 namespace jess {
 
+namespace detail {
+
+inline constexpr uint8_t INVALID_NIBBLE = 0xff;
+
+/// value of every hex digit in either case, INVALID_NIBBLE for all other characters
+inline constexpr std::array<uint8_t, 256> HEX_NIBBLES = [] {
+  std::array<uint8_t, 256> nibbles{};
+  nibbles.fill(INVALID_NIBBLE);
+  for (uint8_t i = 0; i < 10; ++i) {
+    nibbles['0' + i] = i;
+  }
+  for (uint8_t i = 0; i < 6; ++i) {
+    nibbles['a' + i] = 10 + i;
+    nibbles['A' + i] = 10 + i;
+  }
+  return nibbles;
+}();
+
+inline constexpr std::string_view HEX_DIGITS = "0123456789abcdef";
+
+/// decodes the hex digits into bytes, sHex has two digits per byte; returns false if a character is no hex digit
+///
+/// the digits are looked up in a table and checked once at the end, the loop has no branches per character
+template <size_t uSize> constexpr bool decodeHex(std::string_view sHex, std::array<uint8_t, uSize> &bytes) {
+  uint8_t uInvalid = 0;
+  for (size_t i = 0; i < uSize; ++i) {
+    const uint8_t uHigh = HEX_NIBBLES[static_cast<uint8_t>(sHex[i * 2])];
+    const uint8_t uLow = HEX_NIBBLES[static_cast<uint8_t>(sHex[i * 2 + 1])];
+    uInvalid |= uHigh | uLow;
+    bytes[i] = static_cast<uint8_t>((uHigh << 4) | (uLow & 0x0f));
+  }
+  return (uInvalid & 0xf0) == 0;
+}
+
+} // namespace detail
+
+/// the parameter is kept for existing callers, digits of either case are accepted
 template <bool bUppercase> constexpr uint8_t hexCharToNibble(char c) {
-  constexpr char startOfAlphabet = bUppercase ? 'A' : 'a';
-  const bool bIsLetter = static_cast<bool>( c & ( 0b1 << 6 ) );
-  const uint8_t uRelativeOffset = c - '0';
-  return uRelativeOffset - bIsLetter * (startOfAlphabet - '0' - 10);
+  return detail::HEX_NIBBLES[static_cast<uint8_t>(c)];
 }
 
 template <bool bUppercase, size_t uSize>
 constexpr std::array<uint8_t, uSize> hexStringToByteArray(std::string_view sHexString) {
   std::array<uint8_t, uSize> ret{};
-  for (size_t i = 0; i < uSize; ++i) {
-    ret[i] =
-        (hexCharToNibble<bUppercase>(sHexString[i * 2 + 0]) << 4) | hexCharToNibble<bUppercase>(sHexString[i * 2 + 1]);
-  }
+  detail::decodeHex(sHexString, ret);
   return ret;
 }
 
@@ -35,6 +66,12 @@ std::ostream &operator<<(std::ostream &os, const std::array<uint8_t, 16> &data);
 std::ostream &operator<<(std::ostream &os, const SdCursor &that);
 
 struct SdCursor {
+  // "s=<32 digits>;i=<16>;b=<32>;m=<16>;t=<16>;x=<16>"
+  static constexpr size_t MAX_STRING_LENGTH = 6 * 3 - 1 + 2 * 32 + 4 * 16;
+  // the ids and the numbers back to back in the order of the string form, the numbers in little endian
+  static constexpr size_t BINARY_SIZE = 2 * 16 + 4 * 8;
+  using Binary = std::array<uint8_t, BINARY_SIZE>;
+
   SdSeqid seqid;
   std::array<uint8_t, 16> bootId;
   size_t timeMonotonic;
@@ -42,57 +79,179 @@ struct SdCursor {
   size_t someXor;
 
   [[nodiscard]] std::string toString() const {
-    std::stringstream ss{};
-    ss << *this;
-    return ss.str();
+    std::array<char, MAX_STRING_LENGTH> buffer;
+    return std::string(buffer.data(), format(buffer.data()));
+  }
+
+  /// writes the string form to pBuffer, which must have room for MAX_STRING_LENGTH characters; returns its length
+  size_t format(char *pBuffer) const {
+    char *p = pBuffer;
+    p = writeId(writeMarker(p, 's'), seqid.seqnumId.value);
+    p = writeNumber(writeMarker(p, 'i'), seqid.seqnum.value);
+    p = writeId(writeMarker(p, 'b'), bootId);
+    p = writeNumber(writeMarker(p, 'm'), timeMonotonic);
+    p = writeNumber(writeMarker(p, 't'), timeRealtime);
+    p = writeNumber(writeMarker(p, 'x'), someXor);
+    return static_cast<size_t>(p - pBuffer);
+  }
+
+  /// the fixed size form, a quarter of the size of the string form and cheap to compare and copy
+  [[nodiscard]] Binary toBinary() const {
+    Binary ret{};
+    uint8_t *p = ret.data();
+    p = std::copy(seqid.seqnumId.value.begin(), seqid.seqnumId.value.end(), p);
+    p = storeLittleEndian(p, seqid.seqnum.value);
+    p = std::copy(bootId.begin(), bootId.end(), p);
+    p = storeLittleEndian(p, timeMonotonic);
+    p = storeLittleEndian(p, timeRealtime);
+    storeLittleEndian(p, someXor);
+    return ret;
+  }
+
+  static SdCursor fromBinary(const Binary &binary) {
+    SdCursor ret{};
+    const uint8_t *p = binary.data();
+    std::copy(p, p + 16, ret.seqid.seqnumId.value.begin());
+    ret.seqid.seqnum.value = loadLittleEndian(p + 16);
+    std::copy(p + 24, p + 40, ret.bootId.begin());
+    ret.timeMonotonic = loadLittleEndian(p + 40);
+    ret.timeRealtime = loadLittleEndian(p + 48);
+    ret.someXor = loadLittleEndian(p + 56);
+    return ret;
   }
 
   bool operator==(const SdCursor &other) const { return seqid == other.seqid; }
 
   std::partial_ordering operator<=>(const SdCursor &other) const { return seqid <=> other.seqid; }
 
+  /// parses the string form in a single pass over the fields, in any order
+  ///
+  /// throws std::runtime_error if a field is missing or malformed; unknown fields are ignored
   static SdCursor fromString(std::string_view sCursor) {
-    using namespace std::string_view_literals;
     SdCursor ret{};
+    // one bit per field of FIELD_MARKERS
+    unsigned uFound = 0;
 
-    ret.seqid = {
-        {parse<std::array<uint8_t, 16>>(sCursor, "s=")},
-        {parse<std::size_t>(sCursor, "i=")},
-    };
-    ret.bootId = parse<std::array<uint8_t, 16>>(sCursor, "b=");
-    ret.timeMonotonic = parse<std::size_t>(sCursor, "m=");
-    ret.timeRealtime = parse<std::size_t>(sCursor, "t=");
-    ret.someXor = parse<std::size_t>(sCursor, "x=");
+    while (true) {
+      const size_t uFieldEnd = std::min(sCursor.find(';'), sCursor.size());
+      const std::string_view sField = sCursor.substr(0, uFieldEnd);
+      if (sField.size() >= 2 && sField[1] == '=') {
+        const std::string_view sValue = sField.substr(2);
+        switch (sField[0]) {
+        case 's':
+          ret.seqid.seqnumId.value = parseId(sValue, sField[0]);
+          uFound |= 1u << 0;
+          break;
+        case 'i':
+          ret.seqid.seqnum.value = parseNumber(sValue, sField[0]);
+          uFound |= 1u << 1;
+          break;
+        case 'b':
+          ret.bootId = parseId(sValue, sField[0]);
+          uFound |= 1u << 2;
+          break;
+        case 'm':
+          ret.timeMonotonic = parseNumber(sValue, sField[0]);
+          uFound |= 1u << 3;
+          break;
+        case 't':
+          ret.timeRealtime = parseNumber(sValue, sField[0]);
+          uFound |= 1u << 4;
+          break;
+        case 'x':
+          ret.someXor = parseNumber(sValue, sField[0]);
+          uFound |= 1u << 5;
+          break;
+        default:
+          break;
+        }
+      }
+      if (uFieldEnd == sCursor.size()) {
+        break;
+      }
+      sCursor.remove_prefix(uFieldEnd + 1);
+    }
 
+    if (uFound != (1u << FIELD_MARKERS.size()) - 1) {
+      const char marker = FIELD_MARKERS[static_cast<size_t>(std::countr_one(uFound))];
+      throw std::runtime_error{std::string{marker} + "= not found"};
+    }
     return ret;
   }
 
 private:
-  template <typename T> static T parse(std::string_view sCursorString, std::string_view sMarkerString) {
-    auto markerPos = sCursorString.find(sMarkerString);
-    if (markerPos != std::string_view::npos) {
-      auto fieldBeginningPos = markerPos + sMarkerString.size();
-      auto fieldEndPos = sCursorString.find(';', markerPos);
-      auto sUuid = sCursorString.substr(fieldBeginningPos, fieldEndPos - fieldBeginningPos);
-      if constexpr (std::is_same_v<T, std::array<uint8_t, 16>>) {
-        return uuid128StringToArray(sUuid);
-      }
-      if constexpr (std::is_same_v<T, size_t>) {
-        return stringToU64(sUuid);
-      }
+  static constexpr std::string_view FIELD_MARKERS = "sibmtx";
+
+  static std::array<uint8_t, 16> parseId(std::string_view sValue, char marker) {
+    std::array<uint8_t, 16> ret{};
+    if (sValue.size() != 32) {
+      throw std::runtime_error{std::string{marker} + "= expects a hex string with 32 characters"};
+    }
+    if (!detail::decodeHex(sValue, ret)) {
+      throw std::runtime_error{std::string{marker} + "= is not a hex string"};
+    }
+    return ret;
+  }
+
+  static uint64_t parseNumber(std::string_view sValue, char marker) {
+    if (sValue.empty() || sValue.size() > 16) {
+      throw std::runtime_error{std::string{marker} + "= expects a hex number with 1 to 16 digits"};
+    }
+    uint64_t ret = 0;
+    uint8_t uInvalid = 0;
+    for (const char c : sValue) {
+      const uint8_t uNibble = detail::HEX_NIBBLES[static_cast<uint8_t>(c)];
+      uInvalid |= uNibble;
+      ret = (ret << 4) | (uNibble & 0x0f);
     }
-    throw std::runtime_error{std::string{sMarkerString} + std::string{" not found"}};
+    if ((uInvalid & 0xf0) != 0) {
+      throw std::runtime_error{std::string{marker} + "= is not a hex number"};
+    }
+    return ret;
+  }
+
+  static char *writeMarker(char *p, char marker) {
+    // every field but the first is preceded by the separator
+    if (marker != FIELD_MARKERS.front()) {
+      *p++ = ';';
+    }
+    *p++ = marker;
+    *p++ = '=';
+    return p;
+  }
+
+  static char *writeId(char *p, const std::array<uint8_t, 16> &id) {
+    for (const uint8_t uByte : id) {
+      *p++ = detail::HEX_DIGITS[uByte >> 4];
+      *p++ = detail::HEX_DIGITS[uByte & 0x0f];
+    }
+    return p;
   }
 
-  static std::array<uint8_t, 16> uuid128StringToArray(std::string_view sUuid) {
-    if (sUuid.size() != 32) {
-      throw std::runtime_error{"expected hex string with 32 characters"};
+  /// lowercase hex without leading zeros, like journald writes it
+  static char *writeNumber(char *p, uint64_t uValue) {
+    const size_t uNumDigits = std::max<size_t>((std::bit_width(uValue) + 3) / 4, 1);
+    for (size_t i = uNumDigits; i > 0; --i) {
+      p[i - 1] = detail::HEX_DIGITS[uValue & 0x0f];
+      uValue >>= 4;
     }
+    return p + uNumDigits;
+  }
 
-    return hexStringToByteArray<false, 16>(sUuid);
+  static uint8_t *storeLittleEndian(uint8_t *p, uint64_t uValue) {
+    for (size_t i = 0; i < 8; ++i) {
+      *p++ = static_cast<uint8_t>(uValue >> (8 * i));
+    }
+    return p;
   }
 
-  static size_t stringToU64(std::string_view sNumber) { return std::strtoull(sNumber.cbegin(), nullptr, 16); }
+  static uint64_t loadLittleEndian(const uint8_t *p) {
+    uint64_t uValue = 0;
+    for (size_t i = 0; i < 8; ++i) {
+      uValue |= static_cast<uint64_t>(p[i]) << (8 * i);
+    }
+    return uValue;
+  }
 };
 
 } // namespace jess
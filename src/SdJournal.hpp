@@ -5,12 +5,63 @@
 #include "SdLine.hpp"
 #include <systemd/sd-journal.h>
 #include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <limits>
 #include <map>
 #include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace jess
 {
 
+struct SdError : std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+/// the journal files to open, all journals of the host by default
+///
+/// opening only the files of interest saves mapping and seeking over all others, which matters on hosts with
+/// thousands of archived or remote journal files
+struct JournalScope {
+  // SD_JOURNAL_LOCAL_ONLY, SD_JOURNAL_SYSTEM and SD_JOURNAL_CURRENT_USER, see sd_journal_open(3)
+  int flags{};
+  // if set, the journal files in this directory are opened instead
+  std::string directory{};
+  // if set, exactly these journal files are opened instead
+  std::vector<std::string> files{};
+};
+
+namespace detail
+{
+
+/// the longest prefix of the text that does not end in an incomplete UTF-8 sequence
+inline std::string_view cutToCharacterBoundary( const std::string_view sText )
+{
+  size_t uLeadByte = sText.size();
+  while ( uLeadByte > 0 && ( static_cast<unsigned char>( sText[uLeadByte - 1] ) & 0xC0 ) == 0x80 )
+  {
+    --uLeadByte;
+  }
+  if ( uLeadByte == 0 )
+  {
+    return sText;
+  }
+
+  const auto lead = static_cast<unsigned char>( sText[uLeadByte - 1] );
+  const size_t uSequenceLength = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+  return sText.size() - ( uLeadByte - 1 ) < uSequenceLength ? sText.substr( 0, uLeadByte - 1 ) : sText;
+}
+
+}// namespace detail
+
 struct JournalDeleter {
   void operator()( sd_journal* ptr ) { sd_journal_close( ptr ); }
 };
@@ -18,71 +69,193 @@ struct JournalDeleter {
 class SdJournal
 {
   std::unique_ptr<sd_journal, JournalDeleter> handle{};
+  // 0 if the data is not capped
+  size_t m_uDataThreshold{};
+  std::atomic<uint64_t>* m_pCallCounter{};
 
 public:
-  explicit SdJournal()
+  explicit SdJournal( const JournalScope& scope = {} )
   {
     sd_journal* pJournal{};
-    sd_journal_open( &pJournal, 0 );
+    int iResult{};
+    if ( !scope.directory.empty() )
+    {
+      iResult = sd_journal_open_directory( &pJournal, scope.directory.c_str(), 0 );
+    }
+    else if ( !scope.files.empty() )
+    {
+      std::vector<const char*> paths{};
+      std::transform( scope.files.begin(), scope.files.end(), std::back_inserter( paths ), []( const std::string& sPath ) { return sPath.c_str(); } );
+      paths.push_back( nullptr );
+      iResult = sd_journal_open_files( &pJournal, paths.data(), 0 );
+    }
+    else
+    {
+      iResult = sd_journal_open( &pJournal, scope.flags );
+    }
+
+    if ( iResult < 0 )
+    {
+      throw SdError{ "cannot open the journal: " + std::string{ std::strerror( -iResult ) } };
+    }
     handle.reset( pJournal );
   };
 
+  /// counts every call into libsystemd on pCounter, which may be shared by the journals of several threads
+  void setCallCounter( std::atomic<uint64_t>* pCounter ) { m_pCallCounter = pCounter; }
+
   [[nodiscard]] SdCursor getCursor()
   {
     char* cursor;
-    sd_journal_get_cursor( handle.get(), &cursor );
+    sd_journal_get_cursor( counted(), &cursor );
     auto ret = SdCursor::fromString( cursor );
     free( cursor );
     return ret;
   }
 
-  void seekToCursor( const std::string& sCursor ) { sd_journal_seek_cursor( handle.get(), sCursor.c_str() ); }
+  void seekToCursor( const std::string& sCursor ) { sd_journal_seek_cursor( counted(), sCursor.c_str() ); }
 
-  void seekToBof() { sd_journal_seek_head( handle.get() ); }
+  void seekToRealtime( const std::chrono::time_point<std::chrono::system_clock> realtime )
+  {
+    const auto uUsec = std::chrono::duration_cast<std::chrono::microseconds>( realtime.time_since_epoch() ).count();
+    sd_journal_seek_realtime_usec( counted(), static_cast<uint64_t>( std::max<int64_t>( uUsec, 0 ) ) );
+  }
 
-  void seekToEof() { sd_journal_seek_tail( handle.get() ); }
+  void seekToBof() { sd_journal_seek_head( counted() ); }
 
-  void seekLinesBackward( size_t uNumLines ) { sd_journal_previous_skip( handle.get(), uNumLines ); }
+  void seekToEof() { sd_journal_seek_tail( counted() ); }
 
-  void seekLinesForward( size_t uNumLines ) { sd_journal_next_skip( handle.get(), uNumLines ); }
+  void seekLinesBackward( size_t uNumLines ) { sd_journal_previous_skip( counted(), uNumLines ); }
 
-  bool next() { return sd_journal_next( handle.get() ) > 0; }
+  void seekLinesForward( size_t uNumLines ) { sd_journal_next_skip( counted(), uNumLines ); }
 
-  bool previous() { return sd_journal_previous( handle.get() ) > 0; }
+  bool next() { return sd_journal_next( counted() ) > 0; }
 
-  std::string_view getFieldString( std::string_view sFieldName )
+  bool previous() { return sd_journal_previous( counted() ) > 0; }
+
+  /// caps the data read from the entries at uBytes per field including the field name, 0 for no limit
+  ///
+  /// libsystemd only uses the threshold to stop decompressing early and returns uncompressed data in full, so the data
+  /// is cut here as well. This keeps huge messages like core dumps from being copied into the chunks in full.
+  void setDataThreshold( const size_t uBytes )
   {
-    const void* ptr = nullptr;
-    size_t uMessageLength{};
-    sd_journal_get_data( handle.get(), sFieldName.data(), reinterpret_cast<const void**>( &ptr ), &uMessageLength );
-    std::string_view ret{ static_cast<const char*>( ptr ), uMessageLength };
+    m_uDataThreshold = uBytes;
+    sd_journal_set_data_threshold( counted(), uBytes );
+  }
+
+  /// value of the field of the current entry, empty if the entry does not have it
+  ///
+  /// the name must be NUL-terminated. The value refers to the data of the entry and is invalidated by reading another
+  /// field or moving the journal.
+  std::string_view getFieldString( std::string_view sFieldName ) { return getField( sFieldName ).first; }
 
-    if ( ret.size() >= sFieldName.size() + 1 )
+  /// reads the complete message of the entry at the cursor, regardless of the data threshold
+  ///
+  /// the journal is moved. Returns nothing if the entry is gone, e.g. because its journal file was rotated away.
+  std::optional<std::string> readFullMessage( const SdCursor& cursor )
+  {
+    const size_t uDataThreshold = m_uDataThreshold;
+    setDataThreshold( 0 );
+    seekToCursor( cursor.toString() );
+    std::optional<std::string> ret{};
+    if ( next() && getSeqid() == cursor.seqid )
     {
-      return ret.substr( sFieldName.size() + 1 );
+      ret.emplace( getFieldString( "MESSAGE" ) );
     }
-
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "LocalValueEscapesScope"
+    setDataThreshold( uDataThreshold );
     return ret;
-#pragma clang diagnostic pop
   }
 
   std::chrono::time_point<std::chrono::system_clock> getTimestampRealtime()
   {
     uint64_t ret;
-    sd_journal_get_realtime_usec( handle.get(), &ret );
+    sd_journal_get_realtime_usec( counted(), &ret );
     return std::chrono::time_point<std::chrono::system_clock>{ std::chrono::microseconds{ ret } };
   }
 
   [[nodiscard]] SdSeqid getSeqid() const
   {
     SdSeqid seqid{};
-    sd_journal_get_seqnum( handle.get(), &seqid.seqnum.value, reinterpret_cast<sd_id128_t*>( &seqid.seqnumId.value ) );
+    sd_journal_get_seqnum( counted(), &seqid.seqnum.value, reinterpret_cast<sd_id128_t*>( &seqid.seqnumId.value ) );
     return seqid;
   }
 
-  SdLine getLine() { return SdLine{ getSeqid(), std::string{ getFieldString( "MESSAGE" ) }, getTimestampRealtime() }; }
+  /// restricts the entries to those with the "FIELD=value" data, see sd_journal_add_match(3)
+  ///
+  /// the matches take effect with the next seek, they are looked up in the entry arrays of the journal files
+  void addMatch( std::string_view sMatch )
+  {
+    if ( sd_journal_add_match( counted(), sMatch.data(), sMatch.size() ) < 0 )
+    {
+      throw std::invalid_argument{ "invalid journal match: " + std::string{ sMatch } };
+    }
+  }
+
+  /// the matches added afterwards are an alternative to the ones added before
+  void addDisjunction() { sd_journal_add_disjunction( counted() ); }
+
+  void flushMatches() { sd_journal_flush_matches( counted() ); }
+
+  /// file descriptor to poll for changes with the events of getEvents(), negative if changes cannot be watched
+  int getFd() { return sd_journal_get_fd( counted() ); }
+
+  int getEvents() { return sd_journal_get_events( counted() ); }
+
+  /// the longest time to poll before calling process(), nothing if there is no limit
+  std::optional<std::chrono::microseconds> getTimeout()
+  {
+    uint64_t uTimeout{};
+    if ( sd_journal_get_timeout( counted(), &uTimeout ) < 0 || uTimeout == std::numeric_limits<uint64_t>::max() )
+    {
+      return std::nullopt;
+    }
+    // the timeout is absolute on CLOCK_MONOTONIC
+    const auto now = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() );
+    return std::max( std::chrono::microseconds{ uTimeout } - now, std::chrono::microseconds{ 0 } );
+  }
+
+  /// processes the pending change notifications, returns true if entries may have been added or removed
+  bool process() { return sd_journal_process( counted() ) > SD_JOURNAL_NOP; }
+
+  // the message refers to the data of the current entry and is invalidated by moving the journal
+  SdLine getLine()
+  {
+    // reading a field may invalidate the data of the previous one, so the priority is read before the message
+    const std::string_view sPriority = getField( "PRIORITY" ).first;
+    const uint8_t uPriority = sPriority.size() == 1 && sPriority[0] >= '0' && sPriority[0] <= '7' ? static_cast<uint8_t>( sPriority[0] - '0' ) : SdLine::NO_PRIORITY;
+    const auto [sMessage, bTruncated] = getField( "MESSAGE" );
+    return SdLine{ getSeqid(), sMessage, getTimestampRealtime(), bTruncated, nullptr, {}, uPriority };
+  }
+
+private:
+  sd_journal* counted() const
+  {
+    if ( m_pCallCounter )
+    {
+      m_pCallCounter->fetch_add( 1, std::memory_order_relaxed );
+    }
+    return handle.get();
+  }
+
+  /// the value of the field and whether it was cut at the data threshold
+  std::pair<std::string_view, bool> getField( std::string_view sFieldName )
+  {
+    const void* ptr = nullptr;
+    size_t uDataLength{};
+    if ( sd_journal_get_data( counted(), sFieldName.data(), &ptr, &uDataLength ) < 0 || uDataLength < sFieldName.size() + 1 )
+    {
+      return { std::string_view{}, false };
+    }
+
+    std::string_view sData{ static_cast<const char*>( ptr ), uDataLength };
+    // data of exactly the threshold size may have been cut while decompressing, it is marked as truncated as well
+    const bool bTruncated = m_uDataThreshold != 0 && sData.size() >= m_uDataThreshold;
+    if ( bTruncated )
+    {
+      sData = detail::cutToCharacterBoundary( sData.substr( 0, std::max( m_uDataThreshold, sFieldName.size() + 1 ) ) );
+    }
+    return { sData.substr( std::min( sFieldName.size() + 1, sData.size() ) ), bTruncated };
+  }
 };
 
 static_assert( SeekableStream<SdJournal> );
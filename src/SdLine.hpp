@@ -3,38 +3,64 @@
 #include "SdSeqid.hpp"
 
 #include <chrono>
-#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
 #include <utility>
-#include <iosfwd>
 
 
 namespace jess
 {
+/// location of a field value in the storage of a chunk
+struct FieldRef {
+  uint32_t offset;
+  uint32_t length;
+};
+
+/// a journal entry
+///
+/// the message is not owned by the line, it is only valid as long as the storage it was taken from (the current entry
+/// of a journal or the arena of a chunk) is not modified. Lines taken from a chunk also carry the values of the
+/// projected columns of the chunk, see Chunk::line().
+/// Messages longer than the data threshold of the journal are truncated, see SdJournal::setDataThreshold().
 class SdLine
 {
 public:
-  explicit SdLine( SdSeqid seqid, std::string sMessage, std::chrono::time_point<std::chrono::system_clock> timestampRealtime )
+  // priority of entries without a valid PRIORITY field, less severe than all syslog priorities
+  static constexpr uint8_t NO_PRIORITY = 0xff;
+
+  explicit SdLine( SdSeqid seqid, std::string_view sMessage, std::chrono::time_point<std::chrono::system_clock> timestampRealtime,
+    bool bTruncated = false, const char* pFieldData = nullptr, std::span<const FieldRef> fields = {}, uint8_t uPriority = NO_PRIORITY )
     : m_seqid( seqid )
-    , sMessage( std::move( sMessage ) )
+    , sMessage( sMessage )
     , timestampRealtime( timestampRealtime )
+    , m_bTruncated( bTruncated )
+    , m_uPriority( uPriority )
+    , m_pFieldData( pFieldData )
+    , m_fields( fields )
   {
   }
 
   [[nodiscard]] SdSeqid seqid() const { return m_seqid; }
-  [[nodiscard]] std::string message() const { return sMessage; }
+  [[nodiscard]] std::string_view message() const { return sMessage; }
   [[nodiscard]] std::chrono::time_point<std::chrono::system_clock> realtime() const { return timestampRealtime; }
-  [[nodiscard]] std::string realtimeUtc() const
-  {
-    auto time_t_ = std::chrono::system_clock::to_time_t( timestampRealtime );
-    std::tm tm_ = *std::gmtime( &time_t_ );
-    std::stringstream ss{};
-    ss << std::put_time( &tm_, "%Y-%m-%d %H:%M:%S" );
-    return ss.str();
-  }
+  /// set if the message is only the beginning of the message of the entry
+  [[nodiscard]] bool truncated() const { return m_bTruncated; }
+  /// the syslog priority, 0 (emerg) to 7 (debug), or NO_PRIORITY
+  [[nodiscard]] uint8_t priority() const { return m_uPriority; }
+
+  [[nodiscard]] size_t fieldCount() const { return m_fields.size(); }
+  /// value of the uIndex-th projected column, empty if the entry does not have the field
+  [[nodiscard]] std::string_view field( const size_t uIndex ) const { return { m_pFieldData + m_fields[uIndex].offset, m_fields[uIndex].length }; }
 
 private:
   SdSeqid m_seqid;
-  std::string sMessage;
+  std::string_view sMessage;
   std::chrono::time_point<std::chrono::system_clock> timestampRealtime;
+  bool m_bTruncated;
+  uint8_t m_uPriority;
+  const char* m_pFieldData;
+  std::span<const FieldRef> m_fields;
 };
 }// namespace jess
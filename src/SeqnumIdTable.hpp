@@ -0,0 +1,99 @@
+#pragma once
+
+#include "SdSeqid.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+
+namespace jess
+{
+
+/// interns the seqnum ids of the journal as small integers, so that cached lines and chunk ranges can refer to them
+/// with 4 instead of 16 bytes
+///
+/// a journal usually has a handful of seqnum ids, one per journal writer and one more for every remote host. Ids are
+/// never removed. Looking ids up is lock-free; interning a new id takes a lock, which only happens for the first line
+/// of every seqnum id. The ids live in blocks that never move, so a reference returned by id() stays valid.
+class SeqnumIdTable
+{
+public:
+  static constexpr size_t BLOCK_SIZE = 256;
+  static constexpr size_t MAX_BLOCKS = 1024;
+
+private:
+  using Block = std::array<SdSeqnumId, BLOCK_SIZE>;
+
+  std::mutex m_mutex{};
+  std::array<std::unique_ptr<Block>, MAX_BLOCKS> m_blocks{};
+  // the ids below the count are complete, published with release semantics after they are written
+  std::atomic<size_t> m_uCount{};
+
+public:
+  /// the table shared by all journals and threads of the process
+  static SeqnumIdTable& global()
+  {
+    static SeqnumIdTable table{};
+    return table;
+  }
+
+  /// returns the index of the id, nothing if it has not been interned
+  [[nodiscard]] std::optional<uint32_t> find( const SdSeqnumId& seqnumId ) const { return findBelow( seqnumId, m_uCount.load( std::memory_order_acquire ) ); }
+
+  /// returns the index of the id, adding it if it is new
+  ///
+  /// throws std::length_error if the table is full, i.e. after BLOCK_SIZE * MAX_BLOCKS distinct ids
+  uint32_t intern( const SdSeqnumId& seqnumId )
+  {
+    if ( const auto uIndex = find( seqnumId ) )
+    {
+      return *uIndex;
+    }
+
+    std::scoped_lock lock{ m_mutex };
+    const size_t uCount = m_uCount.load( std::memory_order_relaxed );
+    // another thread may have added it in the meantime
+    if ( const auto uIndex = findBelow( seqnumId, uCount ) )
+    {
+      return *uIndex;
+    }
+    if ( uCount == BLOCK_SIZE * MAX_BLOCKS )
+    {
+      throw std::length_error{ "too many seqnum ids" };
+    }
+
+    std::unique_ptr<Block>& pBlock = m_blocks[uCount / BLOCK_SIZE];
+    if ( !pBlock )
+    {
+      pBlock = std::make_unique<Block>();
+    }
+    ( *pBlock )[uCount % BLOCK_SIZE] = seqnumId;
+    m_uCount.store( uCount + 1, std::memory_order_release );
+    return static_cast<uint32_t>( uCount );
+  }
+
+  /// the id of an index returned by intern()
+  [[nodiscard]] const SdSeqnumId& id( const uint32_t uIndex ) const { return ( *m_blocks[uIndex / BLOCK_SIZE] )[uIndex % BLOCK_SIZE]; }
+
+  [[nodiscard]] size_t size() const { return m_uCount.load( std::memory_order_acquire ); }
+
+private:
+  [[nodiscard]] std::optional<uint32_t> findBelow( const SdSeqnumId& seqnumId, const size_t uCount ) const
+  {
+    for ( size_t i = 0; i < uCount; ++i )
+    {
+      if ( ( *m_blocks[i / BLOCK_SIZE] )[i % BLOCK_SIZE] == seqnumId )
+      {
+        return static_cast<uint32_t>( i );
+      }
+    }
+    return std::nullopt;
+  }
+};
+
+}// namespace jess
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "ChunkedJournal.hpp"
+#include "SdCursor.hpp"
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace jess
+{
+
+/// state kept from one run of jess to the next
+struct Session {
+  std::optional<JournalPosition> position{};
+};
+
+/// $XDG_CACHE_HOME/jess/session, or ~/.cache/jess/session if XDG_CACHE_HOME is not set
+///
+/// returns an empty path if neither XDG_CACHE_HOME nor HOME is set
+inline std::filesystem::path defaultSessionPath()
+{
+  if ( const char* sCacheHome = std::getenv( "XDG_CACHE_HOME" ); sCacheHome && *sCacheHome == '/' )
+  {
+    return std::filesystem::path{ sCacheHome } / "jess" / "session";
+  }
+  if ( const char* sHome = std::getenv( "HOME" ); sHome && *sHome != '\0' )
+  {
+    return std::filesystem::path{ sHome } / ".cache" / "jess" / "session";
+  }
+  return {};
+}
+
+/// reads a session written by writeSession()
+///
+/// the session is only a convenience, a missing or malformed file results in an empty session
+inline Session readSession( const std::filesystem::path& path )
+{
+  std::ifstream file{ path };
+  std::optional<SdCursor> line{};
+  std::optional<SdCursor> chunkStart{};
+
+  std::string sLine{};
+  while ( std::getline( file, sLine ) )
+  {
+    const std::string_view sEntry{ sLine };
+    const size_t uSeparator = sEntry.find( ' ' );
+    if ( uSeparator == std::string_view::npos )
+    {
+      continue;
+    }
+
+    const std::string_view sKey = sEntry.substr( 0, uSeparator );
+    try
+    {
+      if ( sKey == "position" )
+      {
+        line = SdCursor::fromString( sEntry.substr( uSeparator + 1 ) );
+      }
+      else if ( sKey == "chunk" )
+      {
+        chunkStart = SdCursor::fromString( sEntry.substr( uSeparator + 1 ) );
+      }
+    }
+    catch ( const std::runtime_error& )
+    {
+      return {};
+    }
+  }
+
+  if ( !line || !chunkStart )
+  {
+    return {};
+  }
+  return Session{ JournalPosition{ *line, *chunkStart } };
+}
+
+/// writes the session, creating the directory if necessary; returns false on failure
+///
+/// the file is replaced atomically, so that two instances of jess exiting at the same time never leave a mix of both
+inline bool writeSession( const std::filesystem::path& path, const Session& session )
+{
+  std::error_code error{};
+  std::filesystem::create_directories( path.parent_path(), error );
+  if ( error )
+  {
+    return false;
+  }
+
+  std::filesystem::path temporaryPath = path;
+  temporaryPath += ".tmp" + std::to_string( ::getpid() );
+  {
+    std::ofstream file{ temporaryPath, std::ios::trunc };
+    if ( session.position )
+    {
+      file << "position " << session.position->line.toString() << "\n";
+      file << "chunk " << session.position->chunkStart.toString() << "\n";
+    }
+    if ( !file.flush() )
+    {
+      std::filesystem::remove( temporaryPath, error );
+      return false;
+    }
+  }
+
+  std::filesystem::rename( temporaryPath, path, error );
+  if ( error )
+  {
+    std::filesystem::remove( temporaryPath, error );
+    return false;
+  }
+  return true;
+}
+
+}// namespace jess
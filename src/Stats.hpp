@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace jess
+{
+
+/// distribution of durations in power of two buckets of microseconds
+///
+/// recording is lock-free, so that the prefetch worker and the ui thread can record into the same histogram
+class LatencyHistogram
+{
+public:
+  // the last bucket collects everything above 2^(NUM_BUCKETS - 2) us, i.e. about 4 s
+  static constexpr size_t NUM_BUCKETS = 24;
+
+  void record( const std::chrono::nanoseconds duration )
+  {
+    const auto uMicroseconds = static_cast<uint64_t>( std::max<int64_t>( std::chrono::duration_cast<std::chrono::microseconds>( duration ).count(), 0 ) );
+    // bucket i holds [2^(i-1), 2^i) us, bucket 0 less than 1 us
+    const auto uBucket = std::min<size_t>( static_cast<size_t>( std::bit_width( uMicroseconds ) ), NUM_BUCKETS - 1 );
+    m_buckets[uBucket].fetch_add( 1, std::memory_order_relaxed );
+    m_uCount.fetch_add( 1, std::memory_order_relaxed );
+    m_uTotalMicroseconds.fetch_add( uMicroseconds, std::memory_order_relaxed );
+
+    uint64_t uMax = m_uMaxMicroseconds.load( std::memory_order_relaxed );
+    while ( uMicroseconds > uMax && !m_uMaxMicroseconds.compare_exchange_weak( uMax, uMicroseconds, std::memory_order_relaxed ) )
+    {
+    }
+  }
+
+  [[nodiscard]] uint64_t count() const { return m_uCount.load( std::memory_order_relaxed ); }
+
+  [[nodiscard]] std::chrono::microseconds mean() const
+  {
+    const uint64_t uCount = count();
+    return std::chrono::microseconds{ uCount == 0 ? 0 : m_uTotalMicroseconds.load( std::memory_order_relaxed ) / uCount };
+  }
+
+  [[nodiscard]] std::chrono::microseconds max() const { return std::chrono::microseconds{ m_uMaxMicroseconds.load( std::memory_order_relaxed ) }; }
+
+  /// upper bound of the fFraction quantile, e.g. 0.99; the bound of the last bucket is the maximum
+  [[nodiscard]] std::chrono::microseconds quantile( const double fFraction ) const
+  {
+    const uint64_t uCount = count();
+    const auto uRank = static_cast<uint64_t>( fFraction * static_cast<double>( uCount ) );
+    uint64_t uSeen = 0;
+    for ( size_t i = 0; i + 1 < NUM_BUCKETS; ++i )
+    {
+      uSeen += m_buckets[i].load( std::memory_order_relaxed );
+      if ( uSeen > uRank )
+      {
+        return std::min( std::chrono::microseconds{ uint64_t{ 1 } << i }, max() );
+      }
+    }
+    return max();
+  }
+
+  /// e.g. "n=40 mean=1.2ms p50<=1.0ms p99<=4.1ms max=5.0ms"
+  [[nodiscard]] std::string toString() const
+  {
+    if ( count() == 0 )
+    {
+      return "n=0";
+    }
+    return "n=" + std::to_string( count() ) + " mean=" + formatDuration( mean() ) + " p50<=" + formatDuration( quantile( 0.5 ) ) +
+      " p99<=" + formatDuration( quantile( 0.99 ) ) + " max=" + formatDuration( max() );
+  }
+
+  /// microseconds below 1 ms, milliseconds with one decimal otherwise
+  static std::string formatDuration( const std::chrono::microseconds duration )
+  {
+    const auto uMicroseconds = duration.count();
+    if ( uMicroseconds < 1000 )
+    {
+      return std::to_string( uMicroseconds ) + "us";
+    }
+    const auto uTenths = ( uMicroseconds + 50 ) / 100;
+    return std::to_string( uTenths / 10 ) + "." + std::to_string( uTenths % 10 ) + "ms";
+  }
+
+private:
+  std::array<std::atomic<uint64_t>, NUM_BUCKETS> m_buckets{};
+  std::atomic<uint64_t> m_uCount{};
+  std::atomic<uint64_t> m_uTotalMicroseconds{};
+  std::atomic<uint64_t> m_uMaxMicroseconds{};
+};
+
+/// counters of the chunk cache, shared by the ui thread and the prefetch worker
+struct CacheStats {
+  std::atomic<uint64_t> chunksBuilt{};
+  std::atomic<uint64_t> chunksEvicted{};
+  // built by the prefetch worker, and the part of them that was not needed anymore when it was done
+  std::atomic<uint64_t> chunksPrefetched{};
+  std::atomic<uint64_t> prefetchesDiscarded{};
+  std::atomic<uint64_t> entriesRead{};
+  // lookups of the chunk of the current journal entry after a seek, see ChunkedJournal::loadChunkAtCurrentPosition()
+  std::atomic<uint64_t> cacheHits{};
+  std::atomic<uint64_t> cacheMisses{};
+  LatencyHistogram chunkBuildTime{};
+
+  void recordChunkBuilt( const size_t uNumLines, const std::chrono::nanoseconds duration )
+  {
+    chunksBuilt.fetch_add( 1, std::memory_order_relaxed );
+    entriesRead.fetch_add( uNumLines, std::memory_order_relaxed );
+    chunkBuildTime.record( duration );
+  }
+};
+
+}// namespace jess
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define JESS_SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace jess
+{
+
+enum class SearchKernel {
+  SCALAR,
+  SSE2,
+  AVX2,
+};
+
+namespace detail
+{
+
+constexpr char toLowerAscii( const char c ) { return c >= 'A' && c <= 'Z' ? static_cast<char>( c + ( 'a' - 'A' ) ) : c; }
+
+constexpr bool isAlphaAscii( const char c ) { return toLowerAscii( c ) >= 'a' && toLowerAscii( c ) <= 'z'; }
+
+/// compares the haystack at p with the needle, which is lowercase if bIgnoreCase is set
+inline bool equalsAt( const char* p, const std::string_view sNeedle, const bool bIgnoreCase )
+{
+  if ( !bIgnoreCase )
+  {
+    return std::memcmp( p, sNeedle.data(), sNeedle.size() ) == 0;
+  }
+  for ( size_t i = 0; i < sNeedle.size(); ++i )
+  {
+    if ( toLowerAscii( p[i] ) != sNeedle[i] )
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline size_t findScalar( const std::string_view sHaystack, const std::string_view sNeedle, const bool bIgnoreCase, size_t uStart = 0 )
+{
+  if ( !bIgnoreCase )
+  {
+    return sHaystack.find( sNeedle, uStart );
+  }
+  const char first = sNeedle.front();
+  for ( size_t i = uStart; i + sNeedle.size() <= sHaystack.size(); ++i )
+  {
+    if ( toLowerAscii( sHaystack[i] ) == first && equalsAt( &sHaystack[i], sNeedle, true ) )
+    {
+      return i;
+    }
+  }
+  return std::string_view::npos;
+}
+
+#ifdef JESS_SEARCH_X86
+// the kernels compare the first and the last byte of the needle at 16 (32) positions at once and only verify the
+// candidates where both match. Letters are compared with the case bit set on both sides if the case is ignored.
+// https://0x80.pl/articles/simd-strfind.html
+
+[[gnu::target( "sse2" )]] inline size_t findSse2( const std::string_view sHaystack, const std::string_view sNeedle, const bool bIgnoreCase )
+{
+  const size_t uLast = sNeedle.size() - 1;
+  const __m128i first = _mm_set1_epi8( sNeedle.front() );
+  const __m128i last = _mm_set1_epi8( sNeedle.back() );
+  const __m128i foldFirst = _mm_set1_epi8( bIgnoreCase && isAlphaAscii( sNeedle.front() ) ? 0x20 : 0 );
+  const __m128i foldLast = _mm_set1_epi8( bIgnoreCase && isAlphaAscii( sNeedle.back() ) ? 0x20 : 0 );
+
+  size_t i = 0;
+  for ( ; i + uLast + 16 <= sHaystack.size(); i += 16 )
+  {
+    const __m128i blockFirst = _mm_or_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( sHaystack.data() + i ) ), foldFirst );
+    const __m128i blockLast = _mm_or_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( sHaystack.data() + i + uLast ) ), foldLast );
+    auto uMask = static_cast<uint32_t>( _mm_movemask_epi8( _mm_and_si128( _mm_cmpeq_epi8( blockFirst, first ), _mm_cmpeq_epi8( blockLast, last ) ) ) );
+    while ( uMask != 0 )
+    {
+      const size_t uCandidate = i + static_cast<size_t>( __builtin_ctz( uMask ) );
+      if ( equalsAt( sHaystack.data() + uCandidate, sNeedle, bIgnoreCase ) )
+      {
+        return uCandidate;
+      }
+      uMask &= uMask - 1;
+    }
+  }
+  return findScalar( sHaystack, sNeedle, bIgnoreCase, i );
+}
+
+[[gnu::target( "avx2" )]] inline size_t findAvx2( const std::string_view sHaystack, const std::string_view sNeedle, const bool bIgnoreCase )
+{
+  const size_t uLast = sNeedle.size() - 1;
+  const __m256i first = _mm256_set1_epi8( sNeedle.front() );
+  const __m256i last = _mm256_set1_epi8( sNeedle.back() );
+  const __m256i foldFirst = _mm256_set1_epi8( bIgnoreCase && isAlphaAscii( sNeedle.front() ) ? 0x20 : 0 );
+  const __m256i foldLast = _mm256_set1_epi8( bIgnoreCase && isAlphaAscii( sNeedle.back() ) ? 0x20 : 0 );
+
+  size_t i = 0;
+  for ( ; i + uLast + 32 <= sHaystack.size(); i += 32 )
+  {
+    const __m256i blockFirst = _mm256_or_si256( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( sHaystack.data() + i ) ), foldFirst );
+    const __m256i blockLast = _mm256_or_si256( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( sHaystack.data() + i + uLast ) ), foldLast );
+    auto uMask = static_cast<uint32_t>( _mm256_movemask_epi8( _mm256_and_si256( _mm256_cmpeq_epi8( blockFirst, first ), _mm256_cmpeq_epi8( blockLast, last ) ) ) );
+    while ( uMask != 0 )
+    {
+      const size_t uCandidate = i + static_cast<size_t>( __builtin_ctz( uMask ) );
+      if ( equalsAt( sHaystack.data() + uCandidate, sNeedle, bIgnoreCase ) )
+      {
+        return uCandidate;
+      }
+      uMask &= uMask - 1;
+    }
+  }
+  // the rest is shorter than a 32 byte block, but may still fill a 16 byte one
+  const size_t uFound = findSse2( sHaystack.substr( i ), sNeedle, bIgnoreCase );
+  return uFound == std::string_view::npos ? uFound : i + uFound;
+}
+#endif
+
+}// namespace detail
+
+/// finds a fixed string in messages, optionally ignoring the case of ASCII letters
+///
+/// the fastest kernel supported by the cpu is picked at runtime
+class SubstringSearcher
+{
+  // lowercase if the case is ignored
+  std::string m_sNeedle;
+  bool m_bIgnoreCase;
+  SearchKernel m_kernel;
+
+public:
+  explicit SubstringSearcher( const std::string_view sNeedle, const bool bIgnoreCase = false, const SearchKernel kernel = bestKernel() )
+    : m_sNeedle( sNeedle )
+    , m_bIgnoreCase( bIgnoreCase )
+    , m_kernel( kernel )
+  {
+    if ( m_bIgnoreCase )
+    {
+      std::transform( m_sNeedle.begin(), m_sNeedle.end(), m_sNeedle.begin(), detail::toLowerAscii );
+    }
+  }
+
+  [[nodiscard]] static bool isSupported( const SearchKernel kernel )
+  {
+    switch ( kernel )
+    {
+#ifdef JESS_SEARCH_X86
+      case SearchKernel::SSE2:
+        return __builtin_cpu_supports( "sse2" );
+      case SearchKernel::AVX2:
+        return __builtin_cpu_supports( "avx2" );
+#endif
+      case SearchKernel::SCALAR:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  [[nodiscard]] static SearchKernel bestKernel()
+  {
+    static const SearchKernel best = isSupported( SearchKernel::AVX2 ) ? SearchKernel::AVX2
+      : isSupported( SearchKernel::SSE2 )                               ? SearchKernel::SSE2
+                                                                         : SearchKernel::SCALAR;
+    return best;
+  }
+
+  [[nodiscard]] std::string_view needle() const { return m_sNeedle; }
+  [[nodiscard]] bool ignoresCase() const { return m_bIgnoreCase; }
+
+  /// returns the position of the first match or std::string_view::npos
+  [[nodiscard]] size_t find( const std::string_view sHaystack ) const
+  {
+    if ( m_sNeedle.empty() )
+    {
+      return 0;
+    }
+    if ( sHaystack.size() < m_sNeedle.size() )
+    {
+      return std::string_view::npos;
+    }
+
+    switch ( m_kernel )
+    {
+#ifdef JESS_SEARCH_X86
+      case SearchKernel::AVX2:
+        return detail::findAvx2( sHaystack, m_sNeedle, m_bIgnoreCase );
+      case SearchKernel::SSE2:
+        return detail::findSse2( sHaystack, m_sNeedle, m_bIgnoreCase );
+#endif
+      default:
+        return detail::findScalar( sHaystack, m_sNeedle, m_bIgnoreCase );
+    }
+  }
+
+  bool operator()( const std::string_view sHaystack ) const { return find( sHaystack ) != std::string_view::npos; }
+};
+
+}// namespace jess
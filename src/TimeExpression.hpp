@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace jess
+{
+
+namespace detail
+{
+
+/// reads exactly uNumDigits decimal digits at uPos and advances uPos past them
+inline std::optional<int> readDigits( const std::string_view sValue, size_t& uPos, const size_t uNumDigits )
+{
+  if ( sValue.size() - uPos < uNumDigits )
+  {
+    return std::nullopt;
+  }
+  int value{};
+  const char* pBegin = sValue.data() + uPos;
+  const auto [pEnd, ec] = std::from_chars( pBegin, pBegin + uNumDigits, value );
+  if ( ec != std::errc{} || pEnd != pBegin + uNumDigits || *pBegin == '-' || *pBegin == '+' )
+  {
+    return std::nullopt;
+  }
+  uPos += uNumDigits;
+  return value;
+}
+
+inline bool readChar( const std::string_view sValue, size_t& uPos, const char c )
+{
+  if ( uPos < sValue.size() && sValue[uPos] == c )
+  {
+    ++uPos;
+    return true;
+  }
+  return false;
+}
+
+/// parses "[+-]N<unit>[N<unit>...]" with the units s, m, h, d and w, relative to now
+inline std::chrono::system_clock::time_point parseRelativeTime( const std::string_view sExpression, const std::chrono::system_clock::time_point now )
+{
+  const bool bBackward = sExpression.front() == '-';
+  std::chrono::seconds offset{};
+
+  size_t uPos = 1;
+  while ( uPos < sExpression.size() )
+  {
+    int64_t amount{};
+    const auto [pEnd, ec] = std::from_chars( sExpression.data() + uPos, sExpression.data() + sExpression.size(), amount );
+    if ( ec != std::errc{} || amount < 0 || pEnd == sExpression.data() + sExpression.size() )
+    {
+      throw std::invalid_argument{ "invalid relative time: " + std::string{ sExpression } };
+    }
+    uPos = static_cast<size_t>( pEnd - sExpression.data() );
+
+    switch ( sExpression[uPos++] )
+    {
+      case 's':
+        offset += std::chrono::seconds{ amount };
+        break;
+      case 'm':
+        offset += std::chrono::minutes{ amount };
+        break;
+      case 'h':
+        offset += std::chrono::hours{ amount };
+        break;
+      case 'd':
+        offset += std::chrono::days{ amount };
+        break;
+      case 'w':
+        offset += std::chrono::weeks{ amount };
+        break;
+      default:
+        throw std::invalid_argument{ "invalid time unit in " + std::string{ sExpression } + ", expected s, m, h, d or w" };
+    }
+  }
+
+  if ( uPos == 1 )
+  {
+    throw std::invalid_argument{ "invalid relative time: " + std::string{ sExpression } };
+  }
+  return bBackward ? now - offset : now + offset;
+}
+
+}// namespace detail
+
+/// parses a point in time as entered by the user
+///
+/// accepted are "now", times relative to now like "-15m", "+1h" or "-1d12h", and absolute times
+/// "YYYY-MM-DD[ HH:MM[:SS]]" and "HH:MM[:SS]" (today). Absolute times are in local time if bLocalTime is set, in UTC
+/// otherwise, matching how the timestamps are shown. Throws std::invalid_argument if the expression is malformed.
+inline std::chrono::system_clock::time_point parseTimeExpression( std::string_view sExpression, const std::chrono::system_clock::time_point now,
+  const bool bLocalTime )
+{
+  sExpression.remove_prefix( std::min( sExpression.find_first_not_of( ' ' ), sExpression.size() ) );
+  sExpression.remove_suffix( sExpression.size() - std::min( sExpression.find_last_not_of( ' ' ) + 1, sExpression.size() ) );
+
+  if ( sExpression.empty() )
+  {
+    throw std::invalid_argument{ "missing time" };
+  }
+  if ( sExpression == "now" )
+  {
+    return now;
+  }
+  if ( sExpression.front() == '-' || sExpression.front() == '+' )
+  {
+    return detail::parseRelativeTime( sExpression, now );
+  }
+
+  const auto invalid = [&] { return std::invalid_argument{ "invalid time: " + std::string{ sExpression } + ", expected YYYY-MM-DD [HH:MM[:SS]]" }; };
+
+  // the date defaults to today
+  std::tm tm{};
+  const std::time_t nowTime = std::chrono::system_clock::to_time_t( now );
+  if ( bLocalTime )
+  {
+    ::localtime_r( &nowTime, &tm );
+  }
+  else
+  {
+    ::gmtime_r( &nowTime, &tm );
+  }
+  tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+
+  size_t uPos = 0;
+  if ( sExpression.size() >= 10 && sExpression[4] == '-' )
+  {
+    const auto year = detail::readDigits( sExpression, uPos, 4 );
+    const auto month = detail::readChar( sExpression, uPos, '-' ) ? detail::readDigits( sExpression, uPos, 2 ) : std::nullopt;
+    const auto day = detail::readChar( sExpression, uPos, '-' ) ? detail::readDigits( sExpression, uPos, 2 ) : std::nullopt;
+    if ( !year || !month || !day )
+    {
+      throw invalid();
+    }
+    tm.tm_year = *year - 1900;
+    tm.tm_mon = *month - 1;
+    tm.tm_mday = *day;
+
+    if ( uPos < sExpression.size() && !detail::readChar( sExpression, uPos, ' ' ) && !detail::readChar( sExpression, uPos, 'T' ) )
+    {
+      throw invalid();
+    }
+  }
+
+  if ( uPos < sExpression.size() )
+  {
+    const auto hour = detail::readDigits( sExpression, uPos, 2 );
+    const auto minute = detail::readChar( sExpression, uPos, ':' ) ? detail::readDigits( sExpression, uPos, 2 ) : std::nullopt;
+    const auto second = detail::readChar( sExpression, uPos, ':' ) ? detail::readDigits( sExpression, uPos, 2 ) : std::optional{ 0 };
+    if ( !hour || !minute || !second || uPos != sExpression.size() )
+    {
+      throw invalid();
+    }
+    tm.tm_hour = *hour;
+    tm.tm_min = *minute;
+    tm.tm_sec = *second;
+  }
+
+  if ( tm.tm_hour > 23 || tm.tm_min > 59 || tm.tm_sec > 60 )
+  {
+    throw invalid();
+  }
+  const std::chrono::year_month_day date{ std::chrono::year{ tm.tm_year + 1900 }, std::chrono::month{ static_cast<unsigned>( tm.tm_mon + 1 ) },
+    std::chrono::day{ static_cast<unsigned>( tm.tm_mday ) } };
+  if ( !date.ok() )
+  {
+    throw invalid();
+  }
+
+  if ( !bLocalTime )
+  {
+    return std::chrono::sys_days{ date } + std::chrono::hours{ tm.tm_hour } + std::chrono::minutes{ tm.tm_min } + std::chrono::seconds{ tm.tm_sec };
+  }
+  // let mktime() figure out whether daylight saving time applies
+  tm.tm_isdst = -1;
+  const std::time_t time = std::mktime( &tm );
+  if ( time == -1 )
+  {
+    throw invalid();
+  }
+  return std::chrono::system_clock::from_time_t( time );
+}
+
+}// namespace jess
@@ -0,0 +1,276 @@
+#pragma once
+
+#include "CSeekableStream.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace jess
+{
+
+/// number of entries per time bucket between the first and the last entry of the journal
+struct Timeline {
+  std::chrono::system_clock::time_point begin{};
+  std::chrono::system_clock::time_point end{};
+  // estimated from every stride-th entry, exact if the stride is 1
+  std::vector<size_t> counts{};
+  size_t stride{};
+  // set once no further refinement follows
+  bool complete{};
+
+  /// the bucket of the time, times outside of [begin, end] are counted in the first or last bucket
+  [[nodiscard]] size_t bucketOf( const std::chrono::system_clock::time_point time ) const
+  {
+    const auto range = ( end - begin ).count() + 1;
+    const auto offset = std::clamp<decltype( range )>( ( time - begin ).count(), 0, range - 1 );
+    return static_cast<size_t>( static_cast<double>( offset ) / static_cast<double>( range ) * static_cast<double>( counts.size() ) );
+  }
+};
+
+/// draws the timeline as a strip of uWidth characters, denser buckets with heavier characters
+///
+/// the buckets are merged or stretched to the width; the column of the marker, e.g. the time of the line at the top of
+/// the screen, is shown as '|'
+inline std::string renderTimeline( const Timeline& timeline, const size_t uWidth, const std::optional<std::chrono::system_clock::time_point> marker = {} )
+{
+  static constexpr std::string_view LEVELS = " .:-=+*#%@";
+
+  std::string sStrip( uWidth, ' ' );
+  if ( timeline.counts.empty() || uWidth == 0 )
+  {
+    return sStrip;
+  }
+
+  std::vector<size_t> columns( uWidth );
+  const size_t uNumBuckets = timeline.counts.size();
+  if ( uNumBuckets >= uWidth )
+  {
+    for ( size_t i = 0; i < uNumBuckets; ++i )
+    {
+      columns[i * uWidth / uNumBuckets] += timeline.counts[i];
+    }
+  }
+  else
+  {
+    // every bucket covers several columns
+    for ( size_t i = 0; i < uWidth; ++i )
+    {
+      columns[i] = timeline.counts[i * uNumBuckets / uWidth];
+    }
+  }
+
+  const size_t uMax = *std::max_element( columns.begin(), columns.end() );
+  if ( uMax == 0 )
+  {
+    return sStrip;
+  }
+  for ( size_t i = 0; i < uWidth; ++i )
+  {
+    // any entry is visible, the densest column gets the heaviest character
+    sStrip[i] = LEVELS[( columns[i] * ( LEVELS.size() - 1 ) + uMax - 1 ) / uMax];
+  }
+
+  if ( marker )
+  {
+    sStrip[timeline.bucketOf( *marker ) * uWidth / uNumBuckets] = '|';
+  }
+  return sStrip;
+}
+
+namespace detail
+{
+
+/// counts every stride-th entry as stride entries into uNumBuckets buckets of the timeline, returns the estimated number
+/// of entries or nothing if stopped
+///
+/// the last entry of the journal stands for itself only: skipping stays there, so it would otherwise be counted as
+/// stride entries although the ones before it were already covered by the previous sample
+template<SeekableStream TJournal>
+std::optional<size_t> samplePass( TJournal& journal, Timeline& timeline, const size_t uNumBuckets, const size_t uStride, const std::stop_token& stopToken )
+{
+  timeline.counts.assign( uNumBuckets, 0 );
+  size_t uNumEntries{};
+
+  journal.seekToBof();
+  if ( !journal.next() )
+  {
+    return 0;
+  }
+  while ( true )
+  {
+    if ( stopToken.stop_requested() )
+    {
+      return std::nullopt;
+    }
+
+    // only the timestamp is read, the message and the priority are not needed
+    const size_t uBucket = timeline.bucketOf( realtimeOf( journal ) );
+    bool bLast{};
+    if ( uStride == 1 )
+    {
+      bLast = !journal.next();
+    }
+    else
+    {
+      const auto seqid = journal.getSeqid();
+      journal.seekLinesForward( uStride );
+      bLast = journal.getSeqid() == seqid;
+    }
+
+    const size_t uWeight = bLast ? 1 : uStride;
+    timeline.counts[uBucket] += uWeight;
+    uNumEntries += uWeight;
+    if ( bLast )
+    {
+      return uNumEntries;
+    }
+  }
+}
+
+}// namespace detail
+
+/// computes the timeline of a journal on a worker thread with its own journal handle
+///
+/// the entries are sampled by skipping stride entries at a time; each pass uses a smaller stride and replaces the
+/// timeline of the previous pass, so a rough picture of huge journals is available early. The stride stops shrinking
+/// once a pass would take more than MAX_SAMPLES_PER_PASS samples. An exception thrown by the worker, e.g. because the
+/// journal could not be opened, ends it and is rethrown by takeUpdate().
+template<SeekableStream TJournal>
+class TimelineBuilder
+{
+public:
+  static constexpr size_t INITIAL_STRIDE = 65536;
+  static constexpr size_t STRIDE_DIVISOR = 16;
+  static constexpr size_t MAX_SAMPLES_PER_PASS = 1'000'000;
+
+private:
+  size_t m_uNumBuckets;
+  std::function<TJournal()> m_openJournal;
+  std::function<void( TJournal& )> m_configureJournal;
+  std::mutex m_mutex{};
+  std::optional<Timeline> m_update{};
+  bool m_bDone{};
+  std::exception_ptr m_pError{};
+  std::jthread m_worker;
+
+public:
+  /// the worker opens its journal with openJournal and applies configureJournal to it, e.g. to add the matches of a
+  /// filter
+  TimelineBuilder( const size_t uNumBuckets, std::function<TJournal()> openJournal, std::function<void( TJournal& )> configureJournal = {} )
+    : m_uNumBuckets( uNumBuckets )
+    , m_openJournal( std::move( openJournal ) )
+    , m_configureJournal( std::move( configureJournal ) )
+    , m_worker( [this]( const std::stop_token& stopToken ) { run( stopToken ); } )
+  {
+  }
+
+  TimelineBuilder( const TimelineBuilder& ) = delete;
+  TimelineBuilder& operator=( const TimelineBuilder& ) = delete;
+
+  /// returns the timeline of the latest pass if it has not been taken yet
+  [[nodiscard]] std::optional<Timeline> takeUpdate()
+  {
+    std::scoped_lock lock{ m_mutex };
+    if ( m_pError )
+    {
+      std::rethrow_exception( m_pError );
+    }
+    return std::exchange( m_update, std::nullopt );
+  }
+
+  /// true once the last pass has finished or the worker has failed
+  [[nodiscard]] bool done()
+  {
+    std::scoped_lock lock{ m_mutex };
+    return m_bDone;
+  }
+
+  /// blocks until the last pass has finished
+  void wait() { m_worker.join(); }
+
+private:
+  void publish( Timeline timeline )
+  {
+    std::scoped_lock lock{ m_mutex };
+    m_bDone = timeline.complete;
+    m_update = std::move( timeline );
+  }
+
+  void run( const std::stop_token& stopToken )
+  {
+    try
+    {
+      build( stopToken );
+    }
+    catch ( ... )
+    {
+      std::scoped_lock lock{ m_mutex };
+      m_pError = std::current_exception();
+      m_bDone = true;
+    }
+  }
+
+  void build( const std::stop_token& stopToken )
+  {
+    // the journal is opened on the worker thread, the handle must never be shared with the ui thread
+    TJournal journal = m_openJournal();
+    if ( m_configureJournal )
+    {
+      m_configureJournal( journal );
+    }
+
+    Timeline timeline{};
+    journal.seekToEof();
+    if ( !journal.previous() )
+    {
+      timeline.complete = true;
+      publish( std::move( timeline ) );
+      return;
+    }
+    timeline.end = realtimeOf( journal );
+    journal.seekToBof();
+    journal.next();
+    timeline.begin = std::min( realtimeOf( journal ), timeline.end );
+
+    size_t uStride = INITIAL_STRIDE;
+    while ( !stopToken.stop_requested() )
+    {
+      const auto numEntries = detail::samplePass( journal, timeline, m_uNumBuckets, uStride, stopToken );
+      if ( !numEntries )
+      {
+        return;
+      }
+      if ( *numEntries == 0 )
+      {
+        // the journal has become empty since its bounds were read
+        timeline.counts.clear();
+        timeline.complete = true;
+        publish( std::move( timeline ) );
+        return;
+      }
+
+      // the pass with stride 1 is exact, smaller strides for huge journals would take too long
+      const size_t uNextStride = uStride / STRIDE_DIVISOR;
+      timeline.stride = uStride;
+      timeline.complete = uStride == 1 || *numEntries / std::max<size_t>( uNextStride, 1 ) > MAX_SAMPLES_PER_PASS;
+      publish( timeline );
+      if ( timeline.complete )
+      {
+        return;
+      }
+      uStride = std::max<size_t>( uNextStride, 1 );
+    }
+  }
+};
+
+}// namespace jess
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string_view>
+
+namespace jess
+{
+
+struct TimestampFormat {
+  // local time instead of UTC
+  bool localTime{};
+  // append the microseconds
+  bool microseconds{};
+};
+
+/// formats realtime timestamps as "YYYY-MM-DD HH:MM:SS[.uuuuuu]" into a fixed buffer
+///
+/// the broken down time is only computed when a timestamp leaves the minute of the previous one. Within that minute
+/// only the seconds and microseconds digits are rewritten, so formatting a screen full of consecutive entries neither
+/// allocates nor calls into the C library.
+class TimestampFormatter
+{
+  static constexpr size_t SECONDS_OFFSET = 17;
+  static constexpr size_t MICROSECONDS_OFFSET = 20;
+
+  TimestampFormat m_format;
+  // "YYYY-MM-DD HH:MM:SS.uuuuuu", the date and minute part is valid for [m_minuteStart, m_minuteStart + 60s)
+  std::array<char, 26> m_buffer{ '0', '0', '0', '0', '-', '0', '0', '-', '0', '0', ' ', '0', '0', ':', '0', '0', ':', '0', '0', '.' };
+  std::chrono::sys_seconds m_minuteStart{ std::chrono::sys_seconds::min() };
+
+public:
+  explicit TimestampFormatter( const TimestampFormat format = {} )
+    : m_format( format )
+  {
+  }
+
+  [[nodiscard]] TimestampFormat format() const { return m_format; }
+
+  void setFormat( const TimestampFormat format )
+  {
+    m_format = format;
+    invalidate();
+  }
+
+  /// drops the cached minute, needed when the local time zone has changed
+  void invalidate() { m_minuteStart = std::chrono::sys_seconds::min(); }
+
+  /// length of every formatted timestamp in the current format
+  [[nodiscard]] size_t width() const { return m_format.microseconds ? m_buffer.size() : MICROSECONDS_OFFSET - 1; }
+
+  /// the returned view refers to an internal buffer and is overwritten by the next call
+  std::string_view operator()( const std::chrono::time_point<std::chrono::system_clock> timestamp )
+  {
+    const auto seconds = std::chrono::floor<std::chrono::seconds>( timestamp );
+
+    if ( seconds < m_minuteStart || seconds >= m_minuteStart + std::chrono::minutes{ 1 } )
+    {
+      updateMinute( seconds );
+    }
+
+    writeDigits( &m_buffer[SECONDS_OFFSET], 2, static_cast<uint32_t>( ( seconds - m_minuteStart ).count() ) );
+    if ( m_format.microseconds )
+    {
+      const auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>( timestamp - seconds );
+      writeDigits( &m_buffer[MICROSECONDS_OFFSET], 6, static_cast<uint32_t>( microseconds.count() ) );
+    }
+
+    return { m_buffer.data(), width() };
+  }
+
+private:
+  void updateMinute( const std::chrono::sys_seconds seconds )
+  {
+    const std::time_t time = seconds.time_since_epoch().count();
+    std::tm tm{};
+    if ( m_format.localTime )
+    {
+      ::localtime_r( &time, &tm );
+    }
+    else
+    {
+      ::gmtime_r( &time, &tm );
+    }
+
+    // time zone offsets are whole minutes, so the local minute starts tm_sec seconds ago as well
+    m_minuteStart = seconds - std::chrono::seconds{ tm.tm_sec };
+
+    writeDigits( &m_buffer[0], 4, static_cast<uint32_t>( tm.tm_year + 1900 ) );
+    writeDigits( &m_buffer[5], 2, static_cast<uint32_t>( tm.tm_mon + 1 ) );
+    writeDigits( &m_buffer[8], 2, static_cast<uint32_t>( tm.tm_mday ) );
+    writeDigits( &m_buffer[11], 2, static_cast<uint32_t>( tm.tm_hour ) );
+    writeDigits( &m_buffer[14], 2, static_cast<uint32_t>( tm.tm_min ) );
+  }
+
+  static void writeDigits( char* pDest, const size_t uWidth, uint32_t uValue )
+  {
+    for ( size_t i = uWidth; i > 0; --i )
+    {
+      pDest[i - 1] = static_cast<char>( '0' + uValue % 10 );
+      uValue /= 10;
+    }
+  }
+};
+
+}// namespace jess
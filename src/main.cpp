@@ -1,54 +1,130 @@
 #include <iostream>
 #include <limits>
 
+#include "FilteredStream.hpp"
 #include "JessMain.hpp"
+#include "JournalDump.hpp"
 #include "Modeline.hpp"
 #include "NcWindow.hpp"
 
+#include <csignal>
+#include <cstring>
 #include <ncurses.h>
+#include <unistd.h>
+
+/// writes the entries to stdout without starting the viewer, returns the exit status
+int dump(const jess::JessOptions &options) {
+  // a reader that has gone away, e.g. head, ends the dump quietly instead of killing it
+  std::signal(SIGPIPE, SIG_IGN);
+
+  jess::OutputWriter output{STDOUT_FILENO};
+  const jess::DumpOptions dumpOptions{options.since, options.until, options.columns, options.timestampFormat};
+  const auto openJournal = [scope = options.scope] {
+    jess::SdJournal journal{scope};
+    journal.setDataThreshold(0);
+    return journal;
+  };
+  const auto configure = [filter = options.filter](jess::SdJournal &journal) { jess::applyFilter(journal, filter); };
+  if (options.grep.empty()) {
+    jess::dumpJournal<jess::SdJournal>(openJournal, configure, dumpOptions, output.blockSize(), output);
+  } else {
+    // nobody waits for a screen to be drawn, the scan goes on until the next match however far away it is
+    using Filtered = jess::FilteredStream<jess::SdJournal, jess::MessageContains>;
+    jess::dumpJournal<Filtered>(
+        [openJournal, grep = options.grep, bIgnoreCase = options.ignoreCase] {
+          return Filtered{openJournal(), jess::MessageContains{grep, bIgnoreCase}, std::numeric_limits<size_t>::max()};
+        },
+        [configure](Filtered &journal) { configure(journal.journal()); }, dumpOptions, output.blockSize(), output);
+  }
+  if (output.error() != 0 && output.error() != EPIPE) {
+    std::cerr << "error: cannot write the entries: " << std::strerror(output.error()) << std::endl;
+    return 1;
+  }
+  return 0;
+}
 
 
-void run() {
-  jess::JessMain main{};
-  using jess::ctrl;
-  using jess::meta;
+/// returns false if the statistics could not be written
+bool run(const jess::JessOptions &options) {
+  jess::JessMain main{options};
   using key = jess::KeyCombination;
 
-  // for now, let's start at the top
-  main.scrollToBof();
+  if (options.follow) {
+    main.toggleFollow();
+  } else if (options.since) {
+    main.scrollToTime(*options.since);
+  } else if (!main.restoreSession()) {
+    main.scrollToBof();
+  }
 
   bool bContinue = true;
 
   while (bContinue) {
+    // the scroll keys are handled by getNextKey(), see jess::scrollDistance()
     auto kc = main.getNextKey();
 
-    if (kc == ctrl('p') || kc == key(KEY_UP)) {
-      main.scrollUpLine();
+    if (kc == key('g')) {
+      main.scrollToBof();
       continue;
     }
 
-    if (kc == ctrl('n') || kc == key(KEY_DOWN)) {
-      main.scrollDownLine();
+    if (kc == key('G')) {
+      main.scrollToEof();
       continue;
     }
 
-    if (kc == key('b') || kc == meta('v') || kc == key(KEY_PPAGE)) {
-      main.scrollUpPage();
+    if (kc == key('F')) {
+      main.toggleFollow();
       continue;
     }
 
-    if (kc == key('f') || kc == ctrl('v') || kc == key(KEY_NPAGE)) {
-      main.scrollDownPage();
+    if (kc == key('/')) {
+      main.startSearch(jess::Adjacency::AFTER_CURRENT);
       continue;
     }
 
-    if (kc == key('g')) {
-      main.scrollToBof();
+    if (kc == key('?')) {
+      main.startSearch(jess::Adjacency::BEFORE_CURRENT);
       continue;
     }
 
-    if (kc == key('G')) {
-      main.scrollToEof();
+    if (kc == key('n')) {
+      main.searchNext();
+      continue;
+    }
+
+    if (kc == key('N')) {
+      main.searchPrevious();
+      continue;
+    }
+
+    if (kc == key(']')) {
+      main.jumpToError(jess::Adjacency::AFTER_CURRENT);
+      continue;
+    }
+
+    if (kc == key('[')) {
+      main.jumpToError(jess::Adjacency::BEFORE_CURRENT);
+      continue;
+    }
+
+    if (kc == key('t')) {
+      main.toggleLocalTime();
+      continue;
+    }
+
+    if (kc == key('u')) {
+      main.toggleMicroseconds();
+      continue;
+    }
+
+    if (kc == key('H')) {
+      main.toggleTimeline();
+      continue;
+    }
+
+    if (kc == key('e')) {
+      main.expandEntry();
       continue;
     }
 
@@ -62,13 +138,44 @@ void run() {
       continue;
     }
   }
+
+  main.stopLoading();
+  main.saveSession();
+  return main.writeStatsFile();
 }
 
-int main() {
+int main(int argc, char **argv) {
+  jess::JessOptions options{};
   try {
-    run();
+    options = jess::parseArguments({argv + 1, static_cast<size_t>(argc - 1)});
+  } catch (const std::invalid_argument &ex) {
+    std::cerr << "error: " << ex.what() << "\n" << jess::USAGE;
+    return 1;
+  }
+
+  if (options.showHelp) {
+    std::cout << jess::USAGE;
+    return 0;
+  }
+
+  try {
+    if (options.dump) {
+      return dump(options);
+    }
+    if (!run(options)) {
+      std::cerr << "error: cannot write the statistics to " << options.statsFile << std::endl;
+      return 1;
+    }
   } catch (const jess::NcError &ex) {
     std::cerr << "error: " << ex.what() << std::endl;
+  } catch (const jess::SdError &ex) {
+    std::cerr << "error: " << ex.what() << std::endl;
+    return 1;
+  } catch (const std::exception &ex) {
+    // e.g. rethrown from a load on the i/o thread, see jess::IoExecutor::runCompletions(); the terminal has been
+    // restored by the time it gets here
+    std::cerr << "error: " << ex.what() << std::endl;
+    return 1;
   }
   return 0;
 }
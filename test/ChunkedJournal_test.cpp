@@ -1,84 +1,18 @@
 #include "ChunkedJournal.hpp"
+#include "MockStream.hpp"
 #include <doctest/doctest.h>
 
-using namespace std::string_view_literals;
-
-template<size_t uStreamLength>
-struct MockStream {
-  int64_t pos{};
-  std::optional<jess::SdLine> currentLine{};
-
-  void seekToBof() { pos = -1; }
-
-  void seekToEof() { pos = uStreamLength; }
-
-  void seekLinesForward( const size_t uNumLines )
-  {
-    pos = std::min( pos + uNumLines, uStreamLength - 1 );
-    loadCurrentLine();
-  }
-
-  void seekLinesBackward( const size_t uNumLines )
-  {
-    if ( uNumLines > pos )
-    {
-      pos = 0;
-    }
-    else
-    {
-      pos = pos - uNumLines;
-    }
-    loadCurrentLine();
-  }
-
-  bool next()
-  {
-    pos += 1;
-    assert( pos >= 0 );
-
-    if ( pos < uStreamLength )
-    {
-      loadCurrentLine();
-    }
-
-    return pos < uStreamLength;
-  }
-
-  bool previous()
-  {
-    pos -= 1;
-    assert( pos < uStreamLength );
-
-    if ( pos >= 0 )
-    {
-      loadCurrentLine();
-    }
-
-    return pos >= 0;
-  }
-
-  [[nodiscard]] jess::SdSeqid getSeqid() const { return currentLine->seqid(); }
-
-  jess::SdLine getLine() { return currentLine.value(); }
+#include <stdexcept>
 
-private:
-  void loadCurrentLine()
-  {
-    currentLine = jess::SdLine{
-      { { std::array<uint8_t, 16>{} }, { static_cast<size_t>( pos ) } },
-      std::string{ "line " } + std::to_string( pos ),
-      std::chrono::system_clock::time_point{ std::chrono::seconds{ pos } },
-    };
-  }
-};
+using namespace std::string_view_literals;
 
 void checkSequence( const jess::Chunk& chunk, const size_t uLength, const size_t uFirstIndex )
 {
-  REQUIRE( chunk.lines.size() == uLength );
+  REQUIRE( chunk.size() == uLength );
   for ( size_t i = 0; i < uLength; ++i )
   {
-    CHECK( chunk.lines.at( i ).seqid().seqnum.value == i + uFirstIndex );
-    CHECK( chunk.lines.at( i ).message() == "line " + std::to_string( i + uFirstIndex ) );
+    CHECK( chunk.line( i ).seqid().seqnum.value == i + uFirstIndex );
+    CHECK( chunk.line( i ).message() == "line " + std::to_string( i + uFirstIndex ) );
   }
 }
 
@@ -262,5 +196,827 @@ TEST_CASE( "ChunkedJournal(1) load EOF" )
   }
 }
 
+TEST_CASE( "ChunkedJournal(2) prefetch" )
+{
+  jess::ChunkedJournal<MockStream<10>> sut{ 2, 2 };
+  const std::list<jess::Chunk>& chunks = sut.getChunks();
+
+  SUBCASE( "the chunk after BOF is loaded in the background" )
+  {
+    sut.seekToBof();
+    sut.waitForPrefetch();
+    REQUIRE( chunks.size() == 2 );
+    checkSequence( chunks.front(), 2, 0 );
+    checkSequence( chunks.back(), 2, 2 );
+    CHECK( chunks.front().isFirstInJournal );
+    CHECK( chunks.front().contiguityEnd == jess::Contiguity::CONTIGUOUS );
+    CHECK( chunks.back().contiguityBeginning == jess::Contiguity::CONTIGUOUS );
+
+    SUBCASE( "crossing the boundary uses the prefetched chunk" )
+    {
+      const jess::Chunk* pSecondChunk = &chunks.back();
+      sut.seekLines( 2 );
+      CHECK( sut.getLines( 1 ).front().seqid().seqnum.value == 2 );
+      sut.waitForPrefetch();
+      REQUIRE( chunks.size() == 3 );
+      CHECK( &*std::next( chunks.begin() ) == pSecondChunk );
+      checkSequence( chunks.back(), 2, 4 );
+    }
+  }
+
+  SUBCASE( "the chunk before EOF is loaded in the background" )
+  {
+    sut.seekToEof();
+    sut.waitForPrefetch();
+    REQUIRE( chunks.size() == 2 );
+    checkSequence( chunks.front(), 2, 6 );
+    checkSequence( chunks.back(), 2, 8 );
+    CHECK( chunks.back().isLastInJournal );
+    CHECK( chunks.front().contiguityEnd == jess::Contiguity::CONTIGUOUS );
+    CHECK( chunks.back().contiguityBeginning == jess::Contiguity::CONTIGUOUS );
+  }
+
+  SUBCASE( "prefetching stops at an already cached chunk" )
+  {
+    sut.seekToEof();
+    sut.waitForPrefetch();
+    sut.seekToBof();
+    sut.seekLines( 3 );
+    sut.seekLines( 2 );
+    sut.waitForPrefetch();
+    REQUIRE( chunks.size() == 5 );
+    size_t uFirstIndex = 0;
+    for ( const jess::Chunk& chunk : chunks )
+    {
+      checkSequence( chunk, 2, uFirstIndex );
+      uFirstIndex += 2;
+    }
+    for ( auto it = chunks.begin(); std::next( it ) != chunks.end(); ++it )
+    {
+      CHECK( it->contiguityEnd == jess::Contiguity::CONTIGUOUS );
+      CHECK( std::next( it )->contiguityBeginning == jess::Contiguity::CONTIGUOUS );
+    }
+  }
+}
+
+TEST_CASE( "ChunkedJournal(1) eviction" )
+{
+  jess::ChunkedJournal<MockStream<10>> sut{ 1, 0, { 0, 3 } };
+  const std::list<jess::Chunk>& chunks = sut.getChunks();
+
+  sut.seekToBof();
+  sut.seekLines( 1 );
+  sut.seekLines( 1 );
+  REQUIRE( chunks.size() == 3 );
+
+  SUBCASE( "the least recently used chunk is evicted" )
+  {
+    sut.seekLines( 1 );
+    REQUIRE( chunks.size() == 3 );
+    checkSequence( chunks.front(), 1, 1 );
+    checkSequence( chunks.back(), 1, 3 );
+    CHECK( chunks.front().contiguityBeginning == jess::Contiguity::NON_CONTIGUOUS );
+    CHECK( chunks.front().contiguityEnd == jess::Contiguity::CONTIGUOUS );
+
+    size_t uBytes = 0;
+    for ( const jess::Chunk& chunk : chunks )
+    {
+      CHECK( chunk.sizeInBytes > 0 );
+      uBytes += chunk.sizeInBytes;
+    }
+    CHECK( sut.getCachedBytes() == uBytes );
+  }
+
+  SUBCASE( "the neighbours of the current chunk are not evicted" )
+  {
+    sut.seekToBof();
+    sut.seekToEof();
+    REQUIRE( chunks.size() == 3 );
+    checkSequence( chunks.front(), 1, 0 );
+    checkSequence( *std::next( chunks.begin() ), 1, 2 );
+    checkSequence( chunks.back(), 1, 9 );
+    CHECK( chunks.front().contiguityEnd == jess::Contiguity::NON_CONTIGUOUS );
+    CHECK( std::next( chunks.begin() )->contiguityBeginning == jess::Contiguity::NON_CONTIGUOUS );
+  }
+}
+
+TEST_CASE( "ChunkedJournal(3) chunks do not overlap" )
+{
+  jess::ChunkedJournal<MockStream<10>> sut{ 3, 0 };
+  const std::list<jess::Chunk>& chunks = sut.getChunks();
+  sut.seekToEof();
+  sut.seekToBof();
+  REQUIRE( chunks.size() == 2 );
+
+  SUBCASE( "loading adjacent chunks stops at the cached chunk" )
+  {
+    sut.seekLines( 5 );
+    sut.seekLines( 1 );
+    REQUIRE( chunks.size() == 4 );
+    auto it = chunks.begin();
+    checkSequence( *it++, 3, 0 );
+    checkSequence( *it++, 3, 3 );
+    checkSequence( *it++, 1, 6 );
+    checkSequence( *it++, 3, 7 );
+    for ( it = chunks.begin(); std::next( it ) != chunks.end(); ++it )
+    {
+      CHECK( it->contiguityEnd == jess::Contiguity::CONTIGUOUS );
+    }
+  }
+
+  SUBCASE( "loading non-adjacent chunks stops at the cached chunk" )
+  {
+    sut.seekLines( 7 );
+    CHECK( sut.getLines( 1 ).front().seqid().seqnum.value == 7 );
+    REQUIRE( chunks.size() == 3 );
+    auto it = chunks.begin();
+    checkSequence( *it++, 3, 0 );
+    checkSequence( *it, 1, 6 );
+    CHECK( it->contiguityBeginning == jess::Contiguity::NON_CONTIGUOUS );
+    CHECK( it->contiguityEnd == jess::Contiguity::CONTIGUOUS );
+    checkSequence( *++it, 3, 7 );
+  }
+}
+
+TEST_CASE( "ChunkedJournal(3) backward" )
+{
+  jess::ChunkedJournal<MockStream<10>> sut{ 3, 0 };
+  const std::list<jess::Chunk>& chunks = sut.getChunks();
+  const auto currentLine = [&] { return sut.getLines( 1 ).front().seqid().seqnum.value; };
+
+  sut.seekToEof();
+  REQUIRE( chunks.size() == 1 );
+  checkSequence( chunks.front(), 3, 7 );
+  CHECK( chunks.front().isLastInJournal );
+  CHECK( currentLine() == 9 );
+
+  SUBCASE( "scrolling up loads the previous chunk" )
+  {
+    sut.seekLines( -3 );
+    CHECK( currentLine() == 6 );
+    REQUIRE( chunks.size() == 2 );
+    checkSequence( chunks.front(), 3, 4 );
+    CHECK( chunks.front().contiguityEnd == jess::Contiguity::CONTIGUOUS );
+    CHECK( chunks.back().contiguityBeginning == jess::Contiguity::CONTIGUOUS );
+
+    SUBCASE( "scrolling down again stays in the cache" )
+    {
+      sut.seekLines( 3 );
+      CHECK( currentLine() == 9 );
+      CHECK( chunks.size() == 2 );
+    }
+  }
+
+  SUBCASE( "large negative seeks skip whole chunks and stop at BOF" )
+  {
+    sut.seekLines( -100 );
+    CHECK( currentLine() == 0 );
+    REQUIRE( chunks.size() == 2 );
+    checkSequence( chunks.front(), 1, 0 );
+    CHECK( chunks.front().isFirstInJournal );
+    CHECK( chunks.front().contiguityEnd == jess::Contiguity::NON_CONTIGUOUS );
+
+    SUBCASE( "the view continues into the following chunks" )
+    {
+      const auto lines = sut.getLines( 5 );
+      REQUIRE( lines.size() == 5 );
+      for ( size_t i = 0; i < lines.size(); ++i )
+      {
+        CHECK( lines[i].seqid().seqnum.value == i );
+      }
+      REQUIRE( chunks.size() == 4 );
+      auto it = chunks.begin();
+      checkSequence( *it, 1, 0 );
+      CHECK( it->contiguityEnd == jess::Contiguity::CONTIGUOUS );
+      checkSequence( *++it, 3, 1 );
+      CHECK( it->contiguityEnd == jess::Contiguity::CONTIGUOUS );
+      checkSequence( *++it, 3, 4 );
+    }
+  }
+
+  SUBCASE( "the view ends at EOF" )
+  {
+    CHECK( sut.getLines( 5 ).size() == 1 );
+    sut.seekLines( 5 );
+    CHECK( currentLine() == 9 );
+  }
+}
+
+TEST_CASE( "ChunkIndex" )
+{
+  const auto makeSeqid = []( const uint8_t uId, const size_t uSeqnum ) {
+    return jess::SdSeqid{ { std::array<uint8_t, 16>{ uId } }, { uSeqnum } };
+  };
+  const auto makeChunk = [&]( const uint8_t uId, const size_t uFirst, const size_t uLast ) {
+    jess::Chunk chunk{};
+    chunk.addSeqid( makeSeqid( uId, uFirst ) );
+    chunk.addSeqid( makeSeqid( uId, uLast ) );
+    return chunk;
+  };
+
+  std::list<jess::Chunk> chunks{ makeChunk( 0, 10, 19 ), makeChunk( 0, 30, 39 ), makeChunk( 1, 0, 100 ) };
+  jess::ChunkIndex<std::list<jess::Chunk>::iterator> sut{};
+  for ( auto it = chunks.begin(); it != chunks.end(); ++it )
+  {
+    sut.insert( it );
+  }
+  REQUIRE( sut.size() == 3 );
+
+  CHECK( sut.find( makeSeqid( 0, 10 ) ) == chunks.begin() );
+  CHECK( sut.find( makeSeqid( 0, 19 ) ) == chunks.begin() );
+  CHECK( sut.find( makeSeqid( 0, 35 ) ) == std::next( chunks.begin() ) );
+  CHECK( sut.find( makeSeqid( 1, 50 ) ) == std::prev( chunks.end() ) );
+  CHECK_FALSE( sut.find( makeSeqid( 0, 9 ) ) );
+  CHECK_FALSE( sut.find( makeSeqid( 0, 20 ) ) );
+  CHECK_FALSE( sut.find( makeSeqid( 0, 40 ) ) );
+  CHECK_FALSE( sut.find( makeSeqid( 2, 10 ) ) );
+
+  CHECK( sut.findNext( makeSeqid( 0, 0 ) ) == chunks.begin() );
+  CHECK( sut.findNext( makeSeqid( 0, 20 ) ) == std::next( chunks.begin() ) );
+  CHECK_FALSE( sut.findNext( makeSeqid( 0, 30 ) ) );
+
+  sut.erase( chunks.begin() );
+  CHECK( sut.size() == 2 );
+  CHECK_FALSE( sut.find( makeSeqid( 0, 10 ) ) );
+}
+
+TEST_CASE( "Chunk seqnum ranges" )
+{
+  const auto makeSeqid = []( const uint8_t uId, const size_t uSeqnum ) {
+    return jess::SdSeqid{ { std::array<uint8_t, 16>{ 0xc4, uId } }, { uSeqnum } };
+  };
+  jess::ChunkArenaPool pool{};
+  jess::Chunk chunk = jess::makeChunk( pool, 4, 0 );
+  const auto epoch = std::chrono::system_clock::time_point{};
+  chunk.append( jess::SdLine{ makeSeqid( 2, 7 ), "a", epoch } );
+  chunk.append( jess::SdLine{ makeSeqid( 2, 8 ), "b", epoch } );
+  chunk.append( jess::SdLine{ makeSeqid( 1, 100 ), "c", epoch } );
+  chunk.append( jess::SdLine{ makeSeqid( 2, 5 ), "d", epoch } );
+
+  CHECK( chunk.firstSeqid() == makeSeqid( 2, 7 ) );
+  CHECK( chunk.line( 2 ).seqid() == makeSeqid( 1, 100 ) );
+  CHECK( chunk.lastSeqid() == makeSeqid( 2, 5 ) );
+  CHECK( chunk.message( 1 ) == "b" );
+  CHECK( chunk.indexOf( makeSeqid( 1, 100 ) ) == 2U );
+  CHECK_FALSE( chunk.indexOf( makeSeqid( 1, 7 ) ) );
+  CHECK_FALSE( chunk.indexOf( makeSeqid( 3, 7 ) ) );
+
+  const auto& table = jess::SeqnumIdTable::global();
+  REQUIRE( chunk.seqnumRanges.size() == 2 );
+  CHECK( chunk.seqnumRanges[0].seqnumId < chunk.seqnumRanges[1].seqnumId );
+  for ( const jess::SeqnumRange& range : chunk.seqnumRanges )
+  {
+    const bool bFirstId = table.id( range.seqnumId ) == makeSeqid( 2, 0 ).seqnumId;
+    CHECK( range.lowest == jess::SdSeqnum{ bFirstId ? 5U : 100U } );
+    CHECK( range.highest == jess::SdSeqnum{ bFirstId ? 8U : 100U } );
+  }
+}
+
+TEST_CASE( "ChunkedJournal(4) append new entries" )
+{
+  {
+    // nothing is read before the end of the journal is cached
+    jess::ChunkedJournal<MockStream<10>> sut{ 4, 0 };
+    sut.seekToBof();
+    sut.journal().uStreamLength = 15;
+    CHECK( sut.appendNewEntries( 100 ) == 0 );
+  }
+
+  jess::ChunkedJournal<MockStream<10>> sut{ 4, 0 };
+  const std::list<jess::Chunk>& chunks = sut.getChunks();
+  sut.seekToEof();
+  REQUIRE( chunks.size() == 1 );
+  checkSequence( chunks.back(), 4, 6 );
+  CHECK( sut.appendNewEntries( 100 ) == 0 );
+
+  SUBCASE( "new chunks after a full tail chunk" )
+  {
+    sut.journal().uStreamLength = 15;
+    CHECK( sut.appendNewEntries( 100 ) == 5 );
+    REQUIRE( chunks.size() == 3 );
+    auto it = chunks.begin();
+    checkSequence( *it, 4, 6 );
+    CHECK( it->contiguityEnd == jess::Contiguity::CONTIGUOUS );
+    checkSequence( *++it, 4, 10 );
+    CHECK( it->contiguityEnd == jess::Contiguity::CONTIGUOUS );
+    checkSequence( *++it, 1, 14 );
+    CHECK( it->isLastInJournal );
+
+    // the tail chunk is filled up first
+    sut.journal().uStreamLength = 17;
+    CHECK( sut.appendNewEntries( 100 ) == 2 );
+    REQUIRE( chunks.size() == 3 );
+    checkSequence( chunks.back(), 3, 14 );
+    CHECK( chunks.back().isLastInJournal );
+
+    // the current position does not move
+    CHECK( sut.getLines( 1 ).front().seqid().seqnum.value == 9 );
+    CHECK( sut.getLines( 100 ).size() == 8 );
+  }
+
+  SUBCASE( "the remaining entries are loaded on demand" )
+  {
+    sut.journal().uStreamLength = 30;
+    CHECK( sut.appendNewEntries( 5 ) == 5 );
+    REQUIRE( chunks.size() == 3 );
+    checkSequence( chunks.back(), 1, 14 );
+    CHECK_FALSE( chunks.back().isLastInJournal );
+
+    const auto lines = sut.getLines( 30 );
+    REQUIRE( lines.size() == 21 );
+    CHECK( lines.back().seqid().seqnum.value == 29 );
+  }
+}
+
+TEST_CASE( "ChunkedJournal(3) search" )
+{
+  jess::ChunkedJournal<MockStream<20>> sut{ 3, 0 };
+  const auto currentLine = [&] { return sut.getLines( 1 ).front().seqid().seqnum.value; };
+  const auto matching = []( const std::string_view sNeedle ) {
+    return [=]( const std::string_view sMessage ) { return sMessage == sNeedle; };
+  };
+  sut.seekToBof();
+
+  SUBCASE( "forward" )
+  {
+    CHECK( sut.search( matching( "line 1" ), jess::Adjacency::AFTER_CURRENT, 100 ) == jess::SearchResult::FOUND );
+    CHECK( currentLine() == 1 );
+    CHECK( sut.search( matching( "line 17" ), jess::Adjacency::AFTER_CURRENT, 100 ) == jess::SearchResult::FOUND );
+    CHECK( currentLine() == 17 );
+    // the current line itself does not match
+    CHECK( sut.search( matching( "line 17" ), jess::Adjacency::AFTER_CURRENT, 100 ) == jess::SearchResult::NOT_FOUND );
+    CHECK( currentLine() == 17 );
+  }
+
+  SUBCASE( "backward" )
+  {
+    sut.seekLines( 19 );
+    CHECK( sut.search( matching( "line 2" ), jess::Adjacency::BEFORE_CURRENT, 100 ) == jess::SearchResult::FOUND );
+    CHECK( currentLine() == 2 );
+    CHECK( sut.search( matching( "line 5" ), jess::Adjacency::BEFORE_CURRENT, 100 ) == jess::SearchResult::NOT_FOUND );
+    CHECK( currentLine() == 2 );
+  }
+
+  SUBCASE( "interrupted after loading too many lines" )
+  {
+    CHECK( sut.search( matching( "line 15" ), jess::Adjacency::AFTER_CURRENT, 5 ) == jess::SearchResult::INTERRUPTED );
+    CHECK( currentLine() == 8 );
+    CHECK( sut.search( matching( "line 15" ), jess::Adjacency::AFTER_CURRENT, 5 ) == jess::SearchResult::INTERRUPTED );
+    CHECK( currentLine() == 14 );
+    CHECK( sut.search( matching( "line 15" ), jess::Adjacency::AFTER_CURRENT, 5 ) == jess::SearchResult::FOUND );
+    CHECK( currentLine() == 15 );
+  }
+
+  SUBCASE( "cached chunks do not count towards the limit" )
+  {
+    REQUIRE( sut.getLines( 20 ).size() == 20 );
+    CHECK( sut.search( matching( "line 19" ), jess::Adjacency::AFTER_CURRENT, 0 ) == jess::SearchResult::FOUND );
+  }
+}
+
+TEST_CASE( "ChunkedJournal(16) search priority" )
+{
+  // every 50th line is an error
+  jess::ChunkedJournal<MockStream<120>> sut{ 16, 0 };
+  const auto currentLine = [&] { return sut.getLines( 1 ).front().seqid().seqnum.value; };
+  sut.seekToBof();
+
+  SUBCASE( "forward" )
+  {
+    CHECK( sut.searchPriority( 3, jess::Adjacency::AFTER_CURRENT, 1000 ) == jess::SearchResult::FOUND );
+    CHECK( currentLine() == 50 );
+    CHECK( sut.searchPriority( 3, jess::Adjacency::AFTER_CURRENT, 1000 ) == jess::SearchResult::FOUND );
+    CHECK( currentLine() == 100 );
+    CHECK( sut.searchPriority( 3, jess::Adjacency::AFTER_CURRENT, 1000 ) == jess::SearchResult::NOT_FOUND );
+    CHECK( currentLine() == 100 );
+    // all lines are at least as severe as debug
+    CHECK( sut.searchPriority( 7, jess::Adjacency::AFTER_CURRENT, 1000 ) == jess::SearchResult::FOUND );
+    CHECK( currentLine() == 101 );
+  }
+
+  SUBCASE( "backward" )
+  {
+    sut.seekLines( 99 );
+    CHECK( sut.searchPriority( 3, jess::Adjacency::BEFORE_CURRENT, 1000 ) == jess::SearchResult::FOUND );
+    CHECK( currentLine() == 50 );
+    CHECK( sut.searchPriority( 3, jess::Adjacency::BEFORE_CURRENT, 1000 ) == jess::SearchResult::FOUND );
+    CHECK( currentLine() == 0 );
+    CHECK( sut.searchPriority( 3, jess::Adjacency::BEFORE_CURRENT, 1000 ) == jess::SearchResult::NOT_FOUND );
+  }
+
+  SUBCASE( "interrupted after loading too many lines" )
+  {
+    CHECK( sut.searchPriority( 3, jess::Adjacency::AFTER_CURRENT, 10 ) == jess::SearchResult::INTERRUPTED );
+    CHECK( currentLine() == 31 );
+    CHECK( sut.searchPriority( 3, jess::Adjacency::AFTER_CURRENT, 10 ) == jess::SearchResult::INTERRUPTED );
+    CHECK( currentLine() == 47 );
+    CHECK( sut.searchPriority( 3, jess::Adjacency::AFTER_CURRENT, 10 ) == jess::SearchResult::FOUND );
+    CHECK( currentLine() == 50 );
+  }
+}
+
+TEST_CASE( "ChunkedJournal(4) open journal" )
+{
+  // both the ui thread and the prefetcher open their journal with the factory
+  const auto openShortJournal = [] {
+    MockStream<20> journal{};
+    journal.uStreamLength = 6;
+    return journal;
+  };
+  jess::ChunkedJournal<MockStream<20>> sut{ 4, 4, {}, openShortJournal };
+  sut.seekToBof();
+  sut.waitForPrefetch();
+  CHECK( sut.getChunks().size() == 2 );
+  CHECK( sut.getLines( 10 ).size() == 6 );
+}
+
+TEST_CASE( "ChunkedJournal(4) reconfigure" )
+{
+  // the background loads use their own journal, which has to be configured as well
+  jess::ChunkedJournal<MockStream<20>> sut{ 4, 4 };
+  const std::list<jess::Chunk>& chunks = sut.getChunks();
+  sut.seekToBof();
+  REQUIRE( sut.getLines( 20 ).size() == 20 );
+
+  sut.reconfigure( []( MockStream<20>& journal ) { journal.uStreamLength = 6; } );
+  CHECK( chunks.empty() );
+  CHECK( sut.getCachedBytes() == 0 );
+  CHECK( sut.getLines( 10 ).empty() );
+
+  sut.seekToEof();
+  sut.waitForPrefetch();
+  const auto lines = sut.getLines( 10 );
+  REQUIRE( lines.size() == 1 );
+  CHECK( lines.front().seqid().seqnum.value == 5 );
+  sut.seekToBof();
+  sut.waitForPrefetch();
+  CHECK( sut.getLines( 10 ).size() == 6 );
+
+  SUBCASE( "nothing matches" )
+  {
+    sut.reconfigure( []( MockStream<20>& journal ) { journal.uStreamLength = 0; } );
+    sut.seekToEof();
+    CHECK( chunks.empty() );
+    CHECK( sut.getLines( 10 ).empty() );
+    CHECK( sut.getChunkPositionString() == "no entries" );
+    sut.seekLines( 1 );
+    CHECK( sut.search( []( std::string_view ) { return true; }, jess::Adjacency::AFTER_CURRENT, 100 ) == jess::SearchResult::NOT_FOUND );
+
+    // the first matching entries are read like any other new entries
+    sut.journal().uStreamLength = 3;
+    CHECK( sut.appendNewEntries( 100 ) == 3 );
+    CHECK( sut.getLines( 10 ).size() == 3 );
+  }
+}
+
+TEST_CASE( "ChunkedJournal(4) seek to time" )
+{
+  using namespace std::chrono_literals;
+  // entry i is at i seconds
+  const auto at = []( const auto offset ) { return std::chrono::system_clock::time_point{ offset }; };
+
+  jess::ChunkedJournal<MockStream<20>> sut{ 4, 0 };
+  const std::list<jess::Chunk>& chunks = sut.getChunks();
+  const auto currentLine = [&] { return sut.getLines( 1 ).front().seqid().seqnum.value; };
+
+  sut.seekToTime( at( 10s ) );
+  REQUIRE( chunks.size() == 1 );
+  checkSequence( chunks.front(), 4, 10 );
+  CHECK( chunks.front().minRealtime == at( 10s ) );
+  CHECK( chunks.front().maxRealtime == at( 13s ) );
+  CHECK( currentLine() == 10 );
+
+  SUBCASE( "cached times need no journal access" )
+  {
+    REQUIRE( sut.getLines( 8 ).size() == 8 );
+    REQUIRE( chunks.size() == 2 );
+
+    sut.seekToTime( at( 11500ms ) );
+    CHECK( currentLine() == 12 );
+    // between two contiguous chunks
+    sut.seekToTime( at( 13500ms ) );
+    CHECK( currentLine() == 14 );
+    CHECK( chunks.size() == 2 );
+  }
+
+  SUBCASE( "before the cached chunks" )
+  {
+    sut.seekToTime( at( 2s ) );
+    CHECK( currentLine() == 2 );
+    CHECK( chunks.size() == 2 );
+  }
+
+  SUBCASE( "after the end of the journal" )
+  {
+    sut.seekToTime( at( 100s ) );
+    CHECK( currentLine() == 19 );
+    const size_t uNumChunks = chunks.size();
+    CHECK( chunks.back().isLastInJournal );
+
+    sut.seekToTime( at( 50s ) );
+    CHECK( currentLine() == 19 );
+    CHECK( chunks.size() == uNumChunks );
+  }
+}
+
+TEST_CASE( "ChunkedJournal(4) position" )
+{
+  jess::ChunkedJournal<MockStream<20>> sut{ 4, 0 };
+  const std::list<jess::Chunk>& chunks = sut.getChunks();
+  CHECK_FALSE( sut.getPosition() );
+
+  sut.seekToBof();
+  sut.seekLines( 9 );
+  const auto position = sut.getPosition();
+  REQUIRE( position );
+  CHECK( position->line.seqid.seqnum.value == 9 );
+  CHECK( position->chunkStart.seqid.seqnum.value == 8 );
+
+  SUBCASE( "restored in a new session" )
+  {
+    jess::ChunkedJournal<MockStream<20>> restored{ 4, 0 };
+    CHECK( restored.seekToPosition( *position ) );
+    CHECK( restored.getLines( 1 ).front().seqid().seqnum.value == 9 );
+    // the chunk lines up with the one of the previous session
+    REQUIRE( restored.getChunks().size() == 1 );
+    checkSequence( restored.getChunks().front(), 4, 8 );
+  }
+
+  SUBCASE( "cached" )
+  {
+    sut.seekToBof();
+    const size_t uNumChunks = chunks.size();
+    CHECK( sut.seekToPosition( *position ) );
+    CHECK( sut.getLines( 1 ).front().seqid().seqnum.value == 9 );
+    CHECK( chunks.size() == uNumChunks );
+  }
+
+  SUBCASE( "chunk start before a different chunk layout" )
+  {
+    jess::ChunkedJournal<MockStream<20>> restored{ 4, 0 };
+    auto moved = *position;
+    moved.chunkStart.seqid.seqnum.value = 7;
+    CHECK( restored.seekToPosition( moved ) );
+    CHECK( restored.getLines( 1 ).front().seqid().seqnum.value == 9 );
+  }
+}
+
+TEST_CASE( "Chunk arena" )
+{
+  jess::ChunkArenaPool pool{};
+  MockStream<10> journal{};
+  journal.seekToBof();
+  REQUIRE( journal.next() );
+
+  jess::Chunk chunk = jess::readChunkForward( journal, pool, 5 );
+  checkSequence( chunk, 5, 0 );
+  CHECK( chunk.arena.size() == 5 * "line 0"sv.size() );
+
+  SUBCASE( "backward chunks keep their messages" )
+  {
+    jess::Chunk backward = jess::readChunkBackward( journal, pool, 3 );
+    checkSequence( backward, 3, 3 );
+  }
+
+  SUBCASE( "truncated messages are marked" )
+  {
+    jess::Chunk truncated{};
+    truncated.append( jess::SdLine{ jess::SdSeqid{}, "beginning of a core dump", {}, true } );
+    truncated.append( jess::SdLine{ jess::SdSeqid{ {}, { 1 } }, "short", {} } );
+    CHECK( truncated.line( 0 ).truncated() );
+    CHECK( truncated.line( 0 ).message() == "beginning of a core dump" );
+    CHECK_FALSE( truncated.line( 1 ).truncated() );
+  }
+
+  SUBCASE( "released arenas are reused" )
+  {
+    const char* pStorage = chunk.arena.data();
+    pool.release( std::move( chunk.arena ) );
+    CHECK( pool.size() == 1 );
+
+    jess::Chunk next = jess::readChunkForward( journal, pool, 5 );
+    checkSequence( next, 5, 5 );
+    CHECK( next.arena.data() == pStorage );
+    CHECK( pool.size() == 0 );
+  }
+}
+
+TEST_CASE( "Chunk range queries" )
+{
+  using namespace std::chrono_literals;
+  const auto at = []( const auto offset ) { return std::chrono::system_clock::time_point{ offset }; };
+
+  // every 50th line is an error, the chunk spans several scan blocks
+  jess::ChunkArenaPool pool{};
+  MockStream<200> journal{};
+  journal.seekToBof();
+  REQUIRE( journal.next() );
+  const jess::Chunk chunk = jess::readChunkForward( journal, pool, 150 );
+  REQUIRE( chunk.size() == 150 );
+
+  SUBCASE( "priority" )
+  {
+    CHECK( chunk.findPriority( 0, 3, jess::Adjacency::AFTER_CURRENT ) == 0U );
+    CHECK( chunk.findPriority( 1, 3, jess::Adjacency::AFTER_CURRENT ) == 50U );
+    CHECK( chunk.findPriority( 51, 3, jess::Adjacency::AFTER_CURRENT ) == 100U );
+    CHECK_FALSE( chunk.findPriority( 101, 3, jess::Adjacency::AFTER_CURRENT ) );
+    CHECK( chunk.findPriority( 149, 3, jess::Adjacency::BEFORE_CURRENT ) == 100U );
+    CHECK( chunk.findPriority( 99, 3, jess::Adjacency::BEFORE_CURRENT ) == 50U );
+    CHECK( chunk.findPriority( 0, 3, jess::Adjacency::BEFORE_CURRENT ) == 0U );
+    CHECK_FALSE( chunk.findPriority( 149, 2, jess::Adjacency::BEFORE_CURRENT ) );
+    CHECK( chunk.findPriority( 149, 6, jess::Adjacency::BEFORE_CURRENT ) == 149U );
+  }
+
+  SUBCASE( "time" )
+  {
+    CHECK( chunk.lowerBoundRealtime( at( 0s ) ) == 0 );
+    CHECK( chunk.lowerBoundRealtime( at( 37s ) ) == 37 );
+    CHECK( chunk.lowerBoundRealtime( at( 36500ms ) ) == 37 );
+    CHECK( chunk.lowerBoundRealtime( at( 149s ) ) == 149 );
+    CHECK( chunk.lowerBoundRealtime( at( 150s ) ) == 150 );
+    CHECK( chunk.realtime( 37 ) == at( 37s ) );
+  }
+
+  SUBCASE( "seqnum" )
+  {
+    CHECK( chunk.indexOf( jess::SdSeqid{ {}, { 140 } } ) == 140U );
+    CHECK_FALSE( chunk.indexOf( jess::SdSeqid{ {}, { 150 } } ) );
+    CHECK_FALSE( chunk.indexOf( jess::SdSeqid{ { std::array<uint8_t, 16>{ 1 } }, { 140 } } ) );
+  }
+
+  SUBCASE( "backward chunks keep the columns of a line together" )
+  {
+    // the journal is at the line after the chunk
+    const jess::Chunk backward = jess::readChunkBackward( journal, pool, 120 );
+    REQUIRE( backward.size() == 120 );
+    CHECK( backward.firstSeqid().seqnum.value == 31 );
+    CHECK( backward.findPriority( 0, 3, jess::Adjacency::AFTER_CURRENT ) == 19U );
+    CHECK( backward.line( 69 ).priority() == 3 );
+    CHECK( backward.line( 69 ).message() == "line 100" );
+    CHECK( backward.lowerBoundRealtime( at( 100s ) ) == 69 );
+  }
+
+  SUBCASE( "binary search" )
+  {
+    for ( int64_t iSize = 0; iSize < 40; ++iSize )
+    {
+      std::vector<int64_t> values{};
+      for ( int64_t i = 0; i < iSize; ++i )
+      {
+        values.push_back( 2 * ( i / 2 ) );
+      }
+      for ( int64_t iValue = -1; iValue <= iSize; ++iValue )
+      {
+        const auto expected = static_cast<size_t>( std::lower_bound( values.begin(), values.end(), iValue ) - values.begin() );
+        REQUIRE( jess::detail::lowerBound( std::span<const int64_t>{ values }, iValue ) == expected );
+      }
+    }
+  }
+}
+
+TEST_CASE( "Chunk columns" )
+{
+  jess::ChunkArenaPool pool{};
+  MockStream<10> journal{};
+  const std::vector<std::string> columns{ "_PID", "_HOSTNAME" };
+
+  const auto checkColumns = [&]( const jess::Chunk& chunk, const size_t uFirstIndex ) {
+    for ( size_t i = 0; i < chunk.size(); ++i )
+    {
+      const jess::SdLine line = chunk.line( i );
+      REQUIRE( line.fieldCount() == 2 );
+      CHECK( line.field( 0 ) == std::to_string( 2 * ( i + uFirstIndex ) ) );
+      CHECK( line.field( 1 ).empty() );
+    }
+  };
+
+  journal.seekToBof();
+  REQUIRE( journal.next() );
+  const jess::Chunk forward = jess::readChunkForward( journal, pool, 5, std::nullopt, columns );
+  checkSequence( forward, 5, 0 );
+  checkColumns( forward, 0 );
+  CHECK( journal.uFieldReads == 5 * columns.size() );
+
+  const jess::Chunk backward = jess::readChunkBackward( journal, pool, 3, std::nullopt, columns );
+  checkSequence( backward, 3, 3 );
+  checkColumns( backward, 3 );
+
+  SUBCASE( "without columns no field is read" )
+  {
+    journal.uFieldReads = 0;
+    const jess::Chunk chunk = jess::readChunkForward( journal, pool, 5 );
+    CHECK( chunk.line( 0 ).fieldCount() == 0 );
+    CHECK( journal.uFieldReads == 0 );
+  }
+}
+
+TEST_CASE( "ChunkedJournal(4) columns" )
+{
+  jess::ChunkedJournal<MockStream<20>> sut{ 4, 4 };
+  sut.seekToBof();
+  sut.seekLines( 5 );
+  REQUIRE( sut.getLines( 1 ).front().fieldCount() == 0 );
+
+  sut.setColumns( { "_PID" } );
+  CHECK( sut.getChunks().empty() );
+  sut.seekToBof();
+  sut.waitForPrefetch();
+  const auto lines = sut.getLines( 10 );
+  REQUIRE( lines.size() == 10 );
+  for ( const jess::SdLine& line : lines )
+  {
+    REQUIRE( line.fieldCount() == 1 );
+    CHECK( line.field( 0 ) == std::to_string( 2 * line.seqid().seqnum.value ) );
+  }
+}
+
+TEST_CASE( "ChunkedJournal(4) initial configuration" )
+{
+  jess::ChunkedJournal<MockStream<20>> sut{ 4, 4, {}, [] { return MockStream<20>{}; }, []( MockStream<20>& journal ) { journal.uStreamLength = 6; },
+    { "_PID" } };
+  CHECK( sut.columns() == std::vector<std::string>{ "_PID" } );
+
+  sut.seekToEof();
+  sut.waitForPrefetch();
+  const auto lines = sut.getLines( 1 );
+  REQUIRE( lines.size() == 1 );
+  CHECK( lines.front().seqid().seqnum.value == 5 );
+  REQUIRE( lines.front().fieldCount() == 1 );
+  CHECK( lines.front().field( 0 ) == "10" );
+
+  // the prefetcher opens its journal with the configuration as well
+  sut.seekToBof();
+  sut.seekLines( 4 );
+  sut.waitForPrefetch();
+  CHECK( sut.getLines( 10 ).size() == 2 );
+}
+
 // TODO: tests where chunk is smaller than entire stream
 // TODO: tests where journal EOF moves
+
+TEST_CASE( "ChunkedJournal(1) stats" )
+{
+  jess::ChunkedJournal<MockStream<10>> sut{ 1, 0, { 0, 2 } };
+  const jess::CacheStats& stats = sut.stats();
+
+  sut.seekToBof();
+  sut.seekLines( 1 );
+  CHECK( stats.chunksBuilt == 2 );
+  CHECK( stats.entriesRead == 2 );
+  CHECK( stats.cacheMisses == 2 );
+  CHECK( stats.cacheHits == 0 );
+  CHECK( stats.chunksEvicted == 0 );
+  CHECK( stats.chunkBuildTime.count() == 2 );
+
+  sut.seekToBof();
+  CHECK( stats.cacheHits == 1 );
+  CHECK( stats.chunksBuilt == 2 );
+
+  sut.seekToEof();
+  CHECK( stats.chunksBuilt == 3 );
+  CHECK( stats.chunksEvicted == 1 );
+  CHECK( sut.getNumChunks() == 2 );
+}
+
+TEST_CASE( "PrefetchRequest equality" )
+{
+  const jess::SdCursor anchor{ jess::SdSeqid{ {}, { 5 } }, {}, 5, 5, 0 };
+  const jess::PrefetchRequest request{ anchor, jess::Adjacency::AFTER_CURRENT, jess::SdSeqid{ {}, { 9 } } };
+  CHECK( request == jess::PrefetchRequest{ anchor, jess::Adjacency::AFTER_CURRENT, jess::SdSeqid{ {}, { 9 } } } );
+  CHECK_FALSE( request == jess::PrefetchRequest{ anchor, jess::Adjacency::BEFORE_CURRENT, jess::SdSeqid{ {}, { 9 } } } );
+  // a neighbour cached in the meantime changes the bound, the request must be made again
+  CHECK_FALSE( request == jess::PrefetchRequest{ anchor, jess::Adjacency::AFTER_CURRENT, jess::SdSeqid{ {}, { 7 } } } );
+  CHECK_FALSE( request == jess::PrefetchRequest{ anchor, jess::Adjacency::AFTER_CURRENT, std::nullopt } );
+}
+
+TEST_CASE( "ChunkPrefetcher error" )
+{
+  jess::ChunkArenaPool arenaPool{};
+  jess::CacheStats stats{};
+  jess::ChunkPrefetcher<MockStream<10>> sut{ 2, arenaPool, stats, []() -> MockStream<10> { throw std::runtime_error{ "no journal" }; } };
+  const jess::PrefetchRequest request{ jess::SdCursor{ jess::SdSeqid{ {}, { 5 } }, {}, 5, 5, 0 }, jess::Adjacency::AFTER_CURRENT, std::nullopt };
+
+  // the exception of the worker is handed to the thread waiting for it
+  sut.request( request );
+  CHECK_THROWS_AS( sut.waitFor( request ), std::runtime_error );
+  CHECK_THROWS_AS( (void)sut.takeResults(), std::runtime_error );
+  sut.waitIdle();
+}
+
+TEST_CASE( "ChunkedJournal(2) evicts without a current chunk" )
+{
+  jess::ChunkedJournal<MockStream<10>> sut{ 2, 0, jess::ChunkCacheBudget{ 0, 2 } };
+  sut.seekToBof();
+  sut.seekToEof();
+  REQUIRE( sut.getNumChunks() == 2 );
+
+  // e.g. the journal files were vacuumed: there is no current line, the cached chunks are kept
+  sut.journal().uStreamLength = 0;
+  sut.seekToBof();
+  CHECK( sut.getLines( 1 ).empty() );
+  CHECK( sut.getNumChunks() == 2 );
+
+  sut.journal().uStreamLength = 12;
+  CHECK( sut.appendNewEntries( 16 ) == 2 );
+  CHECK( sut.getNumChunks() == 2 );
+}
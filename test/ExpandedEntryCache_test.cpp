@@ -0,0 +1,45 @@
+#include "ExpandedEntryCache.hpp"
+#include <doctest/doctest.h>
+
+#include <string>
+
+namespace
+{
+jess::SdSeqid seqid( const size_t uSeqnum ) { return jess::SdSeqid{ {}, { uSeqnum } }; }
+}// namespace
+
+TEST_CASE( "ExpandedEntryCache" )
+{
+  jess::ExpandedEntryCache sut{ 10 };
+  CHECK( sut.find( seqid( 1 ) ) == nullptr );
+
+  CHECK( sut.insert( seqid( 1 ), "aaaa" ) == "aaaa" );
+  sut.insert( seqid( 2 ), "bbbb" );
+  REQUIRE( sut.find( seqid( 1 ) ) != nullptr );
+  CHECK( *sut.find( seqid( 1 ) ) == "aaaa" );
+  CHECK( sut.sizeInBytes() == 8 );
+
+  SUBCASE( "the least recently used message is evicted" )
+  {
+    sut.insert( seqid( 3 ), "cccc" );
+    CHECK( sut.size() == 2 );
+    CHECK( sut.sizeInBytes() == 8 );
+    CHECK( sut.find( seqid( 2 ) ) == nullptr );
+    CHECK( sut.find( seqid( 1 ) ) != nullptr );
+  }
+
+  SUBCASE( "a message larger than the budget is kept alone" )
+  {
+    sut.insert( seqid( 3 ), std::string( 20, 'c' ) );
+    CHECK( sut.size() == 1 );
+    CHECK( sut.find( seqid( 3 ) ) != nullptr );
+  }
+
+  SUBCASE( "inserting again replaces the message" )
+  {
+    sut.insert( seqid( 2 ), "bb" );
+    CHECK( sut.size() == 2 );
+    CHECK( sut.sizeInBytes() == 6 );
+    CHECK( *sut.find( seqid( 2 ) ) == "bb" );
+  }
+}
@@ -0,0 +1,251 @@
+#include "ChunkedJournal.hpp"
+#include "FilteredStream.hpp"
+#include "MockStream.hpp"
+#include <doctest/doctest.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+jess::SdLine makeLine( const std::string_view sMessage, const uint8_t uPriority = jess::SdLine::NO_PRIORITY )
+{
+  return jess::SdLine{ jess::SdSeqid{}, sMessage, std::chrono::system_clock::time_point{}, false, nullptr, {}, uPriority };
+}
+
+size_t seqnum( const jess::SdSeqid& seqid ) { return seqid.seqnum.value; }
+
+/// the lines of MockStream except those from 100 to 249
+struct OutsideGap {
+  bool operator()( const jess::SdLine& line ) const
+  {
+    const size_t uNumber = std::stoul( std::string{ line.message().substr( 5 ) } );
+    return uNumber < 100 || uNumber >= 250;
+  }
+};
+}// namespace
+
+static_assert( jess::SeekableStream<jess::FilteredStream<MockStream<1>, jess::PriorityRange>> );
+
+TEST_CASE( "FilteredStream predicates" )
+{
+  CHECK( jess::MessageContains{ "disk" }( makeLine( "no disk space left" ) ) );
+  CHECK_FALSE( jess::MessageContains{ "Disk" }( makeLine( "no disk space left" ) ) );
+  CHECK( jess::MessageContains( "Disk", true )( makeLine( "no disk space left" ) ) );
+
+  CHECK( jess::MessageMatches{ "^line [0-9]+7$" }( makeLine( "line 127" ) ) );
+  CHECK_FALSE( jess::MessageMatches{ "^line [0-9]+7$" }( makeLine( "line 1270" ) ) );
+  CHECK( jess::MessageMatches( "LINE", true )( makeLine( "line 1" ) ) );
+  CHECK_THROWS_AS( jess::MessageMatches{ "line (" }, std::invalid_argument );
+
+  const jess::PriorityRange warnings{ 4, 4 };
+  CHECK( warnings( makeLine( "", 4 ) ) );
+  CHECK_FALSE( warnings( makeLine( "", 3 ) ) );
+  CHECK_FALSE( warnings( makeLine( "", 5 ) ) );
+  CHECK_FALSE( jess::PriorityRange{}( makeLine( "" ) ) );
+}
+
+TEST_CASE( "FilteredStream steps over the entries not matching" )
+{
+  // the entries at multiples of 50 are errors
+  jess::FilteredStream<MockStream<200>, jess::PriorityRange> sut{ MockStream<200>{}, jess::PriorityRange{ 0, 3 } };
+
+  sut.seekToBof();
+  REQUIRE( sut.next() );
+  CHECK( seqnum( sut.getSeqid() ) == 0 );
+  CHECK( sut.getLine().message() == "line 0" );
+  REQUIRE( sut.next() );
+  CHECK( seqnum( sut.getSeqid() ) == 50 );
+  sut.seekLinesForward( 2 );
+  CHECK( seqnum( sut.getSeqid() ) == 150 );
+
+  SUBCASE( "a failed step keeps the stream at the last match" )
+  {
+    CHECK_FALSE( sut.next() );
+    CHECK_FALSE( sut.budgetExhausted() );
+    CHECK( seqnum( sut.getSeqid() ) == 150 );
+    REQUIRE( sut.previous() );
+    CHECK( seqnum( sut.getSeqid() ) == 100 );
+  }
+
+  SUBCASE( "backward" )
+  {
+    sut.seekToEof();
+    REQUIRE( sut.previous() );
+    CHECK( seqnum( sut.getSeqid() ) == 150 );
+    sut.seekLinesBackward( 10 );
+    CHECK( seqnum( sut.getSeqid() ) == 0 );
+    CHECK_FALSE( sut.previous() );
+    CHECK( seqnum( sut.getSeqid() ) == 0 );
+  }
+
+  SUBCASE( "the matching entry is read once" )
+  {
+    const size_t uLineReads = sut.journal().uLineReads;
+    CHECK( sut.getLine().message() == "line 150" );
+    CHECK( sut.getLine().message() == "line 150" );
+    CHECK( sut.journal().uLineReads == uLineReads );
+
+    // reading a field reuses the storage of the line, it is read again afterwards
+    CHECK( sut.getFieldString( "_PID" ) == "300" );
+    CHECK( sut.getLine().message() == "line 150" );
+    CHECK( sut.journal().uLineReads == uLineReads + 1 );
+  }
+
+  SUBCASE( "a cursor of an entry not matching is followed by the next match" )
+  {
+    sut.seekToCursor( jess::SdCursor{ jess::SdSeqid{ {}, { 70 } }, {}, 70, 70, 0 }.toString() );
+    REQUIRE( sut.next() );
+    CHECK( seqnum( sut.getSeqid() ) == 100 );
+  }
+}
+
+TEST_CASE( "FilteredStream accepting all entries" )
+{
+  jess::FilteredStream<MockStream<200>, jess::MessageContains> sut{ MockStream<200>{}, jess::MessageContains{ "" } };
+  REQUIRE( sut.acceptsAll() );
+
+  // the entries are skipped without reading them
+  sut.seekToBof();
+  REQUIRE( sut.next() );
+  sut.seekLinesForward( 120 );
+  CHECK( seqnum( sut.getSeqid() ) == 120 );
+  sut.seekLinesBackward( 20 );
+  REQUIRE( sut.previous() );
+  CHECK( seqnum( sut.getSeqid() ) == 99 );
+  CHECK( sut.entriesScanned() == 0 );
+  CHECK( sut.journal().uLineReads == 0 );
+  CHECK( sut.getLine().message() == "line 99" );
+
+  sut.seekToEof();
+  REQUIRE( sut.previous() );
+  CHECK_FALSE( sut.next() );
+  CHECK_FALSE( sut.budgetExhausted() );
+  CHECK( seqnum( sut.getSeqid() ) == 199 );
+
+  sut.setPredicate( jess::MessageContains{ "line 5" } );
+  CHECK_FALSE( sut.acceptsAll() );
+  sut.seekToBof();
+  sut.seekLinesForward( 2 );
+  CHECK( seqnum( sut.getSeqid() ) == 50 );
+}
+
+TEST_CASE( "FilteredStream scan budget" )
+{
+  jess::FilteredStream<MockStream<200>, jess::PriorityRange> sut{ MockStream<200>{}, jess::PriorityRange{ 0, 3 }, 20 };
+  sut.seekToBof();
+  REQUIRE( sut.next() );
+  CHECK( sut.entriesScanned() == 1 );
+
+  // each attempt scans 20 further entries, the third one reaches the match at 50
+  CHECK_FALSE( sut.next() );
+  CHECK( sut.budgetExhausted() );
+  CHECK( seqnum( sut.getSeqid() ) == 0 );
+  CHECK( sut.getLine().message() == "line 0" );
+  CHECK_FALSE( sut.next() );
+  CHECK( sut.budgetExhausted() );
+  CHECK( seqnum( sut.getSeqid() ) == 0 );
+  REQUIRE( sut.next() );
+  CHECK_FALSE( sut.budgetExhausted() );
+  CHECK( seqnum( sut.getSeqid() ) == 50 );
+  CHECK( sut.entriesScanned() == 51 );
+
+  SUBCASE( "backward" )
+  {
+    CHECK_FALSE( sut.previous() );
+    CHECK( sut.budgetExhausted() );
+    CHECK( seqnum( sut.getSeqid() ) == 50 );
+    CHECK_FALSE( sut.previous() );
+    REQUIRE( sut.previous() );
+    CHECK( seqnum( sut.getSeqid() ) == 0 );
+  }
+
+  SUBCASE( "a new predicate scans again" )
+  {
+    // the entries up to 70 did not match the previous predicate
+    CHECK_FALSE( sut.next() );
+    sut.setPredicate( jess::PriorityRange{ 0, 7 } );
+    REQUIRE( sut.next() );
+    CHECK( seqnum( sut.getSeqid() ) == 51 );
+  }
+
+  SUBCASE( "a step in the other direction scans from the current entry" )
+  {
+    CHECK_FALSE( sut.next() );
+    CHECK( sut.budgetExhausted() );
+    CHECK_FALSE( sut.previous() );
+    CHECK( sut.budgetExhausted() );
+    CHECK( seqnum( sut.getSeqid() ) == 50 );
+  }
+}
+
+TEST_CASE( "ChunkedJournal of a FilteredStream running out of budget" )
+{
+  using Stream = jess::FilteredStream<MockStream<200>, jess::PriorityRange>;
+  jess::ChunkedJournal<Stream> sut{ 4, 0, {}, [] { return Stream{ MockStream<200>{}, jess::PriorityRange{ 0, 3 }, 20 }; } };
+
+  sut.seekToBof();
+  REQUIRE( sut.getNumChunks() == 1 );
+  // the budget ran out after the first line, which is not the end of the journal
+  CHECK( sut.getChunks().front().size() == 1 );
+  CHECK_FALSE( sut.getChunks().front().isLastInJournal );
+  CHECK( sut.journal().budgetExhausted() );
+
+  // every attempt to move on scans further
+  size_t uAttempts = 0;
+  while ( sut.getLines( 1 ).front().message() == "line 0" && uAttempts < 5 )
+  {
+    sut.seekLines( 1 );
+    ++uAttempts;
+    CHECK_FALSE( sut.getChunks().front().isLastInJournal );
+  }
+  CHECK( uAttempts == 2 );
+  CHECK( sut.getLines( 1 ).front().message() == "line 50" );
+}
+
+TEST_CASE( "ChunkedJournal skipping lines of a FilteredStream running out of budget" )
+{
+  using Stream = jess::FilteredStream<MockStream<1000>, OutsideGap>;
+  jess::ChunkedJournal<Stream> sut{ 4, 0, {}, [] { return Stream{ MockStream<1000>{}, OutsideGap{}, 100 }; } };
+
+  // the skip over whole chunks stops in front of the gap, the lines beyond are not counted
+  sut.seekToBof();
+  sut.seekLines( 202 );
+  CHECK( sut.getLines( 1 ).front().message() == "line 99" );
+
+  sut.seekToEof();
+  sut.seekLines( -752 );
+  CHECK( sut.getLines( 1 ).front().message() == "line 250" );
+}
+
+TEST_CASE( "ChunkedJournal of a FilteredStream" )
+{
+  using Stream = jess::FilteredStream<MockStream<1000>, jess::MessageMatches>;
+  jess::ChunkedJournal<Stream> sut{ 16, 0, {}, [] { return Stream{ MockStream<1000>{}, jess::MessageMatches{ "7$" } }; } };
+
+  sut.seekToBof();
+  std::vector<jess::SdLine> lines = sut.getLines( 3 );
+  REQUIRE( lines.size() == 3 );
+  CHECK( lines[0].message() == "line 7" );
+  CHECK( lines[1].message() == "line 17" );
+  CHECK( lines[2].message() == "line 27" );
+
+  sut.seekLines( 20 );
+  lines = sut.getLines( 1 );
+  REQUIRE( lines.size() == 1 );
+  CHECK( lines[0].message() == "line 207" );
+
+  sut.seekToEof();
+  lines = sut.getLines( 2 );
+  REQUIRE( lines.size() == 1 );
+  CHECK( lines[0].message() == "line 997" );
+
+  // the chunks only hold the matching lines
+  for ( const jess::Chunk& chunk : sut.getChunks() )
+  {
+    for ( size_t i = 0; i < chunk.size(); ++i )
+    {
+      CHECK( chunk.line( i ).message().ends_with( '7' ) );
+    }
+  }
+}
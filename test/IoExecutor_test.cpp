@@ -0,0 +1,130 @@
+#include "IoExecutor.hpp"
+#include <doctest/doctest.h>
+
+#include <poll.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+
+/// runs the completions until no task is left
+void drain( jess::IoExecutor& executor )
+{
+  while ( executor.busy() )
+  {
+    executor.waitIdle();
+    executor.runCompletions();
+  }
+}
+
+}// namespace
+
+TEST_CASE( "IoExecutor" )
+{
+  jess::IoExecutor sut{};
+  CHECK_FALSE( sut.busy() );
+  std::vector<int> completed{};
+
+  SUBCASE( "queued tasks run in order and complete on the calling thread" )
+  {
+    std::vector<int> worked{};
+    const auto callingThread = std::this_thread::get_id();
+    for ( int i = 0; i < 3; ++i )
+    {
+      sut.submit(
+        jess::IoExecutor::Mode::QUEUE, [&, i]( const std::stop_token& ) { worked.push_back( i ); },
+        [&, i] {
+          CHECK( std::this_thread::get_id() == callingThread );
+          completed.push_back( i );
+        } );
+    }
+    CHECK( sut.busy() );
+
+    sut.waitIdle();
+    // the completions are pending until they are run
+    CHECK( sut.busy() );
+    CHECK( completed.empty() );
+    pollfd fd{ sut.notifyFd(), POLLIN, 0 };
+    CHECK( ::poll( &fd, 1, 0 ) == 1 );
+
+    sut.runCompletions();
+    CHECK( worked == std::vector{ 0, 1, 2 } );
+    CHECK( completed == std::vector{ 0, 1, 2 } );
+    CHECK_FALSE( sut.busy() );
+    CHECK( ::poll( &fd, 1, 0 ) == 0 );
+  }
+
+  SUBCASE( "a superseding task stops the running one and drops the queued ones" )
+  {
+    std::atomic<bool> bStarted{};
+    std::atomic<bool> bStopped{};
+    sut.submit(
+      jess::IoExecutor::Mode::QUEUE,
+      [&]( const std::stop_token& stopToken ) {
+        bStarted = true;
+        while ( !stopToken.stop_requested() )
+        {
+          std::this_thread::yield();
+        }
+        bStopped = true;
+      },
+      [&] { completed.push_back( 0 ); } );
+    while ( !bStarted )
+    {
+      std::this_thread::yield();
+    }
+    sut.submit( jess::IoExecutor::Mode::QUEUE, []( const std::stop_token& ) {}, [&] { completed.push_back( 1 ); } );
+    sut.submit( jess::IoExecutor::Mode::SUPERSEDE, []( const std::stop_token& ) {}, [&] { completed.push_back( 2 ); } );
+
+    drain( sut );
+    CHECK( bStopped );
+    CHECK( completed == std::vector{ 2 } );
+  }
+
+  SUBCASE( "a task superseded after its work is done is not completed" )
+  {
+    sut.submit( jess::IoExecutor::Mode::QUEUE, []( const std::stop_token& ) {}, [&] { completed.push_back( 0 ); } );
+    sut.waitIdle();
+    sut.submit( jess::IoExecutor::Mode::SUPERSEDE, []( const std::stop_token& ) {}, [&] { completed.push_back( 1 ); } );
+
+    drain( sut );
+    CHECK( completed == std::vector{ 1 } );
+  }
+
+  SUBCASE( "a completion may submit further tasks" )
+  {
+    sut.submit( jess::IoExecutor::Mode::QUEUE, []( const std::stop_token& ) {}, [&] {
+      completed.push_back( 0 );
+      sut.submit( jess::IoExecutor::Mode::SUPERSEDE, []( const std::stop_token& ) {}, [&] { completed.push_back( 1 ); } );
+    } );
+
+    drain( sut );
+    CHECK( completed == std::vector{ 0, 1 } );
+  }
+
+  SUBCASE( "cancel drops all tasks" )
+  {
+    sut.submit( jess::IoExecutor::Mode::QUEUE, []( const std::stop_token& ) {}, [&] { completed.push_back( 0 ); } );
+    sut.cancel();
+    sut.waitIdle();
+    sut.runCompletions();
+    CHECK( completed.empty() );
+    CHECK_FALSE( sut.busy() );
+  }
+
+  SUBCASE( "the exception of a task is rethrown by runCompletions" )
+  {
+    sut.submit( jess::IoExecutor::Mode::QUEUE, []( const std::stop_token& ) { throw std::runtime_error{ "journal gone" }; }, [&] { completed.push_back( 0 ); } );
+    sut.waitIdle();
+    CHECK_THROWS_AS( sut.runCompletions(), std::runtime_error );
+    CHECK( completed.empty() );
+
+    // the executor keeps running the following tasks
+    sut.submit( jess::IoExecutor::Mode::QUEUE, []( const std::stop_token& ) {}, [&] { completed.push_back( 1 ); } );
+    drain( sut );
+    CHECK( completed == std::vector{ 1 } );
+  }
+}
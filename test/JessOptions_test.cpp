@@ -0,0 +1,138 @@
+#include "JessOptions.hpp"
+#include <doctest/doctest.h>
+
+#include <array>
+
+TEST_CASE( "parseSize" )
+{
+  CHECK( jess::parseSize( "0" ) == 0 );
+  CHECK( jess::parseSize( "1234" ) == 1234 );
+  CHECK( jess::parseSize( "4K" ) == 4096 );
+  CHECK( jess::parseSize( "3M" ) == 3 * 1024 * 1024 );
+  CHECK( jess::parseSize( "1G" ) == 1024 * 1024 * 1024 );
+  CHECK_THROWS_AS( jess::parseSize( "" ), std::invalid_argument );
+  CHECK_THROWS_AS( jess::parseSize( "M" ), std::invalid_argument );
+  CHECK_THROWS_AS( jess::parseSize( "12X" ), std::invalid_argument );
+  CHECK_THROWS_AS( jess::parseSize( "17179869184G" ), std::invalid_argument );
+  CHECK_THROWS_AS( jess::parseSize( "18014398509481984K" ), std::invalid_argument );
+  CHECK( jess::parseSize( "17179869183G" ) == 17179869183ULL << 30 );
+}
+
+TEST_CASE( "parseArguments" )
+{
+  SUBCASE( "defaults" )
+  {
+    const auto options = jess::parseArguments( {} );
+    CHECK( options.cacheBudget.maxBytes == 256 * 1024 * 1024 );
+    CHECK( options.cacheBudget.maxChunks == 0 );
+    CHECK_FALSE( options.showHelp );
+  }
+
+  SUBCASE( "cache budget" )
+  {
+    const std::array<const char*, 3> arguments{ "--cache-size=64M", "--cache-chunks", "16" };
+    const auto options = jess::parseArguments( arguments );
+    CHECK( options.cacheBudget.maxBytes == 64 * 1024 * 1024 );
+    CHECK( options.cacheBudget.maxChunks == 16 );
+  }
+
+  SUBCASE( "timestamp format" )
+  {
+    CHECK_FALSE( jess::parseArguments( {} ).timestampFormat.localTime );
+    const std::array<const char*, 2> arguments{ "--local-time", "--usec" };
+    const auto options = jess::parseArguments( arguments );
+    CHECK( options.timestampFormat.localTime );
+    CHECK( options.timestampFormat.microseconds );
+  }
+
+  SUBCASE( "follow and search" )
+  {
+    CHECK_FALSE( jess::parseArguments( {} ).follow );
+    const std::array<const char*, 2> arguments{ "-f", "-i" };
+    const auto options = jess::parseArguments( arguments );
+    CHECK( options.follow );
+    CHECK( options.ignoreCase );
+  }
+
+  SUBCASE( "scope" )
+  {
+    CHECK( jess::parseArguments( {} ).scope.flags == 0 );
+
+    const std::array<const char*, 2> flags{ "--system", "--user" };
+    CHECK( jess::parseArguments( flags ).scope.flags == ( SD_JOURNAL_SYSTEM | SD_JOURNAL_CURRENT_USER ) );
+
+    const std::array<const char*, 2> directory{ "-D", "/var/log/journal/remote" };
+    CHECK( jess::parseArguments( directory ).scope.directory == "/var/log/journal/remote" );
+    const std::array<const char*, 1> longDirectory{ "--directory=/tmp" };
+    CHECK( jess::parseArguments( longDirectory ).scope.directory == "/tmp" );
+
+    const std::array<const char*, 3> files{ "--file=a.journal", "--file", "b.journal" };
+    CHECK( jess::parseArguments( files ).scope.files == std::vector<std::string>{ "a.journal", "b.journal" } );
+
+    const std::array<const char*, 2> conflicting{ "--system", "--file=a.journal" };
+    CHECK_THROWS_AS( jess::parseArguments( conflicting ), std::invalid_argument );
+  }
+
+  SUBCASE( "data threshold" )
+  {
+    CHECK( jess::parseArguments( {} ).dataThreshold == 8 * 1024 );
+    const std::array<const char*, 1> arguments{ "--data-threshold=0" };
+    CHECK( jess::parseArguments( arguments ).dataThreshold == 0 );
+  }
+
+  SUBCASE( "columns" )
+  {
+    CHECK( jess::parseArguments( {} ).columns.empty() );
+    const std::array<const char*, 1> arguments{ "--columns=_SYSTEMD_UNIT,_PID" };
+    CHECK( jess::parseArguments( arguments ).columns == std::vector<std::string>{ "_SYSTEMD_UNIT", "_PID" } );
+    const std::array<const char*, 2> invalid{ "--columns", "_PID,,unit" };
+    CHECK_THROWS_AS( jess::parseArguments( invalid ), std::invalid_argument );
+  }
+
+  SUBCASE( "session" )
+  {
+    CHECK( jess::parseArguments( {} ).session );
+    const std::array<const char*, 1> arguments{ "--no-session" };
+    CHECK_FALSE( jess::parseArguments( arguments ).session );
+  }
+
+  SUBCASE( "timeline" )
+  {
+    CHECK( jess::parseArguments( {} ).timeline );
+    const std::array<const char*, 1> arguments{ "--no-timeline" };
+    CHECK_FALSE( jess::parseArguments( arguments ).timeline );
+  }
+
+  SUBCASE( "stats file" )
+  {
+    CHECK( jess::parseArguments( {} ).statsFile.empty() );
+    const std::array<const char*, 1> arguments{ "--stats-file=/tmp/jess-stats" };
+    CHECK( jess::parseArguments( arguments ).statsFile == "/tmp/jess-stats" );
+  }
+
+  SUBCASE( "dump" )
+  {
+    CHECK_FALSE( jess::parseArguments( {} ).dump );
+    const std::array<const char*, 6> arguments{ "--dump", "--since=2024-01-02 03:04:05", "--until", "2024-01-03", "--filter=PRIORITY=err", "--grep=disk full" };
+    const jess::JessOptions options = jess::parseArguments( arguments );
+    CHECK( options.dump );
+    CHECK( options.since == std::chrono::sys_days{ std::chrono::January / 2 / 2024 } + std::chrono::hours{ 3 } + std::chrono::minutes{ 4 } +
+        std::chrono::seconds{ 5 } );
+    CHECK( options.until == std::chrono::sys_days{ std::chrono::January / 3 / 2024 } );
+    CHECK( options.filter.toString() == "PRIORITY=3" );
+    CHECK( options.grep == "disk full" );
+
+    const std::array<const char*, 1> untilWithoutDump{ "--until=now" };
+    CHECK_THROWS_AS( jess::parseArguments( untilWithoutDump ), std::invalid_argument );
+    const std::array<const char*, 2> invalidTime{ "--dump", "--since=yesterday" };
+    CHECK_THROWS_AS( jess::parseArguments( invalidTime ), std::invalid_argument );
+  }
+
+    SUBCASE( "errors" )
+  {
+    const std::array<const char*, 1> unknown{ "--frobnicate" };
+    CHECK_THROWS_AS( jess::parseArguments( unknown ), std::invalid_argument );
+    const std::array<const char*, 1> missingValue{ "--cache-size" };
+    CHECK_THROWS_AS( jess::parseArguments( missingValue ), std::invalid_argument );
+  }
+}
@@ -0,0 +1,96 @@
+#include "JournalDump.hpp"
+#include "MockStream.hpp"
+#include <doctest/doctest.h>
+
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+std::vector<std::string> splitLines( const std::string& sText )
+{
+  std::vector<std::string> lines{};
+  size_t uBegin = 0;
+  for ( size_t uEnd = sText.find( '\n' ); uEnd != std::string::npos; uEnd = sText.find( '\n', uBegin ) )
+  {
+    lines.push_back( sText.substr( uBegin, uEnd - uBegin ) );
+    uBegin = uEnd + 1;
+  }
+  return lines;
+}
+}// namespace
+
+TEST_CASE( "dumpJournal" )
+{
+  std::string sOutput{};
+  size_t uNumWrites{};
+  const auto write = [&]( std::string& sBlock ) {
+    sOutput += sBlock;
+    sBlock.clear();
+    ++uNumWrites;
+    return true;
+  };
+  jess::DumpOptions options{};
+
+  SUBCASE( "all entries" )
+  {
+    CHECK( jess::dumpJournal<MockStream<10000>>( [] { return MockStream<10000>{}; }, {}, options, 64 * 1024, write ) == 10000 );
+    const auto lines = splitLines( sOutput );
+    REQUIRE( lines.size() == 10000 );
+    CHECK( lines.front() == "1970-01-01 00:00:00 line 0" );
+    CHECK( lines.back() == "1970-01-01 02:46:39 line 9999" );
+    CHECK( uNumWrites > 1 );
+  }
+
+  SUBCASE( "time range" )
+  {
+    options.since = std::chrono::system_clock::time_point{ 5000s };
+    options.until = std::chrono::system_clock::time_point{ 9000s };
+    CHECK( jess::dumpJournal<MockStream<10000>>( [] { return MockStream<10000>{}; }, {}, options, 64 * 1024, write ) == 4001 );
+    const auto lines = splitLines( sOutput );
+    REQUIRE( lines.size() == 4001 );
+    CHECK( lines.front().ends_with( " line 5000" ) );
+    CHECK( lines.back().ends_with( " line 9000" ) );
+  }
+
+  SUBCASE( "empty range" )
+  {
+    options.since = std::chrono::system_clock::time_point{ 20000s };
+    CHECK( jess::dumpJournal<MockStream<10000>>( [] { return MockStream<10000>{}; }, {}, options, 64 * 1024, write ) == 0 );
+    CHECK( sOutput.empty() );
+  }
+
+  SUBCASE( "columns" )
+  {
+    options.columns = { "_PID" };
+    CHECK( jess::dumpJournal<MockStream<10>>( [] { return MockStream<10>{}; }, {}, options, 64 * 1024, write ) == 10 );
+    const auto lines = splitLines( sOutput );
+    REQUIRE( lines.size() == 10 );
+    CHECK( lines[0] == "1970-01-01 00:00:00 0 line 0" );
+    CHECK( lines[9] == "1970-01-01 00:00:09 18 line 9" );
+  }
+
+  SUBCASE( "configure" )
+  {
+    const auto configure = []( MockStream<100>& journal ) { journal.uStreamLength = 50; };
+    CHECK( jess::dumpJournal<MockStream<100>>( [] { return MockStream<100>{}; }, configure, options, 64 * 1024, write ) == 50 );
+  }
+
+  SUBCASE( "the writer stops the dump" )
+  {
+    const auto failingWrite = [&]( std::string& sBlock ) {
+      sBlock.clear();
+      return ++uNumWrites < 3;
+    };
+    CHECK( jess::dumpJournal<MockStream<100000>>( [] { return MockStream<100000>{}; }, {}, options, 1024, failingWrite ) < 100000 );
+    CHECK( uNumWrites == 3 );
+  }
+
+  SUBCASE( "errors of the reader are rethrown" )
+  {
+    const auto openJournal = []() -> MockStream<10> { throw std::runtime_error{ "cannot open" }; };
+    CHECK_THROWS_AS( jess::dumpJournal<MockStream<10>>( openJournal, {}, options, 1024, write ), std::runtime_error );
+  }
+}
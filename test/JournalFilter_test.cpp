@@ -0,0 +1,85 @@
+#include "JournalFilter.hpp"
+#include <doctest/doctest.h>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/// records the calls like sd_journal would apply them
+struct RecordingJournal {
+  std::vector<std::string> calls{ "stale" };
+
+  void flushMatches() { calls.clear(); }
+  void addDisjunction() { calls.emplace_back( "+" ); }
+  void addMatch( std::string_view sMatch ) { calls.emplace_back( sMatch ); }
+};
+
+using Groups = std::vector<std::vector<std::string>>;
+
+}// namespace
+
+TEST_CASE( "parseFilter" )
+{
+  SUBCASE( "empty expression" )
+  {
+    CHECK( jess::parseFilter( "" ).empty() );
+    CHECK( jess::parseFilter( "   " ).empty() );
+  }
+
+  SUBCASE( "conjunction" )
+  {
+    const auto filter = jess::parseFilter( " _SYSTEMD_UNIT=cron.service  _PID=42 " );
+    CHECK( filter.groups == Groups{ { "_SYSTEMD_UNIT=cron.service", "_PID=42" } } );
+    CHECK( filter.toString() == "_SYSTEMD_UNIT=cron.service _PID=42" );
+  }
+
+  SUBCASE( "disjunction" )
+  {
+    const auto filter = jess::parseFilter( "SYSLOG_IDENTIFIER=sshd + _SYSTEMD_UNIT=a.service _SYSTEMD_UNIT=b.service" );
+    CHECK( filter.groups == Groups{ { "SYSLOG_IDENTIFIER=sshd" }, { "_SYSTEMD_UNIT=a.service", "_SYSTEMD_UNIT=b.service" } } );
+    CHECK( filter.toString() == "SYSLOG_IDENTIFIER=sshd + _SYSTEMD_UNIT=a.service _SYSTEMD_UNIT=b.service" );
+  }
+
+  SUBCASE( "values may contain '='" ) { CHECK( jess::parseFilter( "MESSAGE=a=b" ).groups == Groups{ { "MESSAGE=a=b" } } ); }
+
+  SUBCASE( "priority" )
+  {
+    CHECK( jess::parseFilter( "PRIORITY=3" ).groups == Groups{ { "PRIORITY=3" } } );
+    CHECK( jess::parseFilter( "PRIORITY=warning" ).groups == Groups{ { "PRIORITY=4" } } );
+    CHECK( jess::parseFilter( "PRIORITY<=err" ).groups == Groups{ { "PRIORITY=0", "PRIORITY=1", "PRIORITY=2", "PRIORITY=3" } } );
+    CHECK( jess::parseFilter( "PRIORITY<=0" ).groups == Groups{ { "PRIORITY=0" } } );
+  }
+
+  SUBCASE( "malformed" )
+  {
+    CHECK_THROWS_AS( jess::parseFilter( "cron.service" ), std::invalid_argument );
+    CHECK_THROWS_AS( jess::parseFilter( "=value" ), std::invalid_argument );
+    CHECK_THROWS_AS( jess::parseFilter( "_systemd_unit=a" ), std::invalid_argument );
+    CHECK_THROWS_AS( jess::parseFilter( "1FIELD=a" ), std::invalid_argument );
+    CHECK_THROWS_AS( jess::parseFilter( "PRIORITY=8" ), std::invalid_argument );
+    CHECK_THROWS_AS( jess::parseFilter( "PRIORITY<=" ), std::invalid_argument );
+    CHECK_THROWS_AS( jess::parseFilter( "_PID<=3" ), std::invalid_argument );
+    CHECK_THROWS_AS( jess::parseFilter( "+ _PID=1" ), std::invalid_argument );
+    CHECK_THROWS_AS( jess::parseFilter( "_PID=1 +" ), std::invalid_argument );
+    CHECK_THROWS_AS( jess::parseFilter( "_PID=1 + + _PID=2" ), std::invalid_argument );
+  }
+}
+
+TEST_CASE( "applyFilter" )
+{
+  RecordingJournal journal{};
+
+  SUBCASE( "groups are separated by disjunctions" )
+  {
+    jess::applyFilter( journal, jess::parseFilter( "_PID=1 _PID=2 + PRIORITY<=1" ) );
+    CHECK( journal.calls == std::vector<std::string>{ "_PID=1", "_PID=2", "+", "PRIORITY=0", "PRIORITY=1" } );
+  }
+
+  SUBCASE( "an empty filter removes all matches" )
+  {
+    jess::applyFilter( journal, jess::JournalFilter{} );
+    CHECK( journal.calls.empty() );
+  }
+}
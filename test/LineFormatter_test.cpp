@@ -0,0 +1,65 @@
+#include "LineFormatter.hpp"
+#include <doctest/doctest.h>
+
+#include <array>
+#include <string>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+jess::SdLine makeLine( const std::string_view sMessage, const bool bTruncated = false, const char* pFieldData = nullptr,
+  const std::span<const jess::FieldRef> fields = {} )
+{
+  return jess::SdLine{ jess::SdSeqid{ {}, { 1 } }, sMessage, std::chrono::system_clock::time_point{ 61s }, bTruncated, pFieldData, fields };
+}
+}// namespace
+
+TEST_CASE( "LineFormatter" )
+{
+  jess::LineFormatter sut{};
+  std::string sOut{};
+
+  SUBCASE( "timestamp and message" )
+  {
+    sut.append( sOut, makeLine( "hello" ) );
+    CHECK( sOut == "1970-01-01 00:01:01 hello\n" );
+  }
+
+  SUBCASE( "continuation lines are indented to the message" )
+  {
+    sut.append( sOut, makeLine( "first\nsecond\n" ) );
+    CHECK( sOut == "1970-01-01 00:01:01 first\n                    second\n                    \n" );
+  }
+
+  SUBCASE( "truncated messages are marked" )
+  {
+    sut.append( sOut, makeLine( "cut", true ) );
+    CHECK( sOut == "1970-01-01 00:01:01 [+] cut\n" );
+  }
+
+  SUBCASE( "columns are padded to the widest value seen" )
+  {
+    const std::string sData = "cronsshd";
+    const std::array<jess::FieldRef, 1> cron{ jess::FieldRef{ 0, 4 } };
+    const std::array<jess::FieldRef, 1> sh{ jess::FieldRef{ 4, 2 } };
+
+    CHECK( sut.prefix( makeLine( "a", false, sData.data(), cron ) ) == "1970-01-01 00:01:01 cron " );
+    const std::array<jess::SdLine, 2> lines{ makeLine( "a", false, sData.data(), sh ), makeLine( "b", false, sData.data(), cron ) };
+    CHECK( sut.updateColumnWidths( lines ) );
+    CHECK_FALSE( sut.updateColumnWidths( lines ) );
+    CHECK( sut.prefix( lines[0] ) == "1970-01-01 00:01:01 ss   " );
+
+    sut.resetColumns();
+    CHECK( sut.prefix( lines[0] ) == "1970-01-01 00:01:01 ss " );
+  }
+
+  SUBCASE( "column values are cut" )
+  {
+    const std::string sData = std::string( 40, 'x' ) + "\nsecond";
+    const std::array<jess::FieldRef, 1> fields{ jess::FieldRef{ 0, static_cast<uint32_t>( sData.size() ) } };
+    CHECK( jess::LineFormatter::columnValue( makeLine( "a", false, sData.data(), fields ), 0 ).size() == jess::LineFormatter::MAX_COLUMN_WIDTH );
+    const std::array<jess::FieldRef, 1> shortFields{ jess::FieldRef{ 35, 10 } };
+    CHECK( jess::LineFormatter::columnValue( makeLine( "a", false, sData.data(), shortFields ), 0 ) == "xxxxx" );
+  }
+}
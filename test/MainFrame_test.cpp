@@ -0,0 +1,89 @@
+#include "MainFrame.hpp"
+#include <doctest/doctest.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+std::vector<jess::SdSeqid> makeFrame( const size_t uFirst, const size_t uLength )
+{
+  std::vector<jess::SdSeqid> ret{};
+  for ( size_t i = uFirst; i < uFirst + uLength; ++i )
+  {
+    ret.push_back( jess::SdSeqid{ {}, { i } } );
+  }
+  return ret;
+}
+}// namespace
+
+TEST_CASE( "wrapRows" )
+{
+  using Rows = std::vector<std::string_view>;
+  CHECK( jess::wrapRows( "", 4 ) == Rows{ "" } );
+  CHECK( jess::wrapRows( "abcd", 4 ) == Rows{ "abcd" } );
+  CHECK( jess::wrapRows( "abcdefghij", 4 ) == Rows{ "abcd", "efgh", "ij" } );
+  CHECK( jess::wrapRows( "ab\n\nabcdef\n", 4 ) == Rows{ "ab", "", "abcd", "ef", "" } );
+  CHECK( jess::wrapRows( "ab", 0 ) == Rows{ "a", "b" } );
+
+  // counted in columns as drawn
+  CHECK( jess::wrapRows( "a\tbcdefghij", 10 ) == Rows{ "a\tbc", "defghij" } );
+  CHECK( jess::wrapRows( "\x1b[31mabcd\x1b[0mef", 4 ) == Rows{ "\x1b[31mabcd\x1b[0m", "ef" } );
+  CHECK( jess::wrapRows( "abc\x07" "d", 4 ) == Rows{ "abc", "\x07" "d" } );
+  CHECK( jess::wrapRows( "\tab", 4 ) == Rows{ "\t", "ab" } );
+}
+
+TEST_CASE( "appendDisplayText" )
+{
+  const auto display = []( const std::string_view sText, const size_t uColumn, const size_t uEndColumn ) {
+    std::string sOut{};
+    const size_t uLength = jess::appendDisplayText( sOut, sText, uColumn, uEndColumn );
+    return std::pair{ sOut, uLength };
+  };
+
+  CHECK( display( "abc", 0, 80 ) == std::pair{ std::string{ "abc" }, size_t{ 3 } } );
+  CHECK( display( "abcdef", 0, 4 ) == std::pair{ std::string{ "abcd" }, size_t{ 4 } } );
+  // tabs stop at multiples of 8 of the row
+  CHECK( display( "a\tb", 0, 80 ) == std::pair{ std::string{ "a       b" }, size_t{ 3 } } );
+  CHECK( display( "a\tb", 5, 80 ) == std::pair{ std::string{ "a  b" }, size_t{ 3 } } );
+  CHECK( display( "a\tb", 0, 6 ) == std::pair{ std::string{ "a" }, size_t{ 1 } } );
+  // colour codes are dropped, other control bytes are shown like ncurses does
+  CHECK( display( "\x1b[1;31merror\x1b[0m", 0, 80 ) == std::pair{ std::string{ "error" }, size_t{ 16 } } );
+  CHECK( display( "a\x07\x1b", 0, 80 ) == std::pair{ std::string{ "a^G^[" }, size_t{ 3 } } );
+  CHECK( display( "a\x07", 0, 2 ) == std::pair{ std::string{ "a" }, size_t{ 1 } } );
+}
+
+TEST_CASE( "scrollDelta" )
+{
+  const auto frame = makeFrame( 10, 5 );
+
+  CHECK( jess::scrollDelta( frame, frame ) == 0 );
+  CHECK( jess::scrollDelta( frame, makeFrame( 11, 5 ) ) == 1 );
+  CHECK( jess::scrollDelta( frame, makeFrame( 14, 5 ) ) == 4 );
+  CHECK( jess::scrollDelta( frame, makeFrame( 8, 5 ) ) == -2 );
+  CHECK( jess::scrollDelta( frame, makeFrame( 6, 5 ) ) == -4 );
+
+  SUBCASE( "no shared rows" )
+  {
+    CHECK_FALSE( jess::scrollDelta( frame, makeFrame( 15, 5 ) ) );
+    CHECK_FALSE( jess::scrollDelta( frame, makeFrame( 5, 5 ) ) );
+    CHECK_FALSE( jess::scrollDelta( {}, frame ) );
+    CHECK_FALSE( jess::scrollDelta( frame, {} ) );
+  }
+
+  SUBCASE( "frames of different length" )
+  {
+    // the end of the journal has been reached
+    CHECK( jess::scrollDelta( frame, makeFrame( 12, 3 ) ) == 2 );
+    // new entries have been appended
+    CHECK( jess::scrollDelta( makeFrame( 10, 3 ), frame ) == 0 );
+  }
+
+  SUBCASE( "rows in between differ" )
+  {
+    auto changed = makeFrame( 12, 5 );
+    changed[1] = jess::SdSeqid{ {}, { 100 } };
+    CHECK_FALSE( jess::scrollDelta( frame, changed ) );
+  }
+}
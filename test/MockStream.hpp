@@ -0,0 +1,148 @@
+#pragma once
+
+#include "CSeekableStream.hpp"
+#include "SdCursor.hpp"
+#include "SdLine.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/// journal of uInitialLength entries, entry i has the message "line i" and is at i seconds after the epoch; every
+/// entry at a multiple of ERROR_INTERVAL has the priority err, the others info
+template<int64_t uInitialLength>
+struct MockStream {
+  static constexpr int64_t ERROR_INTERVAL = 50;
+
+  // may grow to emulate entries being added to the journal
+  int64_t uStreamLength{ uInitialLength };
+  int64_t pos{};
+  std::optional<jess::SdSeqid> currentSeqid{};
+  // storage of the current message, lines returned by getLine() refer to it like they refer to the entry data of sd_journal
+  std::string sCurrentMessage{};
+  // set after seeking to a cursor, the next step in either direction lands on the entry itself
+  bool bOnCursor{};
+  size_t uFieldReads{};
+  size_t uLineReads{};
+
+  void seekToBof() { pos = -1; }
+
+  void seekToEof() { pos = uStreamLength; }
+
+  void seekToCursor( const std::string& sCursor )
+  {
+    pos = static_cast<int64_t>( jess::SdCursor::fromString( sCursor ).seqid.seqnum.value );
+    bOnCursor = true;
+  }
+
+  // entry i is at i seconds after the epoch
+  void seekToRealtime( const std::chrono::time_point<std::chrono::system_clock> realtime )
+  {
+    pos = std::clamp<int64_t>( std::chrono::ceil<std::chrono::seconds>( realtime.time_since_epoch() ).count() - 1, -1, uStreamLength - 1 );
+    bOnCursor = false;
+  }
+
+  void seekLinesForward( const size_t uNumLines )
+  {
+    pos = std::min( pos + static_cast<int64_t>( uNumLines ), uStreamLength - 1 );
+    loadCurrentLine();
+  }
+
+  void seekLinesBackward( const size_t uNumLines )
+  {
+    if ( static_cast<int64_t>( uNumLines ) > pos )
+    {
+      pos = 0;
+    }
+    else
+    {
+      pos = pos - static_cast<int64_t>( uNumLines );
+    }
+    loadCurrentLine();
+  }
+
+  bool next()
+  {
+    if ( std::exchange( bOnCursor, false ) )
+    {
+      loadCurrentLine();
+      return true;
+    }
+    pos += 1;
+    assert( pos >= 0 );
+
+    if ( pos < uStreamLength )
+    {
+      loadCurrentLine();
+    }
+
+    return pos < uStreamLength;
+  }
+
+  bool previous()
+  {
+    if ( std::exchange( bOnCursor, false ) )
+    {
+      loadCurrentLine();
+      return true;
+    }
+    pos -= 1;
+    assert( pos < uStreamLength );
+
+    if ( pos >= 0 )
+    {
+      loadCurrentLine();
+    }
+
+    return pos >= 0;
+  }
+
+  [[nodiscard]] jess::SdSeqid getSeqid() const { return currentSeqid.value(); }
+
+  std::chrono::time_point<std::chrono::system_clock> getTimestampRealtime() const
+  {
+    return std::chrono::system_clock::time_point{ std::chrono::seconds{ pos } };
+  }
+
+  jess::SdLine getLine()
+  {
+    ++uLineReads;
+    loadCurrentLine();
+    return jess::SdLine{ getSeqid(), sCurrentMessage, std::chrono::system_clock::time_point{ std::chrono::seconds{ pos } }, false, nullptr, {},
+      static_cast<uint8_t>( pos % ERROR_INTERVAL == 0 ? 3 : 6 ) };
+  }
+
+  // "_PID" is twice the position, other fields are missing. Like sd_journal_get_data(), reading a field reuses the
+  // storage of the message.
+  std::string_view getFieldString( const std::string_view sFieldName )
+  {
+    ++uFieldReads;
+    if ( sFieldName != "_PID" )
+    {
+      return {};
+    }
+    sCurrentMessage = std::to_string( 2 * pos );
+    return sCurrentMessage;
+  }
+
+  [[nodiscard]] jess::SdCursor getCursor() const
+  {
+    const auto seqid = getSeqid();
+    return jess::SdCursor{ seqid, {}, seqid.seqnum.value, seqid.seqnum.value, 0 };
+  }
+
+private:
+  void loadCurrentLine()
+  {
+    currentSeqid = jess::SdSeqid{ { std::array<uint8_t, 16>{} }, { static_cast<size_t>( pos ) } };
+    sCurrentMessage = std::string{ "line " } + std::to_string( pos );
+  }
+};
+
+static_assert( jess::SeekableStream<MockStream<1>> );
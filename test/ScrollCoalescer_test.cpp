@@ -0,0 +1,57 @@
+#include "ScrollCoalescer.hpp"
+#include <doctest/doctest.h>
+
+TEST_CASE( "scrollDistance" )
+{
+  CHECK( jess::scrollDistance( jess::KeyCombination( KEY_DOWN ), 30 ) == 1 );
+  CHECK( jess::scrollDistance( jess::ctrl( 'p' ), 30 ) == -1 );
+  CHECK( jess::scrollDistance( jess::KeyCombination( KEY_NPAGE ), 30 ) == 30 );
+  CHECK( jess::scrollDistance( jess::meta( 'v' ), 30 ) == -30 );
+  CHECK_FALSE( jess::scrollDistance( jess::KeyCombination( 'q' ), 30 ) );
+}
+
+TEST_CASE( "ScrollCoalescer" )
+{
+  using namespace std::chrono_literals;
+  const jess::ScrollCoalescer::Clock::time_point start{};
+  jess::ScrollCoalescer sut{ 20ms };
+  CHECK_FALSE( sut.take( start, false ) );
+
+  SUBCASE( "a single key is drawn right away" )
+  {
+    sut.add( 1 );
+    CHECK( sut.take( start, false ) == 1 );
+    CHECK_FALSE( sut.pending() );
+  }
+
+  SUBCASE( "keys arriving within a frame are merged" )
+  {
+    sut.add( 30 );
+    CHECK( sut.take( start, true ) == 30 );
+    sut.frameDrawn( start + 5ms );
+    sut.add( 30 );
+    CHECK_FALSE( sut.take( start + 10ms, true ) );
+    sut.add( -1 );
+    CHECK_FALSE( sut.take( start + 24ms, true ) );
+    sut.add( 30 );
+    CHECK( sut.take( start + 25ms, true ) == 59 );
+    CHECK( sut.keys() == 4 );
+    CHECK( sut.frames() == 2 );
+  }
+
+  SUBCASE( "the rest is drawn as soon as the input is drained" )
+  {
+    sut.frameDrawn( start );
+    sut.add( 1 );
+    sut.add( 1 );
+    CHECK_FALSE( sut.take( start + 1ms, true ) );
+    CHECK( sut.take( start + 2ms, false ) == 2 );
+  }
+
+  SUBCASE( "keys cancelling each other out are still drawn" )
+  {
+    sut.add( -1 );
+    sut.add( 1 );
+    CHECK( sut.take( start, false ) == 0 );
+  }
+}
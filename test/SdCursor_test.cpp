@@ -50,3 +50,66 @@ TEST_CASE( "hexCharToNibble lowercase" ) {
   REQUIRE(jess::hexCharToNibble<false>('e') == 0xe);
   REQUIRE(jess::hexCharToNibble<false>('f') == 0xf);
 }
+
+TEST_CASE( "SdCursor fields in any order" ) {
+  auto input = "b=2f9fe978f1b14fff91f8cc319b400956;x=87e478517491f1d0;i=2d39c1ee;t=6075f19daf269;s=72f9ece3caa84aaab5fd4eac74f04a32;m=21733b7"sv;
+  auto sut = jess::SdCursor::fromString(input);
+  REQUIRE(sut.toString() == "s=72f9ece3caa84aaab5fd4eac74f04a32;i=2d39c1ee;b=2f9fe978f1b14fff91f8cc319b400956;m=21733b7;t=6075f19daf269;x=87e478517491f1d0");
+}
+
+TEST_CASE( "SdCursor uppercase digits" ) {
+  auto sut = jess::SdCursor::fromString("s=72F9ECE3CAA84AAAB5FD4EAC74F04A32;i=2D39C1EE;b=2F9FE978F1B14FFF91F8CC319B400956;m=21733B7;t=6075F19DAF269;x=87E478517491F1D0");
+  REQUIRE(sut.toString() == "s=72f9ece3caa84aaab5fd4eac74f04a32;i=2d39c1ee;b=2f9fe978f1b14fff91f8cc319b400956;m=21733b7;t=6075f19daf269;x=87e478517491f1d0");
+}
+
+TEST_CASE( "SdCursor numbers" ) {
+  auto zero = "s=00000000000000000000000000000000;i=0;b=00000000000000000000000000000000;m=0;t=0;x=0"sv;
+  REQUIRE(jess::SdCursor::fromString(zero).toString() == zero);
+
+  auto max = "s=ffffffffffffffffffffffffffffffff;i=ffffffffffffffff;b=ffffffffffffffffffffffffffffffff;m=ffffffffffffffff;t=ffffffffffffffff;x=ffffffffffffffff"sv;
+  REQUIRE(max.size() == jess::SdCursor::MAX_STRING_LENGTH);
+  auto sut = jess::SdCursor::fromString(max);
+  CHECK(sut.seqid.seqnum.value == UINT64_MAX);
+  CHECK(sut.timeRealtime == UINT64_MAX);
+  REQUIRE(sut.toString() == max);
+}
+
+TEST_CASE( "SdCursor malformed" ) {
+  // x= is missing
+  CHECK_THROWS_AS(jess::SdCursor::fromString("s=72f9ece3caa84aaab5fd4eac74f04a32;i=2d39c1ee;b=2f9fe978f1b14fff91f8cc319b400956;m=21733b7;t=6075f19daf269"),
+                  std::runtime_error);
+  // the seqnum id is too short
+  CHECK_THROWS_AS(jess::SdCursor::fromString("s=72f9ece3caa84aaab5fd4eac74f04a3;i=2d39c1ee;b=2f9fe978f1b14fff91f8cc319b400956;m=21733b7;t=6075f19daf269;x=0"),
+                  std::runtime_error);
+  // the boot id has a character that is no hex digit
+  CHECK_THROWS_AS(jess::SdCursor::fromString("s=72f9ece3caa84aaab5fd4eac74f04a32;i=2d39c1ee;b=2f9fe978f1b14fff91f8cc319b40095g;m=21733b7;t=6075f19daf269;x=0"),
+                  std::runtime_error);
+  // the seqnum has more than 64 bits
+  CHECK_THROWS_AS(jess::SdCursor::fromString("s=72f9ece3caa84aaab5fd4eac74f04a32;i=12d39c1ee12d39c1ee;b=2f9fe978f1b14fff91f8cc319b400956;m=21733b7;t=6075f19daf269;x=0"),
+                  std::runtime_error);
+  CHECK_THROWS_AS(jess::SdCursor::fromString("s=72f9ece3caa84aaab5fd4eac74f04a32;i=;b=2f9fe978f1b14fff91f8cc319b400956;m=21733b7;t=6075f19daf269;x=0"),
+                  std::runtime_error);
+  CHECK_THROWS_AS(jess::SdCursor::fromString(""), std::runtime_error);
+}
+
+TEST_CASE( "SdCursor binary" ) {
+  auto input = "s=72f9ece3caa84aaab5fd4eac74f04a32;i=2d39c1ee;b=2f9fe978f1b14fff91f8cc319b400956;m=21733b7;t=6075f19daf269;x=87e478517491f1d0"sv;
+  auto sut = jess::SdCursor::fromString(input);
+  const jess::SdCursor::Binary binary = sut.toBinary();
+
+  // the seqnum follows the seqnum id in little endian
+  CHECK(binary[0] == 0x72);
+  CHECK(binary[15] == 0x32);
+  CHECK(binary[16] == 0xee);
+  CHECK(binary[19] == 0x2d);
+  CHECK(binary[20] == 0x00);
+  CHECK(binary[24] == 0x2f);
+
+  auto decoded = jess::SdCursor::fromBinary(binary);
+  CHECK(decoded.seqid == sut.seqid);
+  CHECK(decoded.bootId == sut.bootId);
+  CHECK(decoded.timeMonotonic == sut.timeMonotonic);
+  CHECK(decoded.timeRealtime == sut.timeRealtime);
+  CHECK(decoded.someXor == sut.someXor);
+  REQUIRE(decoded.toString() == input);
+}
@@ -0,0 +1,67 @@
+#include "SeqnumIdTable.hpp"
+#include <doctest/doctest.h>
+
+#include <thread>
+#include <vector>
+
+namespace
+{
+jess::SdSeqnumId makeId( const size_t uValue )
+{
+  jess::SdSeqnumId id{};
+  id.value[0] = static_cast<uint8_t>( uValue );
+  id.value[1] = static_cast<uint8_t>( uValue >> 8 );
+  return id;
+}
+}// namespace
+
+TEST_CASE( "SeqnumIdTable" )
+{
+  jess::SeqnumIdTable sut{};
+  CHECK( sut.size() == 0 );
+  CHECK_FALSE( sut.find( makeId( 1 ) ) );
+
+  CHECK( sut.intern( makeId( 1 ) ) == 0 );
+  CHECK( sut.intern( makeId( 2 ) ) == 1 );
+  CHECK( sut.intern( makeId( 1 ) ) == 0 );
+  CHECK( sut.find( makeId( 2 ) ) == 1U );
+  CHECK( sut.id( 1 ) == makeId( 2 ) );
+  CHECK( sut.size() == 2 );
+
+  SUBCASE( "ids beyond the first block keep their references" )
+  {
+    const jess::SdSeqnumId& first = sut.id( 0 );
+    for ( size_t i = 3; i < 3 * jess::SeqnumIdTable::BLOCK_SIZE; ++i )
+    {
+      REQUIRE( sut.intern( makeId( i ) ) == i - 1 );
+    }
+    CHECK( &first == &sut.id( 0 ) );
+    CHECK( sut.id( static_cast<uint32_t>( 2 * jess::SeqnumIdTable::BLOCK_SIZE ) ) == makeId( 2 * jess::SeqnumIdTable::BLOCK_SIZE + 1 ) );
+  }
+
+  SUBCASE( "concurrent interning" )
+  {
+    std::vector<std::vector<uint32_t>> indexes( 4 );
+    {
+      std::vector<std::jthread> threads{};
+      for ( auto& threadIndexes : indexes )
+      {
+        threads.emplace_back( [&sut, &threadIndexes] {
+          for ( size_t i = 0; i < 100; ++i )
+          {
+            threadIndexes.push_back( sut.intern( makeId( 100 + i ) ) );
+          }
+        } );
+      }
+    }
+    CHECK( sut.size() == 102 );
+    for ( const auto& threadIndexes : indexes )
+    {
+      CHECK( threadIndexes == indexes.front() );
+    }
+    for ( size_t i = 0; i < 100; ++i )
+    {
+      CHECK( sut.id( indexes.front()[i] ) == makeId( 100 + i ) );
+    }
+  }
+}
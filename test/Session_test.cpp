@@ -0,0 +1,94 @@
+#include "Session.hpp"
+#include <doctest/doctest.h>
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace
+{
+
+constexpr std::string_view LINE_CURSOR = "s=72f9ece3caa84aaab5fd4eac74f04a32;i=2d39c1ee;b=2f9fe978f1b14fff91f8cc319b400956;m=21733b7;t=6075f19daf269;x=87e478517491f1d0";
+constexpr std::string_view CHUNK_CURSOR = "s=72f9ece3caa84aaab5fd4eac74f04a32;i=2d39c1e0;b=2f9fe978f1b14fff91f8cc319b400956;m=2173000;t=6075f19daf000;x=87e478517491f100";
+
+/// a fresh directory below the temporary directory, removed at the end of the test
+struct TemporaryDirectory {
+  std::filesystem::path path{ std::filesystem::temp_directory_path() / ( "jess_test_" + std::to_string( ::getpid() ) ) };
+
+  TemporaryDirectory() { std::filesystem::remove_all( path ); }
+  ~TemporaryDirectory() { std::filesystem::remove_all( path ); }
+};
+
+}// namespace
+
+TEST_CASE( "Session file" )
+{
+  const TemporaryDirectory directory{};
+  const auto path = directory.path / "jess" / "session";
+
+  SUBCASE( "round trip" )
+  {
+    const jess::JournalPosition position{ jess::SdCursor::fromString( LINE_CURSOR ), jess::SdCursor::fromString( CHUNK_CURSOR ) };
+    REQUIRE( jess::writeSession( path, jess::Session{ position } ) );
+
+    const auto session = jess::readSession( path );
+    REQUIRE( session.position );
+    CHECK( session.position->line.toString() == LINE_CURSOR );
+    CHECK( session.position->chunkStart.toString() == CHUNK_CURSOR );
+    CHECK( std::distance( std::filesystem::directory_iterator{ path.parent_path() }, {} ) == 1 );
+
+    // an empty session replaces the previous one
+    REQUIRE( jess::writeSession( path, jess::Session{} ) );
+    CHECK_FALSE( jess::readSession( path ).position );
+  }
+
+  SUBCASE( "missing file" ) { CHECK_FALSE( jess::readSession( path ).position ); }
+
+  SUBCASE( "malformed file" )
+  {
+    std::filesystem::create_directories( path.parent_path() );
+    std::ofstream{ path } << "position s=garbage\nchunk " << CHUNK_CURSOR << "\n";
+    CHECK_FALSE( jess::readSession( path ).position );
+
+    std::ofstream{ path } << "position " << LINE_CURSOR << "\n";
+    CHECK_FALSE( jess::readSession( path ).position );
+  }
+}
+
+TEST_CASE( "defaultSessionPath" )
+{
+  const auto restore = []( const char* sName, const char* sPrevious ) {
+    if ( sPrevious )
+    {
+      ::setenv( sName, sPrevious, 1 );
+    }
+    else
+    {
+      ::unsetenv( sName );
+    }
+  };
+  const char* sPreviousCacheHome = std::getenv( "XDG_CACHE_HOME" );
+  const std::string sRestoreCacheHome = sPreviousCacheHome ? sPreviousCacheHome : "";
+  const char* sPreviousHome = std::getenv( "HOME" );
+  const std::string sRestoreHome = sPreviousHome ? sPreviousHome : "";
+
+  ::setenv( "XDG_CACHE_HOME", "/var/cache/user", 1 );
+  ::setenv( "HOME", "/home/user", 1 );
+  CHECK( jess::defaultSessionPath() == "/var/cache/user/jess/session" );
+
+  // relative paths are invalid according to the XDG base directory specification
+  ::setenv( "XDG_CACHE_HOME", "cache", 1 );
+  CHECK( jess::defaultSessionPath() == "/home/user/.cache/jess/session" );
+
+  ::unsetenv( "XDG_CACHE_HOME" );
+  CHECK( jess::defaultSessionPath() == "/home/user/.cache/jess/session" );
+
+  ::unsetenv( "HOME" );
+  CHECK( jess::defaultSessionPath().empty() );
+
+  restore( "XDG_CACHE_HOME", sPreviousCacheHome ? sRestoreCacheHome.c_str() : nullptr );
+  restore( "HOME", sPreviousHome ? sRestoreHome.c_str() : nullptr );
+}
@@ -0,0 +1,55 @@
+#include "Stats.hpp"
+#include <doctest/doctest.h>
+
+using namespace std::chrono_literals;
+
+TEST_CASE( "LatencyHistogram" )
+{
+  jess::LatencyHistogram sut{};
+  CHECK( sut.count() == 0 );
+  CHECK( sut.quantile( 0.5 ) == 0us );
+  CHECK( sut.toString() == "n=0" );
+
+  for ( int i = 0; i < 9; ++i )
+  {
+    sut.record( 100us );
+  }
+  sut.record( 10ms );
+  CHECK( sut.count() == 10 );
+  CHECK( sut.mean() == 1090us );
+  CHECK( sut.max() == 10ms );
+
+  SUBCASE( "quantiles are the upper bounds of the buckets" )
+  {
+    CHECK( sut.quantile( 0.5 ) == 128us );
+    CHECK( sut.quantile( 0.8 ) == 128us );
+    CHECK( sut.quantile( 0.99 ) == 10ms );
+  }
+
+  SUBCASE( "quantiles do not exceed the maximum" )
+  {
+    jess::LatencyHistogram histogram{};
+    histogram.record( 3us );
+    CHECK( histogram.quantile( 0.5 ) == 3us );
+  }
+
+  SUBCASE( "durations beyond the last bucket" )
+  {
+    sut.record( 1h );
+    CHECK( sut.quantile( 1.0 ) == 1h );
+  }
+
+  SUBCASE( "summary" )
+  {
+    CHECK( sut.toString() == "n=10 mean=1.1ms p50<=128us p99<=10.0ms max=10.0ms" );
+  }
+}
+
+TEST_CASE( "LatencyHistogram::formatDuration" )
+{
+  CHECK( jess::LatencyHistogram::formatDuration( 0us ) == "0us" );
+  CHECK( jess::LatencyHistogram::formatDuration( 999us ) == "999us" );
+  CHECK( jess::LatencyHistogram::formatDuration( 1000us ) == "1.0ms" );
+  CHECK( jess::LatencyHistogram::formatDuration( 12345us ) == "12.3ms" );
+  CHECK( jess::LatencyHistogram::formatDuration( 2s ) == "2000.0ms" );
+}
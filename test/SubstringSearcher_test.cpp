@@ -0,0 +1,88 @@
+#include "SubstringSearcher.hpp"
+#include <doctest/doctest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+std::vector<jess::SearchKernel> supportedKernels()
+{
+  std::vector<jess::SearchKernel> ret{};
+  for ( const auto kernel : { jess::SearchKernel::SCALAR, jess::SearchKernel::SSE2, jess::SearchKernel::AVX2 } )
+  {
+    if ( jess::SubstringSearcher::isSupported( kernel ) )
+    {
+      ret.push_back( kernel );
+    }
+  }
+  return ret;
+}
+
+std::string toLower( std::string s )
+{
+  for ( char& c : s )
+  {
+    c = jess::detail::toLowerAscii( c );
+  }
+  return s;
+}
+}// namespace
+
+TEST_CASE( "SubstringSearcher" )
+{
+  CHECK( jess::SubstringSearcher::isSupported( jess::SubstringSearcher::bestKernel() ) );
+
+  for ( const auto kernel : supportedKernels() )
+  {
+    CAPTURE( static_cast<int>( kernel ) );
+
+    const jess::SubstringSearcher sut{ "needle", false, kernel };
+    CHECK( sut.find( "needle" ) == 0 );
+    CHECK( sut.find( "a needle in a haystack" ) == 2 );
+    CHECK( sut.find( std::string( 100, 'x' ) + "needle" ) == 100 );
+    CHECK( sut.find( std::string( 100, 'n' ) + "needl" ) == std::string_view::npos );
+    CHECK( sut.find( "Needle" ) == std::string_view::npos );
+    CHECK( sut.find( "" ) == std::string_view::npos );
+    CHECK( jess::SubstringSearcher{ "", false, kernel }.find( "anything" ) == 0 );
+    CHECK( jess::SubstringSearcher{ "x", false, kernel }.find( std::string( 40, 'a' ) + "x" ) == 40 );
+
+    const jess::SubstringSearcher ignoreCase{ "NeeDle", true, kernel };
+    CHECK( ignoreCase.find( "a nEEDLE in a haystack" ) == 2 );
+    CHECK( ignoreCase.find( std::string( 70, '-' ) + "NEEDLE" ) == 70 );
+    CHECK( ignoreCase.find( "neadle" ) == std::string_view::npos );
+    // the case bit is only ignored for letters
+    CHECK( jess::SubstringSearcher{ "@1", true, kernel }.find( std::string( 40, '`' ) + "1" ) == std::string_view::npos );
+  }
+}
+
+TEST_CASE( "SubstringSearcher matches std::string_view::find" )
+{
+  std::mt19937 rng{ 42 };
+  // a small alphabet produces many partial matches
+  std::uniform_int_distribution<int> letter{ 'a', 'd' };
+  const auto randomString = [&]( const size_t uLength ) {
+    std::string ret( uLength, ' ' );
+    for ( char& c : ret )
+    {
+      c = static_cast<char>( letter( rng ) );
+      if ( rng() % 3 == 0 )
+      {
+        c = static_cast<char>( c - 'a' + 'A' );
+      }
+    }
+    return ret;
+  };
+
+  for ( int i = 0; i < 2000; ++i )
+  {
+    const std::string sHaystack = randomString( rng() % 100 );
+    const std::string sNeedle = randomString( 1 + rng() % 5 );
+    for ( const auto kernel : supportedKernels() )
+    {
+      CHECK( jess::SubstringSearcher{ sNeedle, false, kernel }.find( sHaystack ) == std::string_view{ sHaystack }.find( sNeedle ) );
+      CHECK( jess::SubstringSearcher{ sNeedle, true, kernel }.find( sHaystack ) == toLower( sHaystack ).find( toLower( sNeedle ) ) );
+    }
+  }
+}
@@ -0,0 +1,80 @@
+#include "TimeExpression.hpp"
+#include <doctest/doctest.h>
+
+#include <cstdlib>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+// 2023-11-14 22:13:20 UTC
+constexpr std::chrono::sys_seconds NOW{ 1'700'000'000s };
+
+std::chrono::system_clock::time_point parseUtc( const std::string_view sExpression ) { return jess::parseTimeExpression( sExpression, NOW, false ); }
+}// namespace
+
+TEST_CASE( "parseTimeExpression relative" )
+{
+  CHECK( parseUtc( "now" ) == NOW );
+  CHECK( parseUtc( " now " ) == NOW );
+  CHECK( parseUtc( "-15m" ) == NOW - 15min );
+  CHECK( parseUtc( "+30s" ) == NOW + 30s );
+  CHECK( parseUtc( "-1h30m" ) == NOW - 90min );
+  CHECK( parseUtc( "-2d" ) == NOW - 48h );
+  CHECK( parseUtc( "-1w" ) == NOW - 168h );
+
+  CHECK_THROWS_AS( parseUtc( "-" ), std::invalid_argument );
+  CHECK_THROWS_AS( parseUtc( "-15" ), std::invalid_argument );
+  CHECK_THROWS_AS( parseUtc( "-15x" ), std::invalid_argument );
+  CHECK_THROWS_AS( parseUtc( "--15m" ), std::invalid_argument );
+  CHECK_THROWS_AS( parseUtc( "-m" ), std::invalid_argument );
+}
+
+TEST_CASE( "parseTimeExpression absolute" )
+{
+  CHECK( parseUtc( "2023-11-14 22:13:20" ) == NOW );
+  CHECK( parseUtc( "2023-11-14T22:13:20" ) == NOW );
+  CHECK( parseUtc( "2023-11-14 22:13" ) == NOW - 20s );
+  CHECK( parseUtc( "2023-11-14" ) == NOW - 22h - 13min - 20s );
+  CHECK( parseUtc( "2024-02-29 00:00" ) == std::chrono::sys_days{ std::chrono::year{ 2024 } / 2 / 29 } );
+
+  SUBCASE( "time of today" )
+  {
+    CHECK( parseUtc( "22:13:20" ) == NOW );
+    CHECK( parseUtc( "08:00" ) == NOW - 14h - 13min - 20s );
+  }
+
+  SUBCASE( "malformed" )
+  {
+    CHECK_THROWS_AS( parseUtc( "" ), std::invalid_argument );
+    CHECK_THROWS_AS( parseUtc( "yesterday" ), std::invalid_argument );
+    CHECK_THROWS_AS( parseUtc( "2023-11-14 22" ), std::invalid_argument );
+    CHECK_THROWS_AS( parseUtc( "2023-11-14x22:13" ), std::invalid_argument );
+    CHECK_THROWS_AS( parseUtc( "2023-13-01" ), std::invalid_argument );
+    CHECK_THROWS_AS( parseUtc( "2023-02-30" ), std::invalid_argument );
+    CHECK_THROWS_AS( parseUtc( "24:00" ), std::invalid_argument );
+    CHECK_THROWS_AS( parseUtc( "12:60" ), std::invalid_argument );
+    CHECK_THROWS_AS( parseUtc( "12:00:00 UTC" ), std::invalid_argument );
+  }
+}
+
+TEST_CASE( "parseTimeExpression local time" )
+{
+  const char* sPreviousTz = std::getenv( "TZ" );
+  const std::string sRestoreTz = sPreviousTz ? sPreviousTz : "";
+  ::setenv( "TZ", "CET-1", 1 );
+  ::tzset();
+
+  CHECK( jess::parseTimeExpression( "2023-11-14 23:13:20", NOW, true ) == NOW );
+  CHECK( jess::parseTimeExpression( "23:13:20", NOW, true ) == NOW );
+
+  if ( sPreviousTz )
+  {
+    ::setenv( "TZ", sRestoreTz.c_str(), 1 );
+  }
+  else
+  {
+    ::unsetenv( "TZ" );
+  }
+  ::tzset();
+}
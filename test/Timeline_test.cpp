@@ -0,0 +1,98 @@
+#include "MockStream.hpp"
+#include "Timeline.hpp"
+#include <doctest/doctest.h>
+
+#include <numeric>
+#include <stdexcept>
+
+namespace
+{
+jess::Timeline makeTimeline( std::vector<size_t> counts )
+{
+  jess::Timeline timeline{};
+  timeline.end = std::chrono::system_clock::time_point{ std::chrono::seconds{ static_cast<int64_t>( counts.size() ) - 1 } };
+  timeline.counts = std::move( counts );
+  return timeline;
+}
+}// namespace
+
+TEST_CASE( "renderTimeline" )
+{
+  CHECK( jess::renderTimeline( jess::Timeline{}, 4 ) == "    " );
+  CHECK( jess::renderTimeline( makeTimeline( { 0, 1, 9, 0 } ), 4 ) == " .@ " );
+  CHECK( jess::renderTimeline( makeTimeline( { 0, 0, 0, 0 } ), 4 ) == "    " );
+
+  SUBCASE( "buckets are merged into the columns" )
+  {
+    CHECK( jess::renderTimeline( makeTimeline( { 0, 1, 8, 1, 0, 0 } ), 3 ) == ".@ " );
+  }
+
+  SUBCASE( "buckets are stretched over the columns" )
+  {
+    CHECK( jess::renderTimeline( makeTimeline( { 9, 0 } ), 4 ) == "@@  " );
+  }
+
+  SUBCASE( "marker" )
+  {
+    const auto timeline = makeTimeline( { 9, 9, 9, 9 } );
+    CHECK( jess::renderTimeline( timeline, 4, std::chrono::system_clock::time_point{ std::chrono::seconds{ 2 } } ) == "@@|@" );
+    CHECK( jess::renderTimeline( timeline, 4, std::chrono::system_clock::time_point{ std::chrono::seconds{ 10 } } ) == "@@@|" );
+  }
+}
+
+TEST_CASE( "Timeline sample pass" )
+{
+  MockStream<100> journal{};
+  jess::Timeline timeline = makeTimeline( std::vector<size_t>( 100 ) );
+
+  // entries 0 and 64 stand for 64 entries each, the last one for itself
+  CHECK( jess::detail::samplePass( journal, timeline, 10, 64, {} ) == 129 );
+  CHECK( timeline.counts == std::vector<size_t>{ 64, 0, 0, 0, 0, 0, 64, 0, 0, 1 } );
+
+  CHECK( jess::detail::samplePass( journal, timeline, 10, 1, {} ) == 100 );
+  CHECK( timeline.counts == std::vector<size_t>( 10, 10 ) );
+  // the samples only read the timestamps
+  CHECK( journal.uLineReads == 0 );
+
+  journal.uStreamLength = 0;
+  CHECK( jess::detail::samplePass( journal, timeline, 10, 64, {} ) == 0 );
+}
+
+TEST_CASE( "TimelineBuilder error" )
+{
+  jess::TimelineBuilder<MockStream<100>> sut{ 10, []() -> MockStream<100> { throw std::runtime_error{ "no journal" }; } };
+  sut.wait();
+  CHECK( sut.done() );
+  CHECK_THROWS_AS( (void)sut.takeUpdate(), std::runtime_error );
+}
+
+TEST_CASE( "TimelineBuilder" )
+{
+  // the first pass skips over the journal, the later ones refine it down to every entry
+  jess::TimelineBuilder<MockStream<100'000>> sut{ 10, [] { return MockStream<100'000>{}; } };
+  sut.wait();
+  CHECK( sut.done() );
+
+  const auto timeline = sut.takeUpdate();
+  REQUIRE( timeline );
+  CHECK( timeline->complete );
+  CHECK( timeline->stride == 1 );
+  CHECK( timeline->begin == std::chrono::system_clock::time_point{} );
+  CHECK( timeline->end == std::chrono::system_clock::time_point{ std::chrono::seconds{ 99'999 } } );
+  REQUIRE( timeline->counts.size() == 10 );
+  for ( const size_t uCount : timeline->counts )
+  {
+    CHECK( uCount == 10'000 );
+  }
+  CHECK_FALSE( sut.takeUpdate() );
+
+  SUBCASE( "empty journal" )
+  {
+    jess::TimelineBuilder<MockStream<100>> empty{ 10, [] { return MockStream<100>{}; }, []( MockStream<100>& journal ) { journal.uStreamLength = 0; } };
+    empty.wait();
+    const auto emptyTimeline = empty.takeUpdate();
+    REQUIRE( emptyTimeline );
+    CHECK( emptyTimeline->complete );
+    CHECK( std::accumulate( emptyTimeline->counts.begin(), emptyTimeline->counts.end(), size_t{} ) == 0 );
+  }
+}
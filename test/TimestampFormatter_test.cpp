@@ -0,0 +1,79 @@
+#include "TimestampFormatter.hpp"
+#include <doctest/doctest.h>
+
+#include <cstdlib>
+#include <string>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+// 2023-11-14 22:13:20 UTC
+constexpr std::chrono::sys_seconds TIMESTAMP{ 1'700'000'000s };
+}// namespace
+
+TEST_CASE( "TimestampFormatter UTC" )
+{
+  jess::TimestampFormatter sut{};
+  CHECK( sut( TIMESTAMP ) == "2023-11-14 22:13:20" );
+  CHECK( sut.width() == 19 );
+
+  SUBCASE( "consecutive entries within the cached minute" )
+  {
+    CHECK( sut( TIMESTAMP + 5s + 123ms ) == "2023-11-14 22:13:25" );
+    CHECK( sut( TIMESTAMP + 39s ) == "2023-11-14 22:13:59" );
+    CHECK( sut( TIMESTAMP - 20s ) == "2023-11-14 22:13:00" );
+  }
+
+  SUBCASE( "leaving the cached minute" )
+  {
+    CHECK( sut( TIMESTAMP + 40s ) == "2023-11-14 22:14:00" );
+    CHECK( sut( TIMESTAMP - 21s ) == "2023-11-14 22:12:59" );
+    CHECK( sut( TIMESTAMP + 24h * 48 ) == "2024-01-01 22:13:20" );
+  }
+
+  SUBCASE( "before the epoch" )
+  {
+    CHECK( sut( std::chrono::sys_seconds{ -1s } ) == "1969-12-31 23:59:59" );
+    CHECK( sut( std::chrono::system_clock::time_point{ -1us } ) == "1969-12-31 23:59:59" );
+  }
+}
+
+TEST_CASE( "TimestampFormatter microseconds" )
+{
+  jess::TimestampFormatter sut{ { .localTime = false, .microseconds = true } };
+  CHECK( sut( TIMESTAMP ) == "2023-11-14 22:13:20.000000" );
+  CHECK( sut( TIMESTAMP + 1us ) == "2023-11-14 22:13:20.000001" );
+  CHECK( sut( TIMESTAMP + 61s + 987654us ) == "2023-11-14 22:14:21.987654" );
+  CHECK( sut.width() == 26 );
+
+  sut.setFormat( {} );
+  CHECK( sut( TIMESTAMP + 1us ) == "2023-11-14 22:13:20" );
+}
+
+TEST_CASE( "TimestampFormatter local time" )
+{
+  const char* sPreviousTz = std::getenv( "TZ" );
+  const std::string sRestoreTz = sPreviousTz ? sPreviousTz : "";
+
+  // POSIX zone five hours west of UTC without daylight saving time
+  ::setenv( "TZ", "EST5", 1 );
+  ::tzset();
+
+  jess::TimestampFormatter sut{ { .localTime = true, .microseconds = false } };
+  CHECK( sut( TIMESTAMP ) == "2023-11-14 17:13:20" );
+  CHECK( sut( TIMESTAMP + 40s ) == "2023-11-14 17:14:00" );
+
+  sut.setFormat( {} );
+  CHECK( sut( TIMESTAMP ) == "2023-11-14 22:13:20" );
+
+  if ( sPreviousTz )
+  {
+    ::setenv( "TZ", sRestoreTz.c_str(), 1 );
+  }
+  else
+  {
+    ::unsetenv( "TZ" );
+  }
+  ::tzset();
+}